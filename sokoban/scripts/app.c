@@ -34,7 +34,9 @@ AppContext* app_alloc()
     app->sceneManager = scene_manager_alloc_auto();
     scene_manager_register_scene(app->sceneManager, SceneType_Menu, scene_alloc(menu_render_callback, NULL, menu_input_callback, menu_transition_callback, app));
     scene_manager_register_scene(app->sceneManager, SceneType_Credits, scene_alloc(credits_render_callback, NULL, credits_input_callback, credits_transition_callback, app));
-    scene_manager_register_scene(app->sceneManager, SceneType_Game, scene_alloc(game_render_callback, game_tick_callback, game_handle_input, game_transition_callback, app));
+    Scene* gameScene = scene_alloc(game_render_callback, game_tick_callback, game_handle_input, game_transition_callback, app);
+    scene_set_rendered_on_request(gameScene, true);
+    scene_manager_register_scene(app->sceneManager, SceneType_Game, gameScene);
 
     app->database = levels_database_load();
     levels_database_load_player_progress(app->database);
@@ -44,6 +46,7 @@ AppContext* app_alloc()
 
 void app_free(AppContext* app)
 {
+    levels_database_compact_progress(app->database);
     levels_database_free(app->database);
 
     scene_manager_free(app->sceneManager);
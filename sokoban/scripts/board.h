@@ -0,0 +1,157 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Boards are allocated to the size of their level. The limit comes from level packs and collection indexes, which keep
+// widths and heights in a byte.
+#define MAX_BOARD_SIZE 255
+
+typedef char CellType;
+enum {
+    CellHasWall = 0x1,
+    CellHasBox = 0x2,
+    CellHasTarget = 0x4,
+    CellHasPlayer = 0x8
+};
+
+// The cells of a level, split in two layers:
+// - Board: walls and targets, which never change once the level is loaded, plus the boxes of the starting position
+//   and the dead squares (see deadlock.h). It belongs to the Level and is shared by everything that plays it.
+// - BoxLayer: the current box positions. It belongs to each GameState.
+// The player is not part of either layer.
+//
+// There are two storage backends, both behind the same functions:
+// - Bit planes (default): one bit per cell for each of walls, targets, boxes and dead squares, sized to the level.
+//   Each row starts on a new word, so the bit of a cell is in word y * stride + x / BOARD_WORD_BITS.
+// - Char grid (SOKOBAN_BOARD_GRID): one CellType per cell, row by row, so the cell is at y * width + x.
+
+#ifdef SOKOBAN_BOARD_GRID
+
+// Dead squares are kept in the board cells, next to the CellType flags, but are never returned as part of a cell.
+#define BOARD_GRID_DEAD_SQUARE 0x10
+
+typedef struct Board
+{
+    int width, height;
+    CellType* cells;
+} Board;
+
+typedef struct BoxLayer
+{
+    CellType* cells;
+} BoxLayer;
+
+static inline int board_cell_index(const Board* board, int x, int y)
+{
+    return y * board->width + x;
+}
+
+static inline bool board_has_wall(const Board* board, int x, int y)
+{
+    return board->cells[board_cell_index(board, x, y)] & CellHasWall;
+}
+
+static inline bool board_has_target(const Board* board, int x, int y)
+{
+    return board->cells[board_cell_index(board, x, y)] & CellHasTarget;
+}
+
+static inline bool board_is_dead_square(const Board* board, int x, int y)
+{
+    return board->cells[board_cell_index(board, x, y)] & BOARD_GRID_DEAD_SQUARE;
+}
+
+static inline bool box_layer_has_box(const Board* board, const BoxLayer* boxes, int x, int y)
+{
+    return boxes->cells[board_cell_index(board, x, y)] & CellHasBox;
+}
+
+static inline void box_layer_move_box(const Board* board, BoxLayer* boxes, int fromX, int fromY, int toX, int toY)
+{
+    boxes->cells[board_cell_index(board, fromX, fromY)] &= ~CellHasBox;
+    boxes->cells[board_cell_index(board, toX, toY)] |= CellHasBox;
+}
+
+#else
+
+typedef uint32_t BoardWord;
+#define BOARD_WORD_BITS 32
+
+typedef struct Board
+{
+    int width, height;
+    int stride;
+    BoardWord* walls;
+    BoardWord* targets;
+    BoardWord* boxes;
+    BoardWord* deadSquares;
+} Board;
+
+typedef struct BoxLayer
+{
+    BoardWord* boxes;
+} BoxLayer;
+
+static inline bool board_plane_get(const Board* board, const BoardWord* plane, int x, int y)
+{
+    return (plane[y * board->stride + x / BOARD_WORD_BITS] >> (x % BOARD_WORD_BITS)) & 1;
+}
+
+static inline bool board_has_wall(const Board* board, int x, int y)
+{
+    return board_plane_get(board, board->walls, x, y);
+}
+
+static inline bool board_has_target(const Board* board, int x, int y)
+{
+    return board_plane_get(board, board->targets, x, y);
+}
+
+static inline bool board_is_dead_square(const Board* board, int x, int y)
+{
+    return board_plane_get(board, board->deadSquares, x, y);
+}
+
+static inline bool box_layer_has_box(const Board* board, const BoxLayer* boxes, int x, int y)
+{
+    return board_plane_get(board, boxes->boxes, x, y);
+}
+
+static inline void box_layer_move_box(const Board* board, BoxLayer* boxes, int fromX, int fromY, int toX, int toY)
+{
+    boxes->boxes[fromY * board->stride + fromX / BOARD_WORD_BITS] &= ~((BoardWord)1 << (fromX % BOARD_WORD_BITS));
+    boxes->boxes[toY * board->stride + toX / BOARD_WORD_BITS] |= (BoardWord)1 << (toX % BOARD_WORD_BITS);
+}
+
+#endif
+
+void board_alloc(Board* board, int width, int height);
+void board_free(Board* board);
+
+// Adds walls, targets and boxes to a cell. Other flags are ignored.
+void board_add_cell(Board* board, int x, int y, CellType cell);
+
+void board_mark_dead_square(Board* board, int x, int y);
+
+// Returns the walls, targets and starting boxes of a cell, as CellType flags.
+CellType board_get_cell(const Board* board, int x, int y);
+
+// Returns the heap memory used by the board, in bytes.
+int board_heap_size(const Board* board);
+
+// Starts a box layer with the boxes of the starting position.
+void box_layer_init(BoxLayer* boxes, const Board* board);
+void box_layer_free(BoxLayer* boxes);
+
+// Removes every box, so boxes can be placed one by one with box_layer_add_box.
+void box_layer_clear(const Board* board, BoxLayer* boxes);
+void box_layer_add_box(const Board* board, BoxLayer* boxes, int x, int y);
+
+// Returns the walls, targets and current boxes of a cell, as CellType flags.
+CellType box_layer_get_cell(const Board* board, const BoxLayer* boxes, int x, int y);
+
+int box_layer_count_boxes_off_target(const Board* board, const BoxLayer* boxes);
+
+// Returns the heap memory used by the box layer, in bytes.
+int box_layer_heap_size(const Board* board, const BoxLayer* boxes);
@@ -0,0 +1,110 @@
+#ifndef SOKOBAN_BOARD_GRID
+
+#include "board.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define PLANES_COUNT 4
+
+static int plane_words(const Board* board)
+{
+    return board->stride * board->height;
+}
+
+static void plane_set(const Board* board, BoardWord* plane, int x, int y)
+{
+    plane[y * board->stride + x / BOARD_WORD_BITS] |= (BoardWord)1 << (x % BOARD_WORD_BITS);
+}
+
+void board_alloc(Board* board, int width, int height)
+{
+    board->width = width;
+    board->height = height;
+    board->stride = (width + BOARD_WORD_BITS - 1) / BOARD_WORD_BITS;
+
+    board->walls = calloc(PLANES_COUNT * plane_words(board), sizeof(BoardWord));
+    board->targets = board->walls + plane_words(board);
+    board->boxes = board->targets + plane_words(board);
+    board->deadSquares = board->boxes + plane_words(board);
+}
+
+void board_free(Board* board)
+{
+    free(board->walls);
+}
+
+void board_add_cell(Board* board, int x, int y, CellType cell)
+{
+    if (cell & CellHasWall)
+        plane_set(board, board->walls, x, y);
+    if (cell & CellHasTarget)
+        plane_set(board, board->targets, x, y);
+    if (cell & CellHasBox)
+        plane_set(board, board->boxes, x, y);
+}
+
+void board_mark_dead_square(Board* board, int x, int y)
+{
+    plane_set(board, board->deadSquares, x, y);
+}
+
+CellType board_get_cell(const Board* board, int x, int y)
+{
+    BoxLayer startingBoxes = {.boxes = board->boxes};
+    return box_layer_get_cell(board, &startingBoxes, x, y);
+}
+
+int board_heap_size(const Board* board)
+{
+    return PLANES_COUNT * plane_words(board) * sizeof(BoardWord);
+}
+
+void box_layer_init(BoxLayer* boxes, const Board* board)
+{
+    boxes->boxes = malloc(plane_words(board) * sizeof(BoardWord));
+    memcpy(boxes->boxes, board->boxes, plane_words(board) * sizeof(BoardWord));
+}
+
+void box_layer_free(BoxLayer* boxes)
+{
+    free(boxes->boxes);
+}
+
+void box_layer_clear(const Board* board, BoxLayer* boxes)
+{
+    memset(boxes->boxes, 0, plane_words(board) * sizeof(BoardWord));
+}
+
+void box_layer_add_box(const Board* board, BoxLayer* boxes, int x, int y)
+{
+    plane_set(board, boxes->boxes, x, y);
+}
+
+CellType box_layer_get_cell(const Board* board, const BoxLayer* boxes, int x, int y)
+{
+    CellType cell = 0;
+    if (board_has_wall(board, x, y))
+        cell |= CellHasWall;
+    if (board_has_target(board, x, y))
+        cell |= CellHasTarget;
+    if (box_layer_has_box(board, boxes, x, y))
+        cell |= CellHasBox;
+    return cell;
+}
+
+int box_layer_count_boxes_off_target(const Board* board, const BoxLayer* boxes)
+{
+    int count = 0;
+    for (int i = 0; i < plane_words(board); i++)
+        count += __builtin_popcount(boxes->boxes[i] & ~board->targets[i]);
+    return count;
+}
+
+int box_layer_heap_size(const Board* board, const BoxLayer* boxes)
+{
+    (void)boxes;
+    return plane_words(board) * sizeof(BoardWord);
+}
+
+#endif
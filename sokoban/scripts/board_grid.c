@@ -0,0 +1,88 @@
+#ifdef SOKOBAN_BOARD_GRID
+
+#include "board.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static int cells_count(const Board* board)
+{
+    return board->width * board->height;
+}
+
+void board_alloc(Board* board, int width, int height)
+{
+    board->width = width;
+    board->height = height;
+    board->cells = calloc(cells_count(board), sizeof(CellType));
+}
+
+void board_free(Board* board)
+{
+    free(board->cells);
+}
+
+void board_add_cell(Board* board, int x, int y, CellType cell)
+{
+    board->cells[board_cell_index(board, x, y)] |= cell & (CellHasWall | CellHasTarget | CellHasBox);
+}
+
+void board_mark_dead_square(Board* board, int x, int y)
+{
+    board->cells[board_cell_index(board, x, y)] |= BOARD_GRID_DEAD_SQUARE;
+}
+
+CellType board_get_cell(const Board* board, int x, int y)
+{
+    return board->cells[board_cell_index(board, x, y)] & ~BOARD_GRID_DEAD_SQUARE;
+}
+
+int board_heap_size(const Board* board)
+{
+    return cells_count(board) * sizeof(CellType);
+}
+
+void box_layer_init(BoxLayer* boxes, const Board* board)
+{
+    boxes->cells = malloc(cells_count(board) * sizeof(CellType));
+    for (int cell = 0; cell < cells_count(board); cell++)
+        boxes->cells[cell] = board->cells[cell] & CellHasBox;
+}
+
+void box_layer_free(BoxLayer* boxes)
+{
+    free(boxes->cells);
+}
+
+void box_layer_clear(const Board* board, BoxLayer* boxes)
+{
+    memset(boxes->cells, 0, cells_count(board) * sizeof(CellType));
+}
+
+void box_layer_add_box(const Board* board, BoxLayer* boxes, int x, int y)
+{
+    boxes->cells[board_cell_index(board, x, y)] |= CellHasBox;
+}
+
+CellType box_layer_get_cell(const Board* board, const BoxLayer* boxes, int x, int y)
+{
+    int cell = board_cell_index(board, x, y);
+    return (board->cells[cell] & ~(CellHasBox | BOARD_GRID_DEAD_SQUARE)) | boxes->cells[cell];
+}
+
+int box_layer_count_boxes_off_target(const Board* board, const BoxLayer* boxes)
+{
+    int count = 0;
+    for (int cell = 0; cell < cells_count(board); cell++)
+        if ((boxes->cells[cell] & CellHasBox) && !(board->cells[cell] & CellHasTarget))
+            count += 1;
+    return count;
+}
+
+int box_layer_heap_size(const Board* board, const BoxLayer* boxes)
+{
+    (void)boxes;
+    return cells_count(board) * sizeof(CellType);
+}
+
+#endif
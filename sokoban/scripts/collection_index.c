@@ -0,0 +1,193 @@
+#include "collection_index.h"
+
+#include "level.h"
+#include "wave/files/file_lines_reader.h"
+#include <furi.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define INDEX_MAGIC 0x58494B53 // "SKIX"
+#define INDEX_VERSION 2
+
+typedef struct IndexHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t sourceSize;
+    uint32_t sourceTimestamp;
+    uint32_t levelsCount;
+} IndexHeader;
+
+void collection_source_path(char* output, int size, const char* collectionName, const char* extension)
+{
+    snprintf(output, size, "%s/%s.%s", STORAGE_APP_ASSETS_PATH_PREFIX, collectionName, extension);
+    for (int i = 0; output[i] != '\0'; i++)
+        if (output[i] >= 'A' && output[i] <= 'Z')
+            output[i] += 'a' - 'A';
+}
+
+void collection_data_path(char* output, int size, const char* collectionName, const char* suffix)
+{
+    snprintf(output, size, "%s/%s%s", STORAGE_APP_DATA_PATH_PREFIX, collectionName, suffix);
+    for (int i = 0; output[i] != '\0'; i++)
+        if (output[i] >= 'A' && output[i] <= 'Z')
+            output[i] += 'a' - 'A';
+}
+
+static bool read_source_signature(Storage* storage, const char* sourcePath, IndexHeader* header)
+{
+    FileInfo info;
+    if (storage_common_stat(storage, sourcePath, &info) != FSE_OK)
+        return false;
+
+    uint32_t timestamp = 0;
+    storage_common_timestamp(storage, sourcePath, &timestamp);
+
+    header->magic = INDEX_MAGIC;
+    header->version = INDEX_VERSION;
+    header->sourceSize = (uint32_t)info.size;
+    header->sourceTimestamp = timestamp;
+    header->levelsCount = 0;
+    return true;
+}
+
+static bool is_level_start_mark(const char* line, int levelNumber)
+{
+    char levelStartMark[16];
+    snprintf(levelStartMark, sizeof(levelStartMark), "%d", levelNumber);
+    return strcmp(levelStartMark, line) == 0;
+}
+
+// Adds a line to the level being measured if it is a row, as level_load reads them.
+static bool measure_row(const char* line, CollectionIndexEntry* entry)
+{
+    int column;
+    for (column = 0; line[column] != '\0'; column++)
+    {
+        int cell = level_parse_cell(line[column]);
+        if (cell < 0 || column >= MAX_BOARD_SIZE)
+            return false;
+        if (cell & CellHasPlayer)
+        {
+            entry->playerX = column;
+            entry->playerY = entry->height;
+        }
+    }
+
+    entry->width = MAX(entry->width, column);
+    entry->height += 1;
+    return true;
+}
+
+static void write_entry(File* index, CollectionIndexEntry* entry)
+{
+    int cellSize;
+    bool rotated;
+    level_choose_layout(entry->width, entry->height, &cellSize, &rotated);
+    entry->cellSize = cellSize;
+    entry->flags = rotated ? COLLECTION_INDEX_ROTATED : 0;
+    storage_file_write(index, entry, sizeof(CollectionIndexEntry));
+}
+
+static bool collection_index_build(Storage* storage, const char* sourcePath, const char* indexPath, IndexHeader* header)
+{
+    FURI_LOG_D("GAME", "Building level index: %s", indexPath);
+
+    File* source = storage_file_alloc(storage);
+    File* index = storage_file_alloc(storage);
+    bool success = false;
+
+    if (!storage_file_open(source, sourcePath, FSAM_READ, FSOM_OPEN_EXISTING))
+        goto cleanup;
+    if (!storage_file_open(index, indexPath, FSAM_WRITE, FSOM_CREATE_ALWAYS))
+        goto cleanup;
+
+    // The header is written first with a zero count, and rewritten once all the levels are known.
+    storage_file_write(index, header, sizeof(IndexHeader));
+
+    // One character more than the widest row, so longer rows are not taken for rows cut to size.
+    char line[MAX_BOARD_SIZE + 2];
+    CollectionIndexEntry entry;
+    bool inLevel = false;
+    FileLinesReader* reader = file_lines_reader_alloc(source, sizeof(line));
+    while (file_lines_reader_readln(reader, line, sizeof(line)))
+    {
+        // The rows of a level go on until a line that is not a row, and are measured on the way.
+        if (inLevel && entry.height < MAX_BOARD_SIZE && measure_row(line, &entry))
+            continue;
+        if (inLevel)
+        {
+            write_entry(index, &entry);
+            inLevel = false;
+        }
+
+        if (!is_level_start_mark(line, header->levelsCount + 1))
+            continue;
+
+        memset(&entry, 0, sizeof(entry));
+        entry.offset = file_lines_reader_tell(reader);
+        inLevel = true;
+        header->levelsCount += 1;
+    }
+    if (inLevel)
+        write_entry(index, &entry);
+    file_lines_reader_free(reader);
+
+    storage_file_seek(index, 0, true);
+    success = storage_file_write(index, header, sizeof(IndexHeader)) == sizeof(IndexHeader);
+
+    FURI_LOG_D("GAME", "Indexed %lu levels", (unsigned long)header->levelsCount);
+
+cleanup:
+    storage_file_free(index);
+    storage_file_free(source);
+    return success;
+}
+
+static bool collection_index_open(File* index, const char* indexPath, const IndexHeader* expectedHeader, IndexHeader* ret_header)
+{
+    if (!storage_file_open(index, indexPath, FSAM_READ, FSOM_OPEN_EXISTING))
+        return false;
+
+    bool valid = storage_file_read(index, ret_header, sizeof(IndexHeader)) == sizeof(IndexHeader)
+        && ret_header->magic == expectedHeader->magic
+        && ret_header->version == expectedHeader->version
+        && ret_header->sourceSize == expectedHeader->sourceSize
+        && ret_header->sourceTimestamp == expectedHeader->sourceTimestamp;
+
+    if (!valid)
+        storage_file_close(index);
+    return valid;
+}
+
+bool collection_index_find_level(Storage* storage, const char* collectionName, int levelIndex, CollectionIndexEntry* ret_entry)
+{
+    char sourcePath[256], indexPath[256];
+    collection_source_path(sourcePath, sizeof(sourcePath), collectionName, "txt");
+    collection_data_path(indexPath, sizeof(indexPath), collectionName, ".idx");
+
+    IndexHeader expectedHeader, header;
+    if (!read_source_signature(storage, sourcePath, &expectedHeader))
+        return false;
+
+    File* index = storage_file_alloc(storage);
+    if (!collection_index_open(index, indexPath, &expectedHeader, &header))
+    {
+        if (!collection_index_build(storage, sourcePath, indexPath, &expectedHeader)
+            || !collection_index_open(index, indexPath, &expectedHeader, &header))
+        {
+            storage_file_free(index);
+            return false;
+        }
+    }
+
+    bool found = false;
+    if (levelIndex >= 0 && (uint32_t)levelIndex < header.levelsCount)
+    {
+        storage_file_seek(index, sizeof(IndexHeader) + levelIndex * sizeof(CollectionIndexEntry), true);
+        found = storage_file_read(index, ret_entry, sizeof(CollectionIndexEntry)) == sizeof(CollectionIndexEntry);
+    }
+
+    storage_file_free(index);
+    return found;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <storage/storage.h>
+
+// Builds the path of a collection file (e.g. "microban.txt") inside the app assets.
+void collection_source_path(char* output, int size, const char* collectionName, const char* extension);
+
+// Builds the path of a file the app keeps about a collection (e.g. "microban.idx") inside the app data folder.
+void collection_data_path(char* output, int size, const char* collectionName, const char* suffix);
+
+// CollectionIndexEntry flags.
+#define COLLECTION_INDEX_ROTATED 0x01
+
+// Where a level is in the collection text file, and its layout, measured when the index is built so the level can be
+// loaded in a single pass over its rows.
+typedef struct CollectionIndexEntry
+{
+    uint32_t offset; // Of the first row of the level.
+    uint8_t width, height; // As written in the collection, before any rotation.
+    uint8_t playerX, playerY;
+    uint8_t cellSize; // As chosen by level_choose_layout.
+    uint8_t flags;
+    uint16_t reserved;
+} CollectionIndexEntry;
+
+// Finds a level inside the collection text file.
+// The entries are kept in an index file in the app data folder, which is rebuilt whenever the collection file changes.
+bool collection_index_find_level(Storage* storage, const char* collectionName, int levelIndex, CollectionIndexEntry* ret_entry);
@@ -0,0 +1,188 @@
+#include "deadlock.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+// Freeze checks follow chains of boxes recursively; longer chains are not considered frozen, which is always safe.
+#define MAX_FREEZE_DEPTH 16
+
+int deadlock_find_dead_squares(Level* level)
+{
+    // Only the floor of the level can hold a box that moves. A box can reach a target from every floor cell it can be
+    // pulled to from a target. Pulling a box one cell needs the player to stand on that cell and step back one more.
+    int width = level->level_width;
+    LevelFloor floor;
+    level_floor_init(&floor, level);
+    bool* live = calloc(floor.count, sizeof(bool));
+    uint16_t* queue = malloc(floor.count * sizeof(uint16_t));
+
+    int head = 0, tail = 0;
+    for (int cell = 0; cell < floor.count; cell++)
+    {
+        if (board_has_target(&level->board, floor.floorToCell[cell] % width, floor.floorToCell[cell] / width))
+        {
+            live[cell] = true;
+            queue[tail++] = cell;
+        }
+    }
+    while (head < tail)
+    {
+        int cell = queue[head++];
+        for (int direction = 0; direction < 4; direction++)
+        {
+            int to = floor.neighbors[cell][direction];
+            if (to == LEVEL_NO_FLOOR || floor.neighbors[to][direction] == LEVEL_NO_FLOOR || live[to])
+                continue;
+            live[to] = true;
+            queue[tail++] = to;
+        }
+    }
+
+    int deadSquaresCount = 0;
+    for (int cell = 0; cell < floor.count; cell++)
+    {
+        if (!live[cell])
+        {
+            board_mark_dead_square(&level->board, floor.floorToCell[cell] % width, floor.floorToCell[cell] / width);
+            deadSquaresCount += 1;
+        }
+    }
+
+    free(queue);
+    free(live);
+    level_floor_free(&floor);
+    return deadSquaresCount;
+}
+
+typedef struct FreezeCheck
+{
+    const FreezeLookups* lookups;
+    const void* position;
+    bool offTarget;
+    // Boxes whose freeze is being checked. They count as walls meanwhile, so chains of boxes blocking each other end.
+    int pendingCount;
+    int pending[MAX_FREEZE_DEPTH];
+} FreezeCheck;
+
+static bool freeze_is_wall(const FreezeCheck* check, int cell)
+{
+    if (cell < 0)
+        return true;
+    for (int i = 0; i < check->pendingCount; i++)
+        if (check->pending[i] == cell)
+            return true;
+    return false;
+}
+
+static bool freeze_is_box_frozen(FreezeCheck* check, int cell);
+
+// Returns whether a box can not move along an axis, given by its first direction: left for the horizontal axis, or up for
+// the vertical one.
+static bool freeze_is_axis_blocked(FreezeCheck* check, int cell, int direction)
+{
+    const FreezeLookups* lookups = check->lookups;
+    int before = lookups->neighbor(check->position, cell, direction);
+    int after = lookups->neighbor(check->position, cell, direction + 1);
+    if (freeze_is_wall(check, before) || freeze_is_wall(check, after))
+        return true;
+
+    // Pushing the box either way would leave it on a dead square.
+    if (lookups->is_dead_square(check->position, before) && lookups->is_dead_square(check->position, after))
+        return true;
+
+    if (lookups->has_box(check->position, before) && freeze_is_box_frozen(check, before))
+        return true;
+    if (lookups->has_box(check->position, after) && freeze_is_box_frozen(check, after))
+        return true;
+    return false;
+}
+
+static bool freeze_is_box_frozen(FreezeCheck* check, int cell)
+{
+    if (check->pendingCount == MAX_FREEZE_DEPTH)
+        return false;
+
+    check->pending[check->pendingCount++] = cell;
+    bool frozen = freeze_is_axis_blocked(check, cell, 0) && freeze_is_axis_blocked(check, cell, 2);
+    check->pendingCount -= 1;
+
+    if (frozen && !check->lookups->has_target(check->position, cell))
+        check->offTarget = true;
+    return frozen;
+}
+
+bool deadlock_is_cell_frozen(const FreezeLookups* lookups, const void* position, int cell, bool* ret_offTarget)
+{
+    FreezeCheck check = {.lookups = lookups, .position = position, .offTarget = false, .pendingCount = 0};
+    bool frozen = freeze_is_box_frozen(&check, cell);
+    if (ret_offTarget != NULL)
+        *ret_offTarget = frozen && check.offTarget;
+    return frozen;
+}
+
+// The lookups of the game, over the cells of a board: y * width + x.
+typedef struct BoardPosition
+{
+    const Board* board;
+    const BoxLayer* boxes;
+} BoardPosition;
+
+static int board_position_neighbor(const void* position, int cell, int direction)
+{
+    static const int DIRECTION_DX[] = {-1, 1, 0, 0};
+    static const int DIRECTION_DY[] = {0, 0, -1, 1};
+    const Board* board = ((const BoardPosition*)position)->board;
+    int x = cell % board->width + DIRECTION_DX[direction], y = cell / board->width + DIRECTION_DY[direction];
+    if (x < 0 || x >= board->width || y < 0 || y >= board->height || board_has_wall(board, x, y))
+        return -1;
+    return y * board->width + x;
+}
+
+static bool board_position_has_box(const void* position, int cell)
+{
+    const BoardPosition* board = position;
+    return box_layer_has_box(board->board, board->boxes, cell % board->board->width, cell / board->board->width);
+}
+
+static bool board_position_is_dead_square(const void* position, int cell)
+{
+    const Board* board = ((const BoardPosition*)position)->board;
+    return board_is_dead_square(board, cell % board->width, cell / board->width);
+}
+
+static bool board_position_has_target(const void* position, int cell)
+{
+    const Board* board = ((const BoardPosition*)position)->board;
+    return board_has_target(board, cell % board->width, cell / board->width);
+}
+
+static const FreezeLookups BOARD_FREEZE_LOOKUPS = {
+    .neighbor = board_position_neighbor,
+    .has_box = board_position_has_box,
+    .is_dead_square = board_position_is_dead_square,
+    .has_target = board_position_has_target,
+};
+
+bool deadlock_is_box_frozen(const Board* board, const BoxLayer* boxes, int x, int y, bool* ret_offTarget)
+{
+    BoardPosition position = {.board = board, .boxes = boxes};
+    return deadlock_is_cell_frozen(&BOARD_FREEZE_LOOKUPS, &position, y * board->width + x, ret_offTarget);
+}
+
+bool deadlock_check_push(const Board* board, const BoxLayer* boxes, int x, int y)
+{
+    if (board_is_dead_square(board, x, y))
+        return true;
+
+    bool offTarget;
+    return deadlock_is_box_frozen(board, boxes, x, y, &offTarget) && offTarget;
+}
+
+bool deadlock_check_position(const Board* board, const BoxLayer* boxes)
+{
+    for (int y = 0; y < board->height; y++)
+        for (int x = 0; x < board->width; x++)
+            if (box_layer_has_box(board, boxes, x, y) && !board_has_target(board, x, y) && deadlock_check_push(board, boxes, x, y))
+                return true;
+    return false;
+}
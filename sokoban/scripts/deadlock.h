@@ -0,0 +1,40 @@
+#pragma once
+
+#include "board.h"
+#include "level.h"
+#include <stdbool.h>
+
+// Detection of positions that can never be solved:
+// - Dead squares: floor cells from which a box can never reach a target, wherever the other boxes are. They only depend on
+//   the walls and targets, so they are found once, when the level is loaded, and kept in its board.
+// - Freeze deadlocks: boxes that can move neither horizontally nor vertically, because they are blocked by walls, dead squares
+//   or other frozen boxes. They are checked after every push, around the pushed box.
+
+// Marks the dead squares of a level in its board. It takes one breadth-first search of box pulls from every target.
+// Returns the count of dead squares found.
+int deadlock_find_dead_squares(Level* level);
+
+// How the freeze check sees a position, so that the game, over the cells of its board, and the solver, over its own
+// numbering of floor cells, follow the same rules. Cells are whatever numbers the lookups take, and every lookup gets the
+// position it was given.
+typedef struct FreezeLookups
+{
+    // Returns the cell next to another in a direction (left, right, up, down), or -1 for a wall or the outside.
+    int (*neighbor)(const void* position, int cell, int direction);
+    bool (*has_box)(const void* position, int cell);
+    bool (*is_dead_square)(const void* position, int cell);
+    bool (*has_target)(const void* position, int cell);
+} FreezeLookups;
+
+// Returns whether the box in a cell can never move again, with the same ret_offTarget as deadlock_is_box_frozen.
+bool deadlock_is_cell_frozen(const FreezeLookups* lookups, const void* position, int cell, bool* ret_offTarget);
+
+// Returns whether the box in a cell can never move again. If it is frozen, ret_offTarget tells whether it, or any box that
+// keeps it frozen, is out of a target: that is, whether the position is a freeze deadlock.
+bool deadlock_is_box_frozen(const Board* board, const BoxLayer* boxes, int x, int y, bool* ret_offTarget);
+
+// Returns whether a box that was just pushed into a cell made the position unsolvable.
+bool deadlock_check_push(const Board* board, const BoxLayer* boxes, int x, int y);
+
+// Returns whether any box of the position is on a dead square or in a freeze deadlock.
+bool deadlock_check_position(const Board* board, const BoxLayer* boxes);
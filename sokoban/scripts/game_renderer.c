@@ -0,0 +1,370 @@
+#include "game_renderer.h"
+
+#include "racso_sokoban_icons.h"
+#include <furi.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SCREEN_WIDTH 128
+#define SCREEN_HEIGHT 64
+
+struct GameRenderer
+{
+    const Level* level;
+    int cameraX, cameraY; // Level pixel at the center of the screen.
+    bool hasCursor;
+    int cursorX, cursorY;
+
+    // The board as last drawn, row by row, least significant bit first, as canvas_draw_xbm takes it. It covers the part
+    // of the screen that the level can take, which stays the same while the camera moves.
+    uint8_t* frame;
+    bool isFrameValid;
+    int frameX, frameY, frameWidth, frameHeight, frameRowBytes;
+
+    // Walls and targets of the whole level, from which the frame is redrawn when the camera moves.
+    uint8_t* layer;
+    int layerWidth, layerHeight, layerRowBytes;
+};
+
+// Cell sizes that have icons: 5, 7 and 9.
+#define CELL_SIZES_COUNT 3
+#define CELL_ICONS(name) {&I_cell_##name##_5, &I_cell_##name##_7, &I_cell_##name##_9}
+
+// The icon of every combination of cell flags, for each cell size. Floor has none. A wall hides anything on it, and the
+// player anything but the target under them; neither happens in a well formed level.
+static const Icon* const CELL_ICONS_BY_FLAGS[16][CELL_SIZES_COUNT] = {
+    [CellHasWall] = CELL_ICONS(wall),
+    [CellHasWall | CellHasBox] = CELL_ICONS(wall),
+    [CellHasWall | CellHasTarget] = CELL_ICONS(wall),
+    [CellHasWall | CellHasBox | CellHasTarget] = CELL_ICONS(wall),
+    [CellHasWall | CellHasPlayer] = CELL_ICONS(wall),
+    [CellHasWall | CellHasBox | CellHasPlayer] = CELL_ICONS(wall),
+    [CellHasWall | CellHasTarget | CellHasPlayer] = CELL_ICONS(wall),
+    [CellHasWall | CellHasBox | CellHasTarget | CellHasPlayer] = CELL_ICONS(wall),
+    [CellHasBox] = CELL_ICONS(box),
+    [CellHasTarget] = CELL_ICONS(target),
+    [CellHasBox | CellHasTarget] = CELL_ICONS(box_target),
+    [CellHasPlayer] = CELL_ICONS(player),
+    [CellHasBox | CellHasPlayer] = CELL_ICONS(player),
+    [CellHasTarget | CellHasPlayer] = CELL_ICONS(player_target),
+    [CellHasBox | CellHasTarget | CellHasPlayer] = CELL_ICONS(player_target),
+};
+
+const Icon* findIcon(CellType cellType, int size)
+{
+    unsigned sizeSlot = (unsigned)(size - 5) / 2;
+    if (sizeSlot >= CELL_SIZES_COUNT || size % 2 == 0)
+        return NULL;
+    return CELL_ICONS_BY_FLAGS[cellType & 0xF][sizeSlot];
+}
+
+// Crosses out a box that can never reach a target.
+static void draw_doomed_box_mark(Canvas* const canvas, int x, int y, int cellSize)
+{
+    canvas_draw_line(canvas, x, y, x + cellSize - 1, y + cellSize - 1);
+    canvas_draw_line(canvas, x + cellSize - 1, y, x, y + cellSize - 1);
+}
+
+// Returns the pixels of an icon, or NULL if they are stored compressed.
+static const uint8_t* icon_bitmap(const Icon* icon)
+{
+    const uint8_t* data = icon_get_data(icon);
+    return data[0] == 0 ? data + 1 : NULL;
+}
+
+static bool are_icons_readable(int cellSize)
+{
+    const CellType CELLS[] = {CellHasWall, CellHasTarget, CellHasBox, CellHasPlayer, CellHasBox | CellHasTarget, CellHasPlayer | CellHasTarget};
+    for (size_t i = 0; i < sizeof(CELLS) / sizeof(CELLS[0]); i++)
+    {
+        const Icon* icon = findIcon(CELLS[i], cellSize);
+        if (icon == NULL || icon_bitmap(icon) == NULL)
+            return false;
+    }
+    return true;
+}
+
+// Sets the pixels of a bitmap where an icon has them, leaving the others as they are. Pixels out of the bitmap are
+// left out.
+static void or_icon(uint8_t* bitmap, int width, int height, int rowBytes, int x, int y, const Icon* icon)
+{
+    const uint8_t* iconBitmap = icon_bitmap(icon);
+    int iconWidth = icon_get_width(icon), iconHeight = icon_get_height(icon);
+    int iconRowBytes = (iconWidth + 7) / 8;
+    for (int iconY = MAX(0, -y); iconY < MIN(iconHeight, height - y); iconY++)
+        for (int iconX = MAX(0, -x); iconX < MIN(iconWidth, width - x); iconX++)
+            if ((iconBitmap[iconY * iconRowBytes + iconX / 8] >> (iconX % 8)) & 1)
+                bitmap[(y + iconY) * rowBytes + (x + iconX) / 8] |= 1 << ((x + iconX) % 8);
+}
+
+// Returns the 8 pixels of a bitmap row that start at a given one. Pixels past the end of the row are clear.
+static uint8_t read_pixels(const uint8_t* row, int rowBytes, int x)
+{
+    int byte = x / 8, shift = x % 8;
+    uint8_t pixels = row[byte] >> shift;
+    if (shift != 0 && byte + 1 < rowBytes)
+        pixels |= row[byte + 1] << (8 - shift);
+    return pixels;
+}
+
+// Sets the pixels of a bitmap row where the 8 given ones are set, starting at a given one. Pixels past the end of the
+// row are left out.
+static void or_pixels(uint8_t* row, int rowBytes, int x, uint8_t pixels)
+{
+    int byte = x / 8, shift = x % 8;
+    row[byte] |= pixels << shift;
+    if (shift != 0 && byte + 1 < rowBytes)
+        row[byte + 1] |= pixels >> (8 - shift);
+}
+
+static void composite_layer(GameRenderer* renderer)
+{
+    const Level* level = renderer->level;
+    renderer->layerWidth = level->level_width * level->cell_size;
+    renderer->layerHeight = level->level_height * level->cell_size;
+    renderer->layerRowBytes = (renderer->layerWidth + 7) / 8;
+    if (renderer->layerRowBytes * renderer->layerHeight > GAME_RENDERER_MAX_LAYER_BYTES)
+        return;
+
+    renderer->layer = calloc(renderer->layerRowBytes * renderer->layerHeight, 1);
+    for (int row = 0; row < level->level_height; row++)
+    {
+        for (int column = 0; column < level->level_width; column++)
+        {
+            const Icon* icon = findIcon(board_get_cell(&level->board, column, row) & (CellHasWall | CellHasTarget), level->cell_size);
+            if (icon != NULL)
+                or_icon(renderer->layer, renderer->layerWidth, renderer->layerHeight, renderer->layerRowBytes, column * level->cell_size, row * level->cell_size, icon);
+        }
+    }
+}
+
+// Centers small levels, and follows the player, or the cursor, in the others without showing anything past their edges.
+static void update_camera(GameRenderer* renderer, GameState* state)
+{
+    int focusX = renderer->hasCursor ? renderer->cursorX : state->playerX;
+    int focusY = renderer->hasCursor ? renderer->cursorY : state->playerY;
+    const Level* level = renderer->level;
+    int cellSize = level->cell_size;
+    int levelWidth = level->level_width * cellSize;
+    int levelHeight = level->level_height * cellSize;
+
+    int minScrollingWidth = SCREEN_WIDTH + (cellSize - 1) * 2;
+    int minScrollingHeight = SCREEN_HEIGHT + (cellSize - 1) * 2;
+
+    renderer->cameraX = levelWidth / 2;
+    if (levelWidth > minScrollingWidth)
+        renderer->cameraX = MAX(SCREEN_WIDTH / 2, MIN(focusX * cellSize, levelWidth - SCREEN_WIDTH / 2));
+
+    renderer->cameraY = levelHeight / 2;
+    if (levelHeight > minScrollingHeight)
+        renderer->cameraY = MAX(SCREEN_HEIGHT / 2, MIN(focusY * cellSize, levelHeight - SCREEN_HEIGHT / 2));
+}
+
+// The frame covers the level where the level is smaller than the screen, centered as the camera centers it, and the whole
+// screen where the camera scrolls.
+static void place_frame(GameRenderer* renderer)
+{
+    const Level* level = renderer->level;
+    int levelWidth = level->level_width * level->cell_size;
+    int levelHeight = level->level_height * level->cell_size;
+    renderer->frameX = MAX(0, SCREEN_WIDTH / 2 - levelWidth / 2);
+    renderer->frameY = MAX(0, SCREEN_HEIGHT / 2 - levelHeight / 2);
+    renderer->frameWidth = MIN(SCREEN_WIDTH - renderer->frameX, levelWidth);
+    renderer->frameHeight = MIN(SCREEN_HEIGHT - renderer->frameY, levelHeight);
+    renderer->frameRowBytes = (renderer->frameWidth + 7) / 8;
+}
+
+GameRenderer* game_renderer_alloc(const Level* level)
+{
+    GameRenderer* renderer = malloc(sizeof(GameRenderer));
+    renderer->level = level;
+    renderer->cameraX = renderer->cameraY = 0;
+    renderer->hasCursor = false;
+    renderer->frame = NULL;
+    renderer->isFrameValid = false;
+    renderer->layer = NULL;
+
+    if (are_icons_readable(level->cell_size))
+    {
+        place_frame(renderer);
+        renderer->frame = malloc(renderer->frameRowBytes * renderer->frameHeight);
+        composite_layer(renderer);
+    }
+    FURI_LOG_D("GAME", "Board drawn %s, %s static layer", renderer->frame != NULL ? "from a frame" : "per cell", renderer->layer != NULL ? "with a" : "without");
+    return renderer;
+}
+
+void game_renderer_free(GameRenderer* renderer)
+{
+    free(renderer->frame);
+    free(renderer->layer);
+    free(renderer);
+}
+
+void game_renderer_show_cursor(GameRenderer* renderer, int column, int row)
+{
+    renderer->hasCursor = true;
+    renderer->cursorX = column;
+    renderer->cursorY = row;
+}
+
+void game_renderer_hide_cursor(GameRenderer* renderer)
+{
+    renderer->hasCursor = false;
+}
+
+bool game_renderer_has_frame(const GameRenderer* renderer)
+{
+    return renderer->frame != NULL;
+}
+
+bool game_renderer_has_layer(const GameRenderer* renderer)
+{
+    return renderer->layer != NULL;
+}
+
+void game_renderer_cell_position(const GameRenderer* renderer, int column, int row, int* ret_x, int* ret_y)
+{
+    *ret_x = column * renderer->level->cell_size - renderer->cameraX + SCREEN_WIDTH / 2;
+    *ret_y = row * renderer->level->cell_size - renderer->cameraY + SCREEN_HEIGHT / 2;
+}
+
+// Returns the range of cells, along one axis, that the screen shows at least partly.
+static void visible_range(int camera, int screenSize, int cellSize, int cellsCount, int* ret_first, int* ret_last)
+{
+    int firstPixel = camera - screenSize / 2;
+    *ret_first = MAX(0, firstPixel / cellSize);
+    *ret_last = MIN(cellsCount - 1, (firstPixel + screenSize - 1) / cellSize);
+}
+
+// Redraws a cell in the frame.
+static void draw_frame_cell(GameRenderer* renderer, int column, int row, CellType cell)
+{
+    int cellSize = renderer->level->cell_size;
+    int x, y;
+    game_renderer_cell_position(renderer, column, row, &x, &y);
+    x -= renderer->frameX;
+    y -= renderer->frameY;
+
+    int firstX = MAX(0, x), lastX = MIN(renderer->frameWidth, x + cellSize);
+    for (int frameY = MAX(0, y); frameY < MIN(renderer->frameHeight, y + cellSize); frameY++)
+    {
+        uint8_t* frameRow = renderer->frame + frameY * renderer->frameRowBytes;
+        for (int frameX = firstX; frameX < lastX; frameX++)
+            frameRow[frameX / 8] &= ~(1 << (frameX % 8));
+    }
+
+    const Icon* icon = findIcon(cell, cellSize);
+    if (icon != NULL)
+        or_icon(renderer->frame, renderer->frameWidth, renderer->frameHeight, renderer->frameRowBytes, x, y, icon);
+}
+
+// Redraws the whole frame: walls and targets from the layer, if there is one, and then every cell that the layer does not
+// already show.
+static void draw_frame(GameRenderer* renderer, GameState* state)
+{
+    const Level* level = renderer->level;
+    memset(renderer->frame, 0, renderer->frameRowBytes * renderer->frameHeight);
+
+    if (renderer->layer != NULL)
+    {
+        int firstLayerX = renderer->frameX + renderer->cameraX - SCREEN_WIDTH / 2;
+        int firstLayerY = renderer->frameY + renderer->cameraY - SCREEN_HEIGHT / 2;
+        for (int y = 0; y < renderer->frameHeight; y++)
+        {
+            const uint8_t* layerRow = renderer->layer + (firstLayerY + y) * renderer->layerRowBytes;
+            uint8_t* frameRow = renderer->frame + y * renderer->frameRowBytes;
+            for (int x = 0; x < renderer->frameWidth; x += 8)
+                or_pixels(frameRow, renderer->frameRowBytes, x, read_pixels(layerRow, renderer->layerRowBytes, firstLayerX + x));
+        }
+    }
+
+    int firstColumn, lastColumn, firstRow, lastRow;
+    visible_range(renderer->cameraX, SCREEN_WIDTH, level->cell_size, level->level_width, &firstColumn, &lastColumn);
+    visible_range(renderer->cameraY, SCREEN_HEIGHT, level->cell_size, level->level_height, &firstRow, &lastRow);
+    for (int row = firstRow; row <= lastRow; row++)
+    {
+        for (int column = firstColumn; column <= lastColumn; column++)
+        {
+            CellType cell = game_state_get_cell(state, column, row);
+            if (renderer->layer == NULL || (cell & (CellHasBox | CellHasPlayer)))
+                draw_frame_cell(renderer, column, row, cell);
+        }
+    }
+}
+
+bool game_renderer_update(GameRenderer* renderer, GameState* state)
+{
+    int cameraX = renderer->cameraX, cameraY = renderer->cameraY;
+    update_camera(renderer, state);
+    bool isCameraMoved = renderer->cameraX != cameraX || renderer->cameraY != cameraY;
+
+    const GameStateDirtyCells* dirty = &state->dirty;
+    bool isChanged = !renderer->isFrameValid || isCameraMoved || dirty->isAllDirty || dirty->count > 0;
+
+    if (renderer->frame != NULL && isChanged)
+    {
+        if (!renderer->isFrameValid || isCameraMoved || dirty->isAllDirty)
+            draw_frame(renderer, state);
+        else
+        {
+            for (int i = 0; i < dirty->count; i++)
+            {
+                int column = dirty->cells[i] % state->levelWidth, row = dirty->cells[i] / state->levelWidth;
+                draw_frame_cell(renderer, column, row, game_state_get_cell(state, column, row));
+            }
+        }
+    }
+
+    renderer->isFrameValid = true;
+    game_state_clear_dirty(state);
+    return isChanged;
+}
+
+// Frames the cell under the cursor, inverting what is around it so it shows over walls too.
+static void draw_cursor(GameRenderer* renderer, Canvas* canvas)
+{
+    int cellSize = renderer->level->cell_size;
+    int x, y;
+    game_renderer_cell_position(renderer, renderer->cursorX, renderer->cursorY, &x, &y);
+    canvas_set_color(canvas, ColorXOR);
+    canvas_draw_frame(canvas, x - 1, y - 1, cellSize + 2, cellSize + 2);
+    canvas_set_color(canvas, ColorBlack);
+}
+
+void game_renderer_draw(GameRenderer* renderer, Canvas* canvas, GameState* state)
+{
+    const Level* level = renderer->level;
+    int cellSize = level->cell_size;
+
+    if (renderer->frame != NULL)
+        canvas_draw_xbm(canvas, renderer->frameX, renderer->frameY, renderer->frameWidth, renderer->frameHeight, renderer->frame);
+
+    if (renderer->frame == NULL || state->isDeadlocked)
+    {
+        int firstColumn, lastColumn, firstRow, lastRow;
+        visible_range(renderer->cameraX, SCREEN_WIDTH, cellSize, level->level_width, &firstColumn, &lastColumn);
+        visible_range(renderer->cameraY, SCREEN_HEIGHT, cellSize, level->level_height, &firstRow, &lastRow);
+        for (int row = firstRow; row <= lastRow; row++)
+        {
+            for (int column = firstColumn; column <= lastColumn; column++)
+            {
+                int x, y;
+                game_renderer_cell_position(renderer, column, row, &x, &y);
+
+                if (renderer->frame == NULL)
+                {
+                    const Icon* icon = findIcon(game_state_get_cell(state, column, row), cellSize);
+                    if (icon)
+                        canvas_draw_icon(canvas, x, y, icon);
+                }
+
+                if (state->isDeadlocked && game_state_is_box_doomed(state, column, row))
+                    draw_doomed_box_mark(canvas, x, y, cellSize);
+            }
+        }
+    }
+
+    if (renderer->hasCursor)
+        draw_cursor(renderer, canvas);
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "game_state.h"
+#include "level.h"
+#include <gui/gui.h>
+
+// Draws a level being played, as the camera sees it. Only the cells on screen are visited.
+// The board is kept drawn in a bitmap of its own, the frame, which each redraw of the screen blits in a single call, so
+// that a move only redraws the cells it changed; the whole frame is redrawn when the camera moves. Walls and targets never change, so they are also
+// composited once per level into a bitmap of the whole level, which the frame is redrawn from, unless it would take more
+// than GAME_RENDERER_MAX_LAYER_BYTES. If the cell icons are stored compressed, their pixels can not be read, and every
+// frame draws the cells on screen as icons instead.
+
+#define GAME_RENDERER_MAX_LAYER_BYTES 4096
+
+typedef struct GameRenderer GameRenderer;
+
+GameRenderer* game_renderer_alloc(const Level* level);
+void game_renderer_free(GameRenderer* renderer);
+
+// Moves the camera to follow the player, and brings the board up to date with the cells that the state reports dirty,
+// which it then clears. Returns whether the board changed since the last update, so frames that would look the same can
+// be skipped. Drawing is separate so that the frame is only written by the thread that changes the state.
+bool game_renderer_update(GameRenderer* renderer, GameState* state);
+
+// Draws the board, as of the last update, with the marks of doomed boxes and the cursor.
+void game_renderer_draw(GameRenderer* renderer, Canvas* canvas, GameState* state);
+
+// Shows a cursor on a cell, which the camera follows instead of the player, or hides it. Takes effect on the next update.
+void game_renderer_show_cursor(GameRenderer* renderer, int column, int row);
+void game_renderer_hide_cursor(GameRenderer* renderer);
+
+// Returns where a cell is on screen, for the camera of the last update.
+void game_renderer_cell_position(const GameRenderer* renderer, int column, int row, int* ret_x, int* ret_y);
+
+// Return whether the board is kept in a frame, and whether the walls and targets are drawn from a composited bitmap.
+bool game_renderer_has_frame(const GameRenderer* renderer);
+bool game_renderer_has_layer(const GameRenderer* renderer);
+
+// Returns the icon of a cell, as CellType flags, for a cell size. NULL for floor, and for sizes without icons.
+const Icon* findIcon(CellType cellType, int size);
@@ -1,69 +1,201 @@
 #include "game_state.h"
 
+#include "deadlock.h"
 #include "level.h"
+#include <furi.h>
 #include <stdlib.h>
 #include <string.h>
 
-GameState* game_state_initialize(Level* level, int undoCapacity)
+static void add_keyframe(GameState* state)
+{
+    if (state->keyframesCount == state->keyframesCapacity)
+    {
+        // Without keyframes, seeking is only slower, so they are the first thing to give up when memory is low.
+        if (memmgr_get_free_heap() < MOVE_JOURNAL_MIN_FREE_HEAP)
+            return;
+        state->keyframesCapacity = MAX(state->keyframesCapacity * 2, 4);
+        state->keyframes = realloc(state->keyframes, state->keyframesCapacity * sizeof(Keyframe));
+        state->keyframeBoxes = realloc(state->keyframeBoxes, state->keyframesCapacity * state->boxesCount * sizeof(uint16_t));
+    }
+
+    Keyframe* keyframe = &state->keyframes[state->keyframesCount];
+    keyframe->mark = move_journal_mark(&state->journal);
+    keyframe->playerX = state->playerX;
+    keyframe->playerY = state->playerY;
+    keyframe->pushesCount = state->pushesCount;
+    keyframe->isDeadlocked = state->isDeadlocked;
+
+    uint16_t* boxes = state->keyframeBoxes + state->keyframesCount * state->boxesCount;
+    int boxIndex = 0;
+    for (int y = 0; y < state->levelHeight; y++)
+        for (int x = 0; x < state->levelWidth; x++)
+            if (box_layer_has_box(&state->level->board, &state->boxes, x, y))
+                boxes[boxIndex++] = y * state->levelWidth + x;
+
+    state->keyframesCount += 1;
+}
+
+// Keeps the keyframes in step with the journal, after a move is recorded: keyframes of moves that were dropped or recorded
+// over are removed, and a new keyframe is taken at every KEYFRAME_INTERVAL moves.
+static void update_keyframes(GameState* state)
+{
+    int position = move_journal_position(&state->journal);
+    while (state->keyframesCount > 0 && state->keyframes[state->keyframesCount - 1].mark.position >= position)
+        state->keyframesCount -= 1;
+
+    int dropped = 0;
+    while (dropped < state->keyframesCount && state->keyframes[dropped].mark.position < state->journal.droppedCount)
+        dropped += 1;
+    if (dropped > 0)
+    {
+        state->keyframesCount -= dropped;
+        memmove(state->keyframes, state->keyframes + dropped, state->keyframesCount * sizeof(Keyframe));
+        memmove(state->keyframeBoxes, state->keyframeBoxes + dropped * state->boxesCount, state->keyframesCount * state->boxesCount * sizeof(uint16_t));
+    }
+
+    if (position % KEYFRAME_INTERVAL == 0)
+        add_keyframe(state);
+}
+
+// Keeps the groups in step with the journal, after a move is recorded, as update_keyframes does with keyframes.
+static void update_groups(GameState* state)
+{
+    int position = move_journal_position(&state->journal);
+    while (state->groupsCount > 0 && state->groups[state->groupsCount - 1].end >= position)
+        state->groupsCount -= 1;
+
+    int dropped = 0;
+    while (dropped < state->groupsCount && state->groups[dropped].start < state->journal.droppedCount)
+        dropped += 1;
+    if (dropped > 0)
+    {
+        state->groupsCount -= dropped;
+        memmove(state->groups, state->groups + dropped, state->groupsCount * sizeof(MoveGroup));
+    }
+}
+
+static void mark_dirty(GameState* state, int x, int y)
+{
+    GameStateDirtyCells* dirty = &state->dirty;
+    if (dirty->isAllDirty)
+        return;
+
+    uint16_t cell = y * state->levelWidth + x;
+    for (int i = 0; i < dirty->count; i++)
+        if (dirty->cells[i] == cell)
+            return;
+
+    if (dirty->count == GAME_STATE_MAX_DIRTY_CELLS)
+        dirty->isAllDirty = true;
+    else
+        dirty->cells[dirty->count++] = cell;
+}
+
+void game_state_clear_dirty(GameState* state)
+{
+    state->dirty.isAllDirty = false;
+    state->dirty.count = 0;
+}
+
+void game_state_mark_all_dirty(GameState* state)
+{
+    state->dirty.isAllDirty = true;
+}
+
+// SplitMix64 finalizer: every bit of the result depends on every bit of the input.
+static uint64_t mix_bits(uint64_t value)
+{
+    value += 0x9E3779B97F4A7C15ull;
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+    return value ^ (value >> 31);
+}
+
+uint64_t game_state_box_key(int cell)
+{
+    return mix_bits(cell);
+}
+
+uint64_t game_state_player_key(int cell)
+{
+    return mix_bits(cell + 0x10000);
+}
+
+GameState* game_state_initialize(const Level* level)
 {
     GameState* state = malloc(sizeof(GameState));
 
-    state->playerX = state->playerY = state->pushesCount = 0;
-    state->isCompleted = false;
+    state->level = level;
+    state->playerX = level->player_start_x;
+    state->playerY = level->player_start_y;
+    state->pushesCount = 0;
 
     state->levelWidth = level->level_width;
     state->levelHeight = level->level_height;
-    memcpy(state->board, level->board, sizeof(CellType) * MAX_BOARD_SIZE * MAX_BOARD_SIZE);
+    box_layer_init(&state->boxes, &level->board);
+
+    state->boxesOffTargetCount = box_layer_count_boxes_off_target(&level->board, &state->boxes);
+    state->isCompleted = state->boxesOffTargetCount == 0;
+    state->isDeadlocked = deadlock_check_position(&level->board, &state->boxes);
+
+    move_journal_init(&state->journal);
 
-    for (int y = 0; y < level->level_height; y++)
+    state->boxesCount = 0;
+    state->boxesHash = 0;
+    for (int y = 0; y < state->levelHeight; y++)
     {
-        for (int x = 0; x < level->level_width; x++)
+        for (int x = 0; x < state->levelWidth; x++)
         {
-            if (state->board[y][x] & CellHasPlayer)
+            if (box_layer_has_box(&level->board, &state->boxes, x, y))
             {
-                state->playerX = x;
-                state->playerY = y;
+                state->boxesCount += 1;
+                state->boxesHash ^= game_state_box_key(y * state->levelWidth + x);
             }
         }
     }
+    state->keyframesCount = state->keyframesCapacity = 0;
+    state->keyframes = NULL;
+    state->keyframeBoxes = NULL;
+    add_keyframe(state);
+
+    state->dirty.isAllDirty = true;
+    state->dirty.count = 0;
 
-    state->undoHead = state->undoTail = 0;
-    state->undoCapacity = undoCapacity;
-    state->undoBuffer = malloc(undoCapacity * sizeof(UndoToken));
+    state->groupsCount = state->groupsCapacity = 0;
+    state->groups = NULL;
+    state->groupStart = -1;
 
     return state;
 }
 
 void game_state_free(GameState* state)
 {
-    free(state->undoBuffer);
+    box_layer_free(&state->boxes);
+    move_journal_free(&state->journal);
+    free(state->keyframes);
+    free(state->keyframeBoxes);
+    free(state->groups);
     free(state);
 }
 
-enum UndoFlags {
-    UndoInvalid = 0x80,
-
-    UndoDirectionMask = 0x03,
-    UndoLeft = 0x00,
-    UndoRight = 0x01,
-    UndoUp = 0x02,
-    UndoDown = 0x03,
-
-    UndoBoxPushed = 0x04,
-};
-
 static void verify_level_completed(GameState* state)
 {
-    for (int y = 0; y < state->levelHeight; y++)
-    {
-        for (int x = 0; x < state->levelWidth; x++)
-        {
-            if ((state->board[y][x] & CellHasBox) && !(state->board[y][x] & CellHasTarget))
-                return;
-        }
-    }
+    state->isCompleted = state->boxesOffTargetCount == 0;
+}
 
-    state->isCompleted = true;
+// Moves a box, keeping the count of boxes out of their targets up to date.
+static void move_box(GameState* state, int fromX, int fromY, int toX, int toY)
+{
+    const Board* board = &state->level->board;
+    box_layer_move_box(board, &state->boxes, fromX, fromY, toX, toY);
+    state->boxesHash ^= game_state_box_key(fromY * state->levelWidth + fromX) ^ game_state_box_key(toY * state->levelWidth + toX);
+    mark_dirty(state, fromX, fromY);
+    mark_dirty(state, toX, toY);
+
+    if (!board_has_target(board, fromX, fromY))
+        state->boxesOffTargetCount -= 1;
+    if (!board_has_target(board, toX, toY))
+        state->boxesOffTargetCount += 1;
 }
 
 static bool is_in_bounds(GameState *state, int x, int y)
@@ -72,110 +204,392 @@ static bool is_in_bounds(GameState *state, int x, int y)
         && 0 <= y && y < state->levelHeight;
 }
 
-static void undo_push(GameState *state, UndoToken token)
+static void move_direction(JournalMove move, int* ret_dx, int* ret_dy)
 {
-    state->undoHead += 1;
-    if (state->undoHead == state->undoCapacity)
-        state->undoHead = 0;
-    state->undoBuffer[state->undoHead] = token;
+    *ret_dx = *ret_dy = 0;
+    if ((move & MoveDirectionMask) == MoveLeft)
+        *ret_dx = -1;
+    if ((move & MoveDirectionMask) == MoveRight)
+        *ret_dx = +1;
+    if ((move & MoveDirectionMask) == MoveUp)
+        *ret_dy = -1;
+    if ((move & MoveDirectionMask) == MoveDown)
+        *ret_dy = +1;
+}
 
-    if (state->undoHead == state->undoTail)
+// Performs a move that is known to be legal.
+static void perform_move(GameState* state, JournalMove move)
+{
+    int dx, dy;
+    move_direction(move, &dx, &dy);
+    int newX = state->playerX + dx, newY = state->playerY + dy;
+
+    if (move & MoveBoxPushed)
     {
-        state->undoTail += 1;
-        if (state->undoTail == state->undoCapacity)
-            state->undoTail = 0;
+        int newBoxX = newX + dx, newBoxY = newY + dy;
+        move_box(state, newX, newY, newBoxX, newBoxY);
+        state->pushesCount += 1;
+
+        // A deadlock can not be undone by other pushes, so only the pushed box needs to be checked.
+        if (!state->isDeadlocked)
+            state->isDeadlocked = deadlock_check_push(&state->level->board, &state->boxes, newBoxX, newBoxY);
+    }
+
+    if (state->groupStart < 0)
+    {
+        mark_dirty(state, state->playerX, state->playerY);
+        mark_dirty(state, newX, newY);
     }
+    state->playerX = newX;
+    state->playerY = newY;
 }
 
-static UndoToken undo_pop(GameState *state)
+// Makes and records a move, if it is legal, without checking whether the level is completed. Returns whether it was.
+static bool record_move(GameState* state, int dx, int dy)
 {
-    if (state->undoHead == state->undoTail)
-        return UndoInvalid;
+    int newX = state->playerX + dx, newY = state->playerY + dy;
+    if ((dx == 0 && dy == 0) || !is_in_bounds(state, newX, newY))
+        return false;
 
-    UndoToken token = state->undoBuffer[state->undoHead];
-    state->undoHead -= 1;
-    if (state->undoHead < 0)
-        state->undoHead = state->undoCapacity - 1;
-    return token;
+    JournalMove move;
+    if (dx < 0)
+        move = MoveLeft;
+    else if (dx > 0)
+        move = MoveRight;
+    else if (dy < 0)
+        move = MoveUp;
+    else
+        move = MoveDown;
+
+    const Board* board = &state->level->board;
+    if (board_has_wall(board, newX, newY))
+        return false;
+
+    if (box_layer_has_box(board, &state->boxes, newX, newY))
+    {
+        int newBoxX = newX + dx, newBoxY = newY + dy;
+        if (!is_in_bounds(state, newBoxX, newBoxY))
+            return false;
+
+        if (board_has_wall(board, newBoxX, newBoxY) || box_layer_has_box(board, &state->boxes, newBoxX, newBoxY))
+            return false;
+
+        move |= MoveBoxPushed;
+    }
+
+    perform_move(state, move);
+    move_journal_record(&state->journal, move);
+    update_keyframes(state);
+    update_groups(state);
+    return true;
 }
 
 void game_state_apply_move(GameState* state, int dx, int dy)
 {
-    int newX = state->playerX + dx, newY = state->playerY + dy;
-    if (!is_in_bounds(state, newX, newY))
-        return;
+    if (record_move(state, dx, dy))
+        verify_level_completed(state);
+}
 
-    UndoToken token;
-    if (dx < 0)
-        token = UndoLeft;
-    if (dx > 0)
-        token = UndoRight;
-    if (dy < 0)
-        token = UndoUp;
-    if (dy > 0)
-        token = UndoDown;
-
-    CellType newCell = state->board[newY][newX];
-    if (newCell & CellHasWall)
+void game_state_begin_group(GameState* state)
+{
+    state->groupStart = game_state_position(state);
+    state->groupPlayerX = state->playerX;
+    state->groupPlayerY = state->playerY;
+}
+
+void game_state_end_group(GameState* state)
+{
+    int start = state->groupStart, position = game_state_position(state);
+    bool isGroup = position - start > 1 && start >= state->journal.droppedCount;
+    state->groupStart = -1;
+    mark_dirty(state, state->groupPlayerX, state->groupPlayerY);
+    mark_dirty(state, state->playerX, state->playerY);
+    if (!isGroup)
         return;
 
-    if (newCell & CellHasBox)
+    if (state->groupsCount == state->groupsCapacity)
     {
-        int newBoxX = newX + dx, newBoxY = newY + dy;
-        if (!is_in_bounds(state, newBoxX, newBoxY))
-            return;
-
-        CellType newBoxCell = state->board[newBoxY][newBoxX];
-        if ((newBoxCell & CellHasWall) || (newBoxCell & CellHasBox))
+        // Without groups, undo only goes back one move at a time, so they are given up when memory is low.
+        if (memmgr_get_free_heap() < MOVE_JOURNAL_MIN_FREE_HEAP)
             return;
+        state->groupsCapacity = MAX(state->groupsCapacity * 2, 4);
+        state->groups = realloc(state->groups, state->groupsCapacity * sizeof(MoveGroup));
+    }
+    state->groups[state->groupsCount++] = (MoveGroup){.start = start, .end = position};
+}
 
-        token |= UndoBoxPushed;
+int game_state_apply_moves(GameState* state, const JournalMove* moves, int count)
+{
+    game_state_begin_group(state);
+    int applied = 0;
+    while (applied < count)
+    {
+        int dx, dy;
+        move_direction(moves[applied], &dx, &dy);
+        if (!record_move(state, dx, dy))
+            break;
+        applied += 1;
+    }
+    game_state_end_group(state);
+    verify_level_completed(state);
+    return applied;
+}
 
-        state->board[newBoxY][newBoxX] |= CellHasBox;
-        state->board[newY][newX] = newCell & ~CellHasBox;
-        state->pushesCount += 1;
+JournalMove game_state_lurd_move(const Level* level, char letter)
+{
+    JournalMove move;
+    switch (letter | 0x20)
+    {
+    case 'l':
+        move = MoveLeft;
+        break;
+    case 'r':
+        move = MoveRight;
+        break;
+    case 'u':
+        move = MoveUp;
+        break;
+    case 'd':
+        move = MoveDown;
+        break;
+    default:
+        return MoveInvalid;
     }
 
-    state->board[newY][newX] |= CellHasPlayer;
-    state->board[state->playerY][state->playerX] &= ~CellHasPlayer;
+    // Rotated levels swap rows and columns, which turns left into up and right into down.
+    if (level->is_rotated)
+        move ^= MoveUp;
+    if (letter >= 'A' && letter <= 'Z')
+        move |= MoveBoxPushed;
+    return move;
+}
 
-    state->playerX = newX;
-    state->playerY = newY;
+bool game_state_apply_lurd_move(GameState* state, char letter)
+{
+    JournalMove move = game_state_lurd_move(state->level, letter);
+    if (move == MoveInvalid)
+        return false;
+
+    int dx, dy;
+    move_direction(move, &dx, &dy);
+    int x = state->playerX + dx, y = state->playerY + dy;
+    if (!is_in_bounds(state, x, y))
+        return false;
+    bool isPush = box_layer_has_box(&state->level->board, &state->boxes, x, y);
+    if (isPush != ((move & MoveBoxPushed) != 0) || !record_move(state, dx, dy))
+        return false;
 
-    undo_push(state, token);
     verify_level_completed(state);
+    return true;
+}
+
+void game_state_check_lurd(const Level* level, const char* lurd, LurdCheck* ret_check)
+{
+    const Board* board = &level->board;
+    BoxLayer boxes;
+    box_layer_init(&boxes, board);
+    int boxesOffTargetCount = box_layer_count_boxes_off_target(board, &boxes);
+    int playerX = level->player_start_x, playerY = level->player_start_y;
+    int width = level->level_width, height = level->level_height;
+    int index = 0, pushesCount = 0;
+
+    for (; lurd[index] != '\0'; index++)
+    {
+        JournalMove move = game_state_lurd_move(level, lurd[index]);
+        if (move == MoveInvalid)
+            break;
+
+        int dx, dy;
+        move_direction(move, &dx, &dy);
+        int x = playerX + dx, y = playerY + dy;
+        if (x < 0 || x >= width || y < 0 || y >= height || board_has_wall(board, x, y))
+            break;
+
+        bool isPush = box_layer_has_box(board, &boxes, x, y);
+        if (isPush != ((move & MoveBoxPushed) != 0))
+            break;
+        if (isPush)
+        {
+            int boxX = x + dx, boxY = y + dy;
+            if (boxX < 0 || boxX >= width || boxY < 0 || boxY >= height || board_has_wall(board, boxX, boxY) || box_layer_has_box(board, &boxes, boxX, boxY))
+                break;
+            box_layer_move_box(board, &boxes, x, y, boxX, boxY);
+            boxesOffTargetCount += !board_has_target(board, boxX, boxY) - !board_has_target(board, x, y);
+            pushesCount += 1;
+        }
+        playerX = x;
+        playerY = y;
+    }
+
+    ret_check->movesCount = index;
+    ret_check->pushesCount = pushesCount;
+    ret_check->illegalMove = lurd[index] != '\0' ? index : -1;
+    ret_check->isCompleted = boxesOffTargetCount == 0;
+    box_layer_free(&boxes);
+}
+
+// Returns the group that ends, or starts, at a position, or NULL if there is none.
+static const MoveGroup* find_group(const GameState* state, int position, bool isEnd)
+{
+    int low = 0, high = state->groupsCount - 1;
+    while (low <= high)
+    {
+        int middle = (low + high) / 2;
+        int bound = isEnd ? state->groups[middle].end : state->groups[middle].start;
+        if (bound == position)
+            return &state->groups[middle];
+        if (bound < position)
+            low = middle + 1;
+        else
+            high = middle - 1;
+    }
+    return NULL;
+}
+
+int game_state_undo_position(const GameState* state)
+{
+    const MoveGroup* group = find_group(state, game_state_position(state), true);
+    return group != NULL ? group->start : game_state_position(state) - 1;
+}
+
+int game_state_redo_position(const GameState* state)
+{
+    const MoveGroup* group = find_group(state, game_state_position(state), false);
+    return group != NULL ? group->end : game_state_position(state) + 1;
 }
 
 void game_state_undo_move(GameState* state)
 {
-    UndoToken token = undo_pop(state);
-    if (token == UndoInvalid)
+    JournalMove move = move_journal_undo(&state->journal);
+    if (move == MoveInvalid)
         return;
 
-    int dx = 0, dy = 0;
-    if ((token & UndoDirectionMask) == UndoLeft)
-        dx = -1;
-    if ((token & UndoDirectionMask) == UndoRight)
-        dx = +1;
-    if ((token & UndoDirectionMask) == UndoUp)
-        dy = -1;
-    if ((token & UndoDirectionMask) == UndoDown)
-        dy = +1;
-
-    if (token & UndoBoxPushed)
+    int dx, dy;
+    move_direction(move, &dx, &dy);
+
+    if (move & MoveBoxPushed)
     {
         int boxX = state->playerX + dx, boxY = state->playerY + dy;
-        state->board[boxY][boxX] &= ~CellHasBox;
-        state->board[state->playerY][state->playerX] |= CellHasBox;
+        move_box(state, boxX, boxY, state->playerX, state->playerY);
         state->pushesCount -= 1;
+
+        if (state->isDeadlocked)
+            state->isDeadlocked = deadlock_check_position(&state->level->board, &state->boxes);
     }
 
     int oldX = state->playerX - dx, oldY = state->playerY - dy;
-    state->board[state->playerY][state->playerX] &= ~CellHasPlayer;
-    state->board[oldY][oldX] |= CellHasPlayer;
-
+    mark_dirty(state, state->playerX, state->playerY);
+    mark_dirty(state, oldX, oldY);
     state->playerX = oldX;
     state->playerY = oldY;
 
     verify_level_completed(state);
+}
+
+void game_state_redo_move(GameState* state)
+{
+    JournalMove move = move_journal_redo(&state->journal);
+    if (move == MoveInvalid)
+        return;
+
+    perform_move(state, move);
+    verify_level_completed(state);
+}
+
+static void restore_keyframe(GameState* state, const Keyframe* keyframe)
+{
+    const Board* board = &state->level->board;
+    const uint16_t* boxes = state->keyframeBoxes + (keyframe - state->keyframes) * state->boxesCount;
+
+    state->dirty.isAllDirty = true;
+    box_layer_clear(board, &state->boxes);
+    state->boxesOffTargetCount = 0;
+    state->boxesHash = 0;
+    for (int i = 0; i < state->boxesCount; i++)
+    {
+        int x = boxes[i] % state->levelWidth, y = boxes[i] / state->levelWidth;
+        box_layer_add_box(board, &state->boxes, x, y);
+        state->boxesHash ^= game_state_box_key(boxes[i]);
+        if (!board_has_target(board, x, y))
+            state->boxesOffTargetCount += 1;
+    }
+
+    state->playerX = keyframe->playerX;
+    state->playerY = keyframe->playerY;
+    state->pushesCount = keyframe->pushesCount;
+    state->isDeadlocked = keyframe->isDeadlocked;
+    move_journal_restore(&state->journal, keyframe->mark);
+    verify_level_completed(state);
+}
+
+// Returns the last keyframe at or before a position, or NULL if there is none.
+static const Keyframe* find_keyframe(const GameState* state, int position)
+{
+    int low = 0, high = state->keyframesCount - 1;
+    const Keyframe* found = NULL;
+    while (low <= high)
+    {
+        int middle = (low + high) / 2;
+        if (state->keyframes[middle].mark.position <= position)
+        {
+            found = &state->keyframes[middle];
+            low = middle + 1;
+        }
+        else
+            high = middle - 1;
+    }
+    return found;
+}
+
+void game_state_seek(GameState* state, int position)
+{
+    position = MAX(game_state_first_position(state), MIN(position, game_state_last_position(state)));
+
+    int current = game_state_position(state);
+    const Keyframe* keyframe = find_keyframe(state, position);
+    if (keyframe != NULL && position - keyframe->mark.position < abs(position - current))
+        restore_keyframe(state, keyframe);
+
+    while (game_state_position(state) < position)
+        game_state_redo_move(state);
+    while (game_state_position(state) > position)
+        game_state_undo_move(state);
+}
+
+int game_state_position(const GameState* state)
+{
+    return move_journal_position(&state->journal);
+}
+
+int game_state_first_position(const GameState* state)
+{
+    return state->journal.droppedCount;
+}
+
+int game_state_last_position(const GameState* state)
+{
+    return state->journal.droppedCount + state->journal.undoCount + state->journal.redoCount;
+}
+
+CellType game_state_get_cell(GameState* state, int x, int y)
+{
+    CellType cell = box_layer_get_cell(&state->level->board, &state->boxes, x, y);
+    if (x == state->playerX && y == state->playerY)
+        cell |= CellHasPlayer;
+    return cell;
+}
+
+bool game_state_is_box_doomed(const GameState* state, int x, int y)
+{
+    const Board* board = &state->level->board;
+    if (!box_layer_has_box(board, &state->boxes, x, y) || board_has_target(board, x, y))
+        return false;
+    return board_is_dead_square(board, x, y) || deadlock_is_box_frozen(board, &state->boxes, x, y, NULL);
+}
+
+int game_state_memory_size(GameState* state)
+{
+    int keyframesSize = state->keyframesCapacity * (sizeof(Keyframe) + state->boxesCount * sizeof(uint16_t));
+    int groupsSize = state->groupsCapacity * sizeof(MoveGroup);
+    return sizeof(GameState) + box_layer_heap_size(&state->level->board, &state->boxes) + move_journal_heap_size(&state->journal) + keyframesSize + groupsSize;
 }
\ No newline at end of file
@@ -1,22 +1,128 @@
 #pragma once
 
+#include "board.h"
 #include "level.h"
+#include "move_journal.h"
 #include <stdbool.h>
+#include <stdint.h>
 
-typedef char UndoToken;
+// Snapshot of the position after a given move, so the history can be sought without replaying it from the start.
+// The boxes are kept apart, in GameState.keyframeBoxes, as a list of cells.
+typedef struct Keyframe
+{
+    MoveJournalMark mark;
+    int playerX, playerY, pushesCount;
+    bool isDeadlocked;
+} Keyframe;
+
+// Moves from start to end positions that undo and redo go through in one step, such as the moves of a walk to a chosen
+// cell.
+typedef struct MoveGroup
+{
+    int start, end;
+} MoveGroup;
+
+// A keyframe is taken every this many moves, so seeking never replays more moves than this.
+#define KEYFRAME_INTERVAL 64
 
+// Cells whose contents changed since they were last cleared, so that a view can redraw only those. When more cells
+// changed than fit, or the whole position was replaced, isAllDirty is set instead.
+#define GAME_STATE_MAX_DIRTY_CELLS 12
+
+typedef struct GameStateDirtyCells
+{
+    bool isAllDirty;
+    int count;
+    uint16_t cells[GAME_STATE_MAX_DIRTY_CELLS]; // y * levelWidth + x
+} GameStateDirtyCells;
+
+// The state of a level being played. Walls and targets are read from the level, which must outlive the state;
+// only the boxes and the player are owned by the state.
 typedef struct GameState
 {
+    const Level* level;
     int playerX, playerY, pushesCount;
     int levelWidth, levelHeight;
-    CellType board[MAX_BOARD_SIZE][MAX_BOARD_SIZE];
+    BoxLayer boxes;
+    int boxesOffTargetCount;
     bool isCompleted;
-    int undoHead, undoTail, undoCapacity;
-    UndoToken* undoBuffer;
+    bool isDeadlocked; // Whether a box is on a dead square or frozen out of a target, so the level can not be completed anymore.
+    MoveJournal journal;
+    int boxesCount;
+    int keyframesCount, keyframesCapacity;
+    Keyframe* keyframes;
+    uint16_t* keyframeBoxes; // boxesCount cells (y * levelWidth + x) for each keyframe.
+    GameStateDirtyCells dirty; // Starts all dirty.
+    int groupsCount, groupsCapacity;
+    MoveGroup* groups; // Oldest first.
+    int groupStart; // Position where the group being recorded began, or -1.
+    int groupPlayerX, groupPlayerY;
+    uint64_t boxesHash; // XOR of the game_state_box_key of every box, kept up to date by every move.
 } GameState;
 
-GameState* game_state_initialize(Level* level, int undoCapacity);
+// Result of playing a solution in LURD notation (see game_state_check_lurd).
+typedef struct LurdCheck
+{
+    int movesCount, pushesCount; // Of the moves that could be made.
+    int illegalMove;             // Index of the first letter that is not a move that can be made as written, or -1.
+    bool isCompleted;            // Whether the level is completed after the moves that could be made.
+} LurdCheck;
+
+GameState* game_state_initialize(const Level* level);
+
+// Zobrist keys of a box, and of the player, on a cell (y * levelWidth + x), for hashing positions: the hash of a position
+// is the XOR of the keys of its boxes and its player. They are computed from the cell rather than kept in a table, so
+// they take no memory. Boards have fewer than 65536 cells, and player keys are those of the cells past them.
+uint64_t game_state_box_key(int cell);
+uint64_t game_state_player_key(int cell);
 void game_state_free(GameState* state);
 
 void game_state_apply_move(GameState* state, int dx, int dy);
-void game_state_undo_move(GameState* state);
\ No newline at end of file
+void game_state_undo_move(GameState* state);
+void game_state_redo_move(GameState* state);
+
+// Moves applied between these calls make a group, which undo and redo go through in one step. Within a group, only the
+// cells where the player started and ended, and those of pushed boxes, are marked dirty.
+void game_state_begin_group(GameState* state);
+void game_state_end_group(GameState* state);
+// Applies moves in a group, as game_state_apply_move would, and checks whether the level is completed once, at the end.
+// Stops at the first move that can not be made. Returns the count of moves applied.
+int game_state_apply_moves(GameState* state, const JournalMove* moves, int count);
+// Solutions in LURD notation have a letter per move, in the order of the journal moves: l, r, u and d walk, and L, R,
+// U and D push a box. The letters are for the level as written in its collection: on a rotated level, left and up
+// swap, and so do right and down.
+// Returns the move of a letter, with MoveBoxPushed for pushes, or MoveInvalid if the letter is not a move.
+JournalMove game_state_lurd_move(const Level* level, char letter);
+// Applies the move of a letter, if it can be made as written: a walk must not push a box, and a push must. Returns
+// whether it was applied.
+bool game_state_apply_lurd_move(GameState* state, char letter);
+// Plays a solution from the start of a level, up to its end or its first illegal move. Only the player and a box layer
+// are moved, with no journal, dirty cells or deadlock checks, so whole collections of solutions can be checked quickly.
+void game_state_check_lurd(const Level* level, const char* lurd, LurdCheck* ret_check);
+
+// Returns the position that undoing or redoing from the current one goes to: past the whole group next to it, if any,
+// or a single move otherwise.
+int game_state_undo_position(const GameState* state);
+int game_state_redo_position(const GameState* state);
+
+// Moves through the history to the position after the given count of moves, as if undoing or redoing moves up to it.
+// It restores the nearest keyframe and replays at most KEYFRAME_INTERVAL moves.
+void game_state_seek(GameState* state, int position);
+// Returns the count of moves done, and the range of positions that can be sought.
+int game_state_position(const GameState* state);
+int game_state_first_position(const GameState* state);
+int game_state_last_position(const GameState* state);
+
+// Returns the contents of a cell as CellType flags, including the player.
+CellType game_state_get_cell(GameState* state, int x, int y);
+
+// Forgets the dirty cells, once a view has redrawn them.
+void game_state_clear_dirty(GameState* state);
+// Marks every cell dirty, for a view that drew something else since it last drew this state.
+void game_state_mark_all_dirty(GameState* state);
+
+// Returns whether there is a box in a cell that can never reach a target: it is on a dead square, or frozen out of a target.
+bool game_state_is_box_doomed(const GameState* state, int x, int y);
+
+// Returns the memory used by the state, including its box layer, move journal and keyframes, in bytes.
+int game_state_memory_size(GameState* state);
@@ -0,0 +1,105 @@
+#include "hint.h"
+
+#include "solver.h"
+#include <furi.h>
+#include <stdlib.h>
+
+// Nodes expanded between two checks of the time budget.
+#define EXPANSIONS_PER_SLICE 16
+// Searches that can not afford this many nodes are not started.
+#define MIN_NODES 64
+
+static const int DIRECTION_DX[4] = {-1, 1, 0, 0};
+static const int DIRECTION_DY[4] = {0, 0, -1, 1};
+
+struct Hint
+{
+    Solver* solver;
+    HintStatus status;
+    int boxX, boxY, direction;
+    uint32_t startTick;
+    int ticksCount;
+};
+
+static void hint_finish(Hint* hint, SolverStatus solverStatus)
+{
+    bool hasPush = solver_first_push(hint->solver, &hint->boxX, &hint->boxY, &hint->direction);
+    if (solverStatus == SolverStatus_Solved && hasPush)
+        hint->status = HintStatus_Found;
+    else if (solverStatus == SolverStatus_OutOfMemory && hasPush)
+        hint->status = HintStatus_Guessed;
+    else
+        hint->status = HintStatus_NotFound;
+
+    int expansions = solver_expansions_count(hint->solver);
+    FURI_LOG_D("GAME", "Hint status %d: %d nodes in %d ticks (%d nodes/tick), %lu ms", hint->status, expansions, hint->ticksCount, expansions / MAX(hint->ticksCount, 1), (unsigned long)(furi_get_tick() - hint->startTick));
+
+    // The push is all that is needed from now on.
+    solver_free(hint->solver);
+    hint->solver = NULL;
+}
+
+Hint* hint_start(const GameState* state)
+{
+    Hint* hint = malloc(sizeof(Hint));
+    hint->solver = NULL;
+    hint->status = HintStatus_Searching;
+    hint->startTick = furi_get_tick();
+    hint->ticksCount = 0;
+
+    size_t memory = MIN((size_t)HINT_MAX_MEMORY, memmgr_get_free_heap() / 2);
+    int maxNodes = solver_max_nodes_for_memory(state->level, solver_heuristic_push_distance, memory);
+    FURI_LOG_D("GAME", "Hint search: %d nodes in %u bytes", maxNodes, (unsigned)memory);
+    if (state->isDeadlocked || maxNodes < MIN_NODES)
+    {
+        hint->status = HintStatus_NotFound;
+        return hint;
+    }
+
+    hint->solver = solver_alloc(state, maxNodes, solver_heuristic_push_distance);
+    return hint;
+}
+
+void hint_free(Hint* hint)
+{
+    if (hint->solver != NULL)
+        solver_free(hint->solver);
+    free(hint);
+}
+
+HintStatus hint_step(Hint* hint, uint32_t budgetMs)
+{
+    if (hint->status != HintStatus_Searching)
+        return hint->status;
+
+    uint32_t start = furi_get_tick();
+    int expansionsBefore = solver_expansions_count(hint->solver);
+    SolverStatus solverStatus = SolverStatus_Running;
+    do
+        solverStatus = solver_run(hint->solver, EXPANSIONS_PER_SLICE);
+    while (solverStatus == SolverStatus_Running && furi_get_tick() - start < budgetMs);
+
+    hint->ticksCount += 1;
+    FURI_LOG_T("GAME", "Hint tick %d: %d nodes", hint->ticksCount, solver_expansions_count(hint->solver) - expansionsBefore);
+
+    if (solverStatus != SolverStatus_Running)
+        hint_finish(hint, solverStatus);
+    return hint->status;
+}
+
+HintStatus hint_status(const Hint* hint)
+{
+    return hint->status;
+}
+
+bool hint_get_push(const Hint* hint, int* ret_x, int* ret_y, int* ret_dx, int* ret_dy)
+{
+    if (hint->status != HintStatus_Found && hint->status != HintStatus_Guessed)
+        return false;
+
+    *ret_x = hint->boxX;
+    *ret_y = hint->boxY;
+    *ret_dx = DIRECTION_DX[hint->direction];
+    *ret_dy = DIRECTION_DY[hint->direction];
+    return true;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "game_state.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// "Next push" hint: a solver search from the current position, run a few milliseconds at a time, so the game stays
+// responsive while it thinks. Its memory is allocated up front, within HINT_MAX_MEMORY and half of the free heap.
+// If the search runs out of nodes before it finds a solution, the hint is the first push towards the most promising
+// position it found.
+
+#define HINT_MAX_MEMORY (48 * 1024)
+
+typedef struct Hint Hint;
+
+typedef enum HintStatus
+{
+    HintStatus_Searching,
+    HintStatus_Found,    // The first push of an optimal solution.
+    HintStatus_Guessed,  // The first push towards the position closest to a solution within the node budget.
+    HintStatus_NotFound, // The position can not be solved, or there was no memory to search.
+} HintStatus;
+
+// Starts a search from the current position. The state can change or be freed afterwards, but its level must outlive the hint.
+Hint* hint_start(const GameState* state);
+void hint_free(Hint* hint);
+
+// Searches for up to the given milliseconds, and returns the status of the hint.
+HintStatus hint_step(Hint* hint, uint32_t budgetMs);
+HintStatus hint_status(const Hint* hint);
+
+// Once the hint is found or guessed, returns the box to push, and the direction to push it.
+bool hint_get_push(const Hint* hint, int* ret_x, int* ret_y, int* ret_dx, int* ret_dy);
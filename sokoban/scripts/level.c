@@ -1,47 +1,34 @@
 #include "level.h"
 
+#include "collection_index.h"
+#include "deadlock.h"
+#include "level_pack.h"
 #include "wave/files/file_lines_reader.h"
 #include <furi.h>
 #include <storage/storage.h>
 #include <stdlib.h>
 #include <string.h>
 
-static int parse_row(const char* line, CellType* row)
+int level_parse_cell(char ch)
 {
-    const char *ch = line;
-    int i = 0;
-    while (true)
+    switch (ch)
     {
-        if (i >= MAX_BOARD_SIZE)
-            return -1;
-        switch (*(ch++))
-        {
-        case '\0':
-            return i;
-        case '#':
-            row[i++] = CellHasWall;
-            break;
-        case '*':
-            row[i++] = CellHasBox | CellHasTarget;
-            break;
-        case '.':
-            row[i++] = CellHasTarget;
-            break;
-        case '@':
-            row[i++] = CellHasPlayer;
-            break;
-        case '+':
-            row[i++] = CellHasPlayer | CellHasTarget;
-            break;
-        case '$':
-            row[i++] = CellHasBox;
-            break;
-        case ' ':
-            row[i++] = 0;
-            break;
-        default:
-            return -2;
-        }
+    case '#':
+        return CellHasWall;
+    case '*':
+        return CellHasBox | CellHasTarget;
+    case '.':
+        return CellHasTarget;
+    case '@':
+        return CellHasPlayer;
+    case '+':
+        return CellHasPlayer | CellHasTarget;
+    case '$':
+        return CellHasBox;
+    case ' ':
+        return 0;
+    default:
+        return -1;
     }
 }
 
@@ -61,72 +48,226 @@ static int calculate_cell_size(int width, int height)
     #undef MAX_HEIGHT
 }
 
-void level_load(Level* ret_level, const char* collectionName, int levelIndex)
+void level_choose_layout(int columnCount, int rowCount, int* ret_cellSize, bool* ret_rotated)
+{
+    int naturalCellSize = calculate_cell_size(columnCount, rowCount);
+    int rotatedCellSize = calculate_cell_size(rowCount, columnCount);
+    *ret_rotated = rotatedCellSize > naturalCellSize;
+    *ret_cellSize = *ret_rotated ? rotatedCellSize : naturalCellSize;
+}
+
+// Allocates a level with the given layout.
+// If the level is rotated, rows and columns of the collection become columns and rows of the level.
+static Level* level_alloc(int columnCount, int rowCount, int cellSize, bool rotated)
+{
+    Level* level = malloc(sizeof(Level));
+    level->cell_size = cellSize;
+    level->level_width = rotated ? rowCount : columnCount;
+    level->level_height = rotated ? columnCount : rowCount;
+    level->is_rotated = rotated;
+    level->player_start_x = level->player_start_y = 0;
+    board_alloc(&level->board, level->level_width, level->level_height);
+    return level;
+}
+
+static void level_add_cell(Level* level, bool rotated, int column, int row, CellType cell)
+{
+    int x = rotated ? row : column;
+    int y = rotated ? column : row;
+
+    board_add_cell(&level->board, x, y, cell);
+    if (cell & CellHasPlayer)
+    {
+        level->player_start_x = x;
+        level->player_start_y = y;
+    }
+}
+
+void level_free(Level* level)
+{
+    board_free(&level->board);
+    free(level);
+}
+
+CellType level_get_cell(const Level* level, int x, int y)
+{
+    CellType cell = board_get_cell(&level->board, x, y);
+    if (x == level->player_start_x && y == level->player_start_y)
+        cell |= CellHasPlayer;
+    return cell;
+}
+
+static Level* level_load_pack(Storage* storage, const char* collectionName, int levelIndex)
+{
+    LevelPackReader* reader = level_pack_reader_alloc(storage, collectionName);
+    if (reader == NULL)
+        return NULL;
+
+    LevelPackEntry entry;
+    Level* level = NULL;
+    if (level_pack_reader_seek_level(reader, levelIndex, &entry))
+    {
+        bool rotated = entry.flags & LEVEL_PACK_ROTATED;
+        level = level_alloc(entry.width, entry.height, entry.cellSize, rotated);
+
+        const CellType planeFlags[LEVEL_PACK_PLANES_COUNT] = {CellHasWall, CellHasTarget, CellHasBox};
+        for (int plane = 0; plane < LEVEL_PACK_PLANES_COUNT; plane++)
+        {
+            for (int row = 0; row < entry.height; row++)
+                for (int column = 0; column < entry.width; column++)
+                    if (level_pack_reader_read_bit(reader))
+                        level_add_cell(level, rotated, column, row, planeFlags[plane]);
+            level_pack_reader_end_plane(reader);
+        }
+
+        level_add_cell(level, rotated, entry.playerX, entry.playerY, CellHasPlayer);
+    }
+
+    level_pack_reader_free(reader);
+    return level;
+}
+
+static Level* level_load_text_layout(const char* collectionName, int levelIndex, bool allowRotation)
 {
     Storage* storage = furi_record_open(RECORD_STORAGE);
-    File* file = storage_file_alloc(storage);
+
+    CollectionIndexEntry entry;
+    if (!collection_index_find_level(storage, collectionName, levelIndex, &entry))
+    {
+        furi_record_close(RECORD_STORAGE);
+        return NULL;
+    }
+
+    // The index holds the layout of the level, so every cell goes straight to its place in the board as its row is read.
+    int cellSize = entry.cellSize;
+    bool rotated = entry.flags & COLLECTION_INDEX_ROTATED;
+    if (!allowRotation && rotated)
+    {
+        cellSize = calculate_cell_size(entry.width, entry.height);
+        rotated = false;
+    }
 
     char filename[256];
-    snprintf(filename, sizeof(filename), "%s/%s.txt", STORAGE_APP_ASSETS_PATH_PREFIX, collectionName);
-    for (int i = 0; filename[i] != '\0'; i++)
-        if (filename[i] >= 'A' && filename[i] <= 'Z')
-            filename[i] += 'a' - 'A';
+    collection_source_path(filename, sizeof(filename), collectionName, "txt");
 
     FURI_LOG_D("GAME", "Opening file: %s", filename);
-    storage_file_open(file, filename, FSAM_READ, FSOM_OPEN_EXISTING);
+    File* file = storage_file_alloc(storage);
+    if (!storage_file_open(file, filename, FSAM_READ, FSOM_OPEN_EXISTING) || !storage_file_seek(file, entry.offset, true))
+    {
+        FURI_LOG_E("GAME", "Failed to open collection: %s", filename);
+        storage_file_free(file);
+        furi_record_close(RECORD_STORAGE);
+        return NULL;
+    }
+
+    Level* level = level_alloc(entry.width, entry.height, cellSize, rotated);
 
     char line[256];
     FileLinesReader* reader = file_lines_reader_alloc(file, sizeof(line));
+    for (int row = 0; row < entry.height && file_lines_reader_readln(reader, line, sizeof(line)); row++)
+    {
+        for (int column = 0; column < entry.width && line[column] != '\0'; column++)
+        {
+            int cell = level_parse_cell(line[column]);
+            if (cell > 0)
+                level_add_cell(level, rotated, column, row, cell);
+        }
+    }
+
+    file_lines_reader_free(reader);
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+    return level;
+}
+
+Level* level_load_text(const char* collectionName, int levelIndex)
+{
+    Level* level = level_load_text_layout(collectionName, levelIndex, false);
+    if (level != NULL)
+        deadlock_find_dead_squares(level);
+    return level;
+}
 
+Level* level_load(const char* collectionName, int levelIndex)
+{
     FURI_LOG_D("GAME", "Loading level %d", levelIndex);
 
-    CellType board[MAX_BOARD_SIZE][MAX_BOARD_SIZE] = {0};
-    int columnCount = 0, rowCount = 0;
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    Level* level = level_load_pack(storage, collectionName, levelIndex);
+    furi_record_close(RECORD_STORAGE);
 
-    char levelStartMark[16];
-    snprintf(levelStartMark, sizeof(levelStartMark), "%d", levelIndex + 1);
+    if (level == NULL)
+        level = level_load_text_layout(collectionName, levelIndex, true);
+    furi_check(level != NULL, "level not found");
 
-    bool levelFound = false;
-    while (!levelFound && file_lines_reader_readln(reader, line, sizeof(line)))
-        if (strncmp(levelStartMark, line, sizeof(levelStartMark)) == 0)
-            levelFound = true;
+    int deadSquaresCount = deadlock_find_dead_squares(level);
+    FURI_LOG_D("GAME", "Level size: %d x %d, %d dead squares", level->level_width, level->level_height, deadSquaresCount);
+    return level;
+}
 
-    furi_check(levelFound, "level not found");
+void level_floor_init(LevelFloor* floor, const Level* level)
+{
+    static const int DIRECTION_DX[4] = {-1, 1, 0, 0};
+    static const int DIRECTION_DY[4] = {0, 0, -1, 1};
+    int width = level->level_width, height = level->level_height, cellsCount = width * height;
 
-    while (file_lines_reader_readln(reader, line, sizeof(line)))
-    {
-        int rowSize = parse_row(line, board[rowCount]);
-        if (rowSize < 0)
-            break;
-        if (rowSize > columnCount)
-            columnCount = rowSize;
-        rowCount += 1;
-        if (rowCount >= MAX_BOARD_SIZE)
-            break;
-    }
+    floor->cellToFloor = malloc(cellsCount * sizeof(int32_t));
+    for (int cell = 0; cell < cellsCount; cell++)
+        floor->cellToFloor[cell] = LEVEL_NO_FLOOR;
 
-    int naturalCellSize = calculate_cell_size(columnCount, rowCount);
-    int rotatedCellSize = calculate_cell_size(rowCount, columnCount);
-    if (naturalCellSize >= rotatedCellSize)
+    // Visited cells hold 0 until every cell is found, and are numbered afterwards, in the order of the cells.
+    uint16_t* queue = malloc(cellsCount * sizeof(uint16_t));
+    int head = 0, tail = 0;
+    int start = level->player_start_y * width + level->player_start_x;
+    queue[tail++] = start;
+    floor->cellToFloor[start] = 0;
+    while (head < tail)
     {
-        ret_level->cell_size = naturalCellSize;
-        ret_level->level_width = columnCount;
-        ret_level->level_height = rowCount;
-        memcpy(ret_level->board, board, sizeof(board));
+        int cell = queue[head++];
+        for (int direction = 0; direction < 4; direction++)
+        {
+            int x = cell % width + DIRECTION_DX[direction], y = cell / width + DIRECTION_DY[direction];
+            if (x < 0 || x >= width || y < 0 || y >= height || board_has_wall(&level->board, x, y))
+                continue;
+            if (floor->cellToFloor[y * width + x] != LEVEL_NO_FLOOR)
+                continue;
+            floor->cellToFloor[y * width + x] = 0;
+            queue[tail++] = y * width + x;
+        }
     }
-    else
+    free(queue);
+
+    floor->count = 0;
+    for (int cell = 0; cell < cellsCount; cell++)
+        if (floor->cellToFloor[cell] != LEVEL_NO_FLOOR)
+            floor->cellToFloor[cell] = floor->count++;
+
+    floor->floorToCell = malloc(floor->count * sizeof(uint16_t));
+    floor->neighbors = malloc(floor->count * sizeof(*floor->neighbors));
+    for (int cell = 0; cell < cellsCount; cell++)
     {
-        ret_level->cell_size = rotatedCellSize;
-        ret_level->level_width = rowCount;
-        ret_level->level_height = columnCount;
-        for (int row = 0; row < rowCount; row++)
-            for (int column = 0; column < columnCount; column++)
-                ret_level->board[column][row] = board[row][column];
+        int index = floor->cellToFloor[cell];
+        if (index == LEVEL_NO_FLOOR)
+            continue;
+        floor->floorToCell[index] = cell;
+        for (int direction = 0; direction < 4; direction++)
+        {
+            int x = cell % width + DIRECTION_DX[direction], y = cell / width + DIRECTION_DY[direction];
+            bool isInside = x >= 0 && x < width && y >= 0 && y < height;
+            floor->neighbors[index][direction] = isInside ? floor->cellToFloor[y * width + x] : LEVEL_NO_FLOOR;
+        }
     }
+}
 
-    FURI_LOG_D("GAME", "Level size: %d x %d", ret_level->level_width, ret_level->level_height);
+void level_floor_free(LevelFloor* floor)
+{
+    free(floor->cellToFloor);
+    free(floor->floorToCell);
+    free(floor->neighbors);
+}
 
-    file_lines_reader_free(reader);
-    storage_file_free(file);
-    furi_record_close(RECORD_STORAGE);
-}
\ No newline at end of file
+size_t level_floor_max_memory(const Level* level)
+{
+    size_t cellsCount = level->level_width * level->level_height;
+    return cellsCount * (sizeof(int32_t) + sizeof(uint16_t) + sizeof(uint16_t) + 4 * sizeof(int32_t));
+}
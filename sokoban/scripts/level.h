@@ -1,20 +1,56 @@
 #pragma once
 
-#define MAX_BOARD_SIZE 50
-
-typedef char CellType;
-enum {
-    CellHasWall = 0x1,
-    CellHasBox = 0x2,
-    CellHasTarget = 0x4,
-    CellHasPlayer = 0x8
-};
+#include "board.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
+// A loaded level. It only holds what never changes while the level is played: its size and layout, its walls and targets,
+// and its starting position. It is shared by every GameState that plays it.
 typedef struct Level
 {
     int level_width, level_height;
     int cell_size;
-    CellType board[MAX_BOARD_SIZE][MAX_BOARD_SIZE];
+    int player_start_x, player_start_y;
+    bool is_rotated; // Whether the rows and columns of the collection are the columns and rows of the level.
+    Board board;
 } Level;
 
-void level_load(Level* ret_level, const char* collectionName, int levelIndex);
\ No newline at end of file
+// Loads a level, from the compiled pack of its collection when available, or from the collection text otherwise.
+// The level is rotated if that makes it fit the screen better. Its dead squares are marked in the board.
+Level* level_load(const char* collectionName, int levelIndex);
+
+// Loads a level from the collection text, as it is written. Returns NULL if the level does not exist.
+Level* level_load_text(const char* collectionName, int levelIndex);
+
+void level_free(Level* level);
+
+// Chooses the cell size and orientation that fit a level of the given size best on the screen. A rotated level has the
+// rows and columns of the collection as its columns and rows.
+void level_choose_layout(int columnCount, int rowCount, int* ret_cellSize, bool* ret_rotated);
+
+// Returns the CellType flags of a character of a level row in the collection text, or -1 if it can not be in a row.
+int level_parse_cell(char ch);
+
+// Returns the contents of a cell in the starting position, as CellType flags, including the player.
+CellType level_get_cell(const Level* level, int x, int y);
+
+#define LEVEL_NO_FLOOR -1
+
+// The floor of a level: the cells the player can walk to from the start with every box taken away, numbered in the order
+// of the cells. Searches over the positions of a level work on floor cells, so they skip the walls and the outside. Boxes
+// off the floor can never be pushed, as the player can not stand next to them.
+typedef struct LevelFloor
+{
+    int count;
+    int32_t* cellToFloor; // For each cell (y * level_width + x), its floor cell, or LEVEL_NO_FLOOR.
+    uint16_t* floorToCell;
+    int32_t (*neighbors)[4]; // Left, right, up and down, or LEVEL_NO_FLOOR.
+} LevelFloor;
+
+// Numbers the floor of a level, with a flood fill from the player start.
+void level_floor_init(LevelFloor* floor, const Level* level);
+void level_floor_free(LevelFloor* floor);
+
+// Returns the heap a LevelFloor of a level takes at most, in bytes, counting the flood fill, as if every cell were floor.
+size_t level_floor_max_memory(const Level* level);
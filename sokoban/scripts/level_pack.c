@@ -0,0 +1,110 @@
+#include "level_pack.h"
+
+#include "collection_index.h"
+#include <furi.h>
+#include <stdlib.h>
+
+#define READ_BUFFER_SIZE 32
+
+typedef struct LevelPackReader
+{
+    File* file;
+    LevelPackHeader header;
+    uint8_t buffer[READ_BUFFER_SIZE];
+    int bufferPos, bufferLen;
+    int bitPos;
+} LevelPackReader;
+
+int level_pack_plane_size(int width, int height)
+{
+    return (width * height + 7) / 8;
+}
+
+static bool is_pack_up_to_date(Storage* storage, const char* collectionName, const LevelPackHeader* header)
+{
+    char sourcePath[256];
+    collection_source_path(sourcePath, sizeof(sourcePath), collectionName, "txt");
+
+    // A pack can be shipped without its source. Otherwise, it must have been compiled from the current text.
+    FileInfo info;
+    if (storage_common_stat(storage, sourcePath, &info) != FSE_OK)
+        return true;
+    return info.size == header->sourceSize;
+}
+
+static bool open_pack(LevelPackReader* reader, const char* packPath)
+{
+    return storage_file_open(reader->file, packPath, FSAM_READ, FSOM_OPEN_EXISTING)
+        && storage_file_read(reader->file, &reader->header, sizeof(LevelPackHeader)) == sizeof(LevelPackHeader)
+        && reader->header.magic == LEVEL_PACK_MAGIC
+        && reader->header.version == LEVEL_PACK_VERSION;
+}
+
+LevelPackReader* level_pack_reader_alloc(Storage* storage, const char* collectionName)
+{
+    char packPath[256];
+    collection_source_path(packPath, sizeof(packPath), collectionName, "pack");
+
+    LevelPackReader* reader = malloc(sizeof(LevelPackReader));
+    reader->file = storage_file_alloc(storage);
+    reader->bufferPos = reader->bufferLen = 0;
+    reader->bitPos = 0;
+
+    if (!open_pack(reader, packPath) || !is_pack_up_to_date(storage, collectionName, &reader->header))
+    {
+        FURI_LOG_D("GAME", "No usable level pack: %s", collectionName);
+        level_pack_reader_free(reader);
+        return NULL;
+    }
+
+    return reader;
+}
+
+void level_pack_reader_free(LevelPackReader* reader)
+{
+    storage_file_free(reader->file);
+    free(reader);
+}
+
+bool level_pack_reader_seek_level(LevelPackReader* reader, int levelIndex, LevelPackEntry* ret_entry)
+{
+    if (levelIndex < 0 || levelIndex >= reader->header.levelsCount)
+        return false;
+
+    storage_file_seek(reader->file, reader->header.directoryOffset + levelIndex * sizeof(LevelPackEntry), true);
+    if (storage_file_read(reader->file, ret_entry, sizeof(LevelPackEntry)) != sizeof(LevelPackEntry))
+        return false;
+
+    storage_file_seek(reader->file, ret_entry->offset, true);
+    reader->bufferPos = reader->bufferLen = 0;
+    reader->bitPos = 0;
+    return true;
+}
+
+bool level_pack_reader_read_bit(LevelPackReader* reader)
+{
+    if (reader->bufferPos >= reader->bufferLen)
+    {
+        reader->bufferPos = 0;
+        reader->bufferLen = storage_file_read(reader->file, reader->buffer, READ_BUFFER_SIZE);
+        if (reader->bufferLen == 0)
+            return false;
+    }
+
+    bool bit = (reader->buffer[reader->bufferPos] >> reader->bitPos) & 1;
+    reader->bitPos += 1;
+    if (reader->bitPos == 8)
+    {
+        reader->bitPos = 0;
+        reader->bufferPos += 1;
+    }
+    return bit;
+}
+
+void level_pack_reader_end_plane(LevelPackReader* reader)
+{
+    if (reader->bitPos == 0)
+        return;
+    reader->bitPos = 0;
+    reader->bufferPos += 1;
+}
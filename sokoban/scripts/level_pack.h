@@ -0,0 +1,58 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <storage/storage.h>
+
+// Binary level packs (<collection>.pack) are written offline by tools/level_compiler, with the collection importer of the
+// host tools (see tools/collection_import.h), and shipped in the app assets next to the collection texts.
+// Layout, little endian:
+//   LevelPackHeader
+//   For each level: the walls, targets and boxes bit planes, in that order. Each plane has width * height bits,
+//   row by row, least significant bit first, and is padded to a whole byte.
+//   LevelPackEntry[levelsCount], at directoryOffset
+// The directory goes last so packs can be written in one pass, without knowing the levels count in advance.
+// The player start position and the layout of the level on screen are kept in the level entry.
+
+#define LEVEL_PACK_MAGIC 0x504B5350 // "PSKP"
+#define LEVEL_PACK_VERSION 2
+#define LEVEL_PACK_PLANES_COUNT 3
+#define LEVEL_PACK_MAX_LEVELS 0xFFFF
+
+// LevelPackEntry flags.
+#define LEVEL_PACK_ROTATED 0x01
+
+typedef struct LevelPackHeader
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t levelsCount;
+    uint32_t sourceSize; // Size of the collection text the pack was compiled from.
+    uint32_t directoryOffset;
+} LevelPackHeader;
+
+typedef struct LevelPackEntry
+{
+    uint32_t offset;
+    uint8_t width, height; // As written in the collection, before any rotation.
+    uint8_t playerX, playerY;
+    uint16_t boxesCount;
+    uint8_t cellSize; // As chosen by level_choose_layout.
+    uint8_t flags;
+} LevelPackEntry;
+
+typedef struct LevelPackReader LevelPackReader;
+
+int level_pack_plane_size(int width, int height);
+
+// Opens the pack of a collection from the app assets. Returns NULL if there is no pack, or if it was compiled from a
+// different collection text.
+LevelPackReader* level_pack_reader_alloc(Storage* storage, const char* collectionName);
+void level_pack_reader_free(LevelPackReader* reader);
+
+// Reads the directory entry of a level and moves the reader to the start of its planes.
+bool level_pack_reader_seek_level(LevelPackReader* reader, int levelIndex, LevelPackEntry* ret_entry);
+
+// Reads the planes of the current level one bit at a time.
+bool level_pack_reader_read_bit(LevelPackReader* reader);
+void level_pack_reader_end_plane(LevelPackReader* reader);
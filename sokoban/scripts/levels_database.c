@@ -1,156 +1,744 @@
 #include "levels_database.h"
 
+#include <stddef.h>
 #include <stdio.h>
 #include <storage/storage.h>
 #include "wave/files/file_lines_reader.h"
 
-static const char* DATABASE_PATH = APP_ASSETS_PATH("database.txt");
-static const char* SAVE_DATA_PATH = APP_DATA_PATH("sokoban.save");
+static const char* DATABASE_SOURCE_PATH = APP_ASSETS_PATH("database.txt");
+static const char* DATABASE_PATH = APP_ASSETS_PATH("database.bin");
+static const char* DATABASE_CACHE_PATH = APP_DATA_PATH("database.bin");
+static const char* SAVE_DATA_PATH = APP_DATA_PATH("sokoban.sav");
+static const char* SAVE_TEMP_PATH = APP_DATA_PATH("sokoban.sav.tmp");
+static const char* PROGRESS_LOG_PATH = APP_DATA_PATH("sokoban.wal");
+static const char* TEXT_SAVE_DATA_PATH = APP_DATA_PATH("sokoban.save");
 
-static LevelsDatabase* levels_database_alloc(int collectionsCount)
+#define PROGRESS_MAGIC 0x5250534B // "KSPR"
+#define PROGRESS_VERSION 1
+// Records are read and written this many at a time, instead of one call per level.
+#define PROGRESS_BATCH_RECORDS 64
+
+typedef struct ProgressHeader
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t recordSize;
+    uint32_t recordsCount;
+    uint16_t collectionsCount;
+    uint16_t reserved;
+    uint32_t databaseSize; // Of the database.txt the summaries were counted against.
+    uint32_t checksum;     // Of the fields above.
+} ProgressHeader;
+
+typedef struct ProgressSummary
+{
+    uint16_t completedCount;
+    uint16_t starredCount;
+} ProgressSummary;
+
+typedef struct ProgressRecord
+{
+    uint16_t playerBest;
+    uint16_t reserved;
+} ProgressRecord;
+
+// New best scores are appended to a small log, synced before the save returns, and later copied into their records by
+// levels_database_compact_progress. A full save goes to a temporary file that is renamed over the progress file, so at
+// any moment one complete progress file exists, and a power loss costs at most the score being written.
+
+static uint32_t checksum(const void* data, size_t size)
+{
+    uint32_t hash = 2166136261u;
+    const uint8_t* bytes = (const uint8_t*)data;
+    for (size_t i = 0; i < size; i++)
+        hash = (hash ^ bytes[i]) * 16777619u;
+    return hash;
+}
+
+static uint16_t checksum16(const void* data, size_t size)
+{
+    uint32_t hash = checksum(data, size);
+    return (uint16_t)(hash ^ (hash >> 16));
+}
+
+static bool is_starred(int worldBest, int playerBest)
+{
+    return playerBest != 0 && playerBest <= worldBest;
+}
+
+static uint32_t database_levels_offset(const LevelsDatabase* database)
+{
+    return sizeof(LevelsDatabaseHeader) + database->collectionsCount * sizeof(LevelsDatabaseEntry);
+}
+
+static uint32_t progress_records_offset(const LevelsDatabase* database)
+{
+    return sizeof(ProgressHeader) + database->collectionsCount * sizeof(ProgressSummary);
+}
+
+static int levels_database_levels_count(const LevelsDatabase* database)
+{
+    if (database->collectionsCount == 0)
+        return 0;
+    LevelsCollection* last = &database->collections[database->collectionsCount - 1];
+    return last->firstLevel + last->levelsCount;
+}
+
+static int levels_database_collection_of(const LevelsDatabase* database, int level)
+{
+    for (int collectionIndex = 0; collectionIndex < database->collectionsCount; collectionIndex++)
+        if (level < database->collections[collectionIndex].firstLevel + database->collections[collectionIndex].levelsCount)
+            return collectionIndex;
+    return -1;
+}
+
+bool levels_database_compile(Storage* storage, const char* sourcePath, const char* outputPath)
 {
-    LevelsDatabase* levelsMetadata = malloc(sizeof(LevelsDatabase));
-    levelsMetadata->collectionsCount = collectionsCount;
-    levelsMetadata->collections = malloc(collectionsCount * sizeof(LevelsCollection));
-    return levelsMetadata;
+    FileInfo sourceInfo;
+    if (storage_common_stat(storage, sourcePath, &sourceInfo) != FSE_OK)
+        return false;
+
+    File* source = storage_file_alloc(storage);
+    File* output = storage_file_alloc(storage);
+    if (!storage_file_open(source, sourcePath, FSAM_READ, FSOM_OPEN_EXISTING) ||
+        !storage_file_open(output, outputPath, FSAM_WRITE, FSOM_CREATE_ALWAYS))
+    {
+        storage_file_free(source);
+        storage_file_free(output);
+        return false;
+    }
+
+    char line[256];
+    FileLinesReader* reader = file_lines_reader_alloc(source, sizeof(line));
+
+    // Every line is checked, so a truncated database.txt fails to compile instead of compiling stale lines.
+    line[0] = '\0';
+    bool success = file_lines_reader_readln(reader, line, sizeof(line)) && strcmp(line, "1") == 0;
+    if (!success)
+        FURI_LOG_E("GAME", "Unsupported levels metadata version: %s", line);
+
+    success = success && file_lines_reader_readln(reader, line, sizeof(line));
+    int collectionsCount = success ? atoi(line) : 0;
+
+    LevelsDatabaseHeader header = {
+        .magic = LEVELS_DATABASE_MAGIC,
+        .version = LEVELS_DATABASE_VERSION,
+        .collectionsCount = collectionsCount,
+        .sourceSize = sourceInfo.size,
+    };
+    size_t expectedSize = sizeof(header) + collectionsCount * sizeof(LevelsDatabaseEntry);
+    size_t writtenSize = storage_file_write(output, &header, sizeof(header));
+
+    // The entries are written with placeholders first, and rewritten once the levels counts are read.
+    LevelsDatabaseEntry* entries = calloc(collectionsCount, sizeof(LevelsDatabaseEntry));
+    writtenSize += storage_file_write(output, entries, collectionsCount * sizeof(LevelsDatabaseEntry));
+
+    uint16_t worldBests[PROGRESS_BATCH_RECORDS];
+    int bufferedCount = 0;
+    uint32_t firstLevel = 0;
+    for (int collectionIndex = 0; collectionIndex < collectionsCount && success; collectionIndex++)
+    {
+        LevelsDatabaseEntry* entry = &entries[collectionIndex];
+        success = file_lines_reader_readln(reader, line, sizeof(line));
+        snprintf(entry->name, sizeof(entry->name), "%s", line);
+
+        success = success && file_lines_reader_readln(reader, line, sizeof(line));
+        if (!success)
+            break;
+        entry->firstLevel = firstLevel;
+        entry->levelsCount = atoi(line);
+        firstLevel += entry->levelsCount;
+        FURI_LOG_D("GAME", "Collection %s: %lu levels", entry->name, (unsigned long)entry->levelsCount);
+
+        for (uint32_t levelIndex = 0; levelIndex < entry->levelsCount && success; levelIndex++)
+        {
+            success = file_lines_reader_readln(reader, line, sizeof(line));
+            worldBests[bufferedCount++] = atoi(line);
+            if (bufferedCount == PROGRESS_BATCH_RECORDS)
+            {
+                writtenSize += storage_file_write(output, worldBests, sizeof(worldBests));
+                bufferedCount = 0;
+            }
+        }
+    }
+    writtenSize += storage_file_write(output, worldBests, bufferedCount * sizeof(uint16_t));
+    expectedSize += firstLevel * sizeof(uint16_t);
+
+    storage_file_seek(output, sizeof(header), true);
+    storage_file_write(output, entries, collectionsCount * sizeof(LevelsDatabaseEntry));
+    success = success && writtenSize == expectedSize;
+
+    free(entries);
+    file_lines_reader_free(reader);
+    storage_file_free(source);
+    storage_file_free(output);
+    if (!success)
+        storage_common_remove(storage, outputPath);
+    return success;
 }
 
-void levels_database_free(LevelsDatabase* levelsMetadata)
+// Checks that a compiled database exists, and was compiled from the current database.txt, if there is one.
+static bool levels_database_is_current(Storage* storage, const char* path, const FileInfo* sourceInfo)
 {
-    for (int i = 0; i < levelsMetadata->collectionsCount; i++)
-        free(levelsMetadata->collections[i].levels);
-    free(levelsMetadata->collections);
-    free(levelsMetadata);
+    File* file = storage_file_alloc(storage);
+    LevelsDatabaseHeader header;
+    bool current = storage_file_open(file, path, FSAM_READ, FSOM_OPEN_EXISTING) &&
+                   storage_file_read(file, &header, sizeof(header)) == sizeof(header) && header.magic == LEVELS_DATABASE_MAGIC &&
+                   header.version == LEVELS_DATABASE_VERSION && (sourceInfo == NULL || header.sourceSize == sourceInfo->size);
+    storage_file_free(file);
+    return current;
 }
 
 LevelsDatabase* levels_database_load()
 {
     Storage* storage = furi_record_open(RECORD_STORAGE);
+
+    FileInfo sourceInfo;
+    const FileInfo* source = storage_common_stat(storage, DATABASE_SOURCE_PATH, &sourceInfo) == FSE_OK ? &sourceInfo : NULL;
+    const char* path = DATABASE_PATH;
+    if (!levels_database_is_current(storage, path, source))
+    {
+        path = DATABASE_CACHE_PATH;
+        if (!levels_database_is_current(storage, path, source))
+        {
+            FURI_LOG_I("GAME", "Compiling levels metadata into %s", path);
+            if (source == NULL || !levels_database_compile(storage, DATABASE_SOURCE_PATH, path))
+            {
+                FURI_LOG_E("GAME", "Failed to open levels metadata file: %s", DATABASE_SOURCE_PATH);
+                furi_crash("Failed to open levels metadata file");
+            }
+        }
+    }
+
     File* file = storage_file_alloc(storage);
-    if (!storage_file_open(file, DATABASE_PATH, FSAM_READ, FSOM_OPEN_EXISTING))
+    LevelsDatabaseHeader header;
+    storage_file_open(file, path, FSAM_READ, FSOM_OPEN_EXISTING);
+    storage_file_read(file, &header, sizeof(header));
+
+    LevelsDatabase* database = malloc(sizeof(LevelsDatabase));
+    database->collectionsCount = header.collectionsCount;
+    database->collections = malloc(header.collectionsCount * sizeof(LevelsCollection));
+    strncpy(database->path, path, sizeof(database->path));
+    database->databaseSize = header.sourceSize;
+    for (int collectionIndex = 0; collectionIndex < database->collectionsCount; collectionIndex++)
     {
-        FURI_LOG_E("GAME", "Failed to open levels metadata file: %s", DATABASE_PATH);
-        furi_crash("Failed to open levels metadata file");
+        LevelsDatabaseEntry entry;
+        storage_file_read(file, &entry, sizeof(entry));
+        LevelsCollection* collection = &database->collections[collectionIndex];
+        memcpy(collection->name, entry.name, sizeof(collection->name));
+        collection->name[sizeof(collection->name) - 1] = '\0';
+        collection->levelsCount = entry.levelsCount;
+        collection->firstLevel = entry.firstLevel;
+        collection->completedCount = collection->starredCount = 0;
     }
 
-    char line[256];
-    FileLinesReader* reader = file_lines_reader_alloc(file, sizeof(line));
+    for (int pageIndex = 0; pageIndex < LEVELS_DATABASE_PAGES_COUNT; pageIndex++)
+        database->pages[pageIndex].firstLevel = -1;
+    database->pageUses = 0;
+    database->progressRecordsCount = 0;
+    database->progressLogCount = 0;
+
+    FURI_LOG_D("GAME", "Loaded %d collections metadata from %s.", database->collectionsCount, path);
 
-    file_lines_reader_readln(reader, line, sizeof(line));
-    if (strcmp(line, "1") != 0)
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+    return database;
+}
+
+void levels_database_free(LevelsDatabase* database)
+{
+    free(database->collections);
+    free(database);
+}
+
+static void levels_database_read_page(Storage* storage, LevelsDatabase* database, LevelsPage* page)
+{
+    memset(page->levels, 0, sizeof(page->levels));
+    File* file = storage_file_alloc(storage);
+
+    uint16_t worldBests[LEVELS_DATABASE_PAGE_LEVELS];
+    if (storage_file_open(file, database->path, FSAM_READ, FSOM_OPEN_EXISTING) &&
+        storage_file_seek(file, database_levels_offset(database) + page->firstLevel * sizeof(uint16_t), true))
     {
-        FURI_LOG_E("GAME", "Unsupported levels metadata version: %s", line);
-        furi_crash("Unsupported level metadata version");
+        int readCount = storage_file_read(file, worldBests, page->levelsCount * sizeof(uint16_t)) / sizeof(uint16_t);
+        for (int i = 0; i < readCount; i++)
+            page->levels[i].worldBest = worldBests[i];
     }
+    storage_file_close(file);
 
-    file_lines_reader_readln(reader, line, sizeof(line));
-    FURI_LOG_D("GAME", "Collections count: %s", line);
-    int collectionsCount = atoi(line);
+    int recordsCount = MIN(page->levelsCount, database->progressRecordsCount - page->firstLevel);
+    ProgressRecord records[LEVELS_DATABASE_PAGE_LEVELS];
+    if (recordsCount > 0 && storage_file_open(file, SAVE_DATA_PATH, FSAM_READ, FSOM_OPEN_EXISTING) &&
+        storage_file_seek(file, progress_records_offset(database) + page->firstLevel * sizeof(ProgressRecord), true))
+    {
+        int readCount = storage_file_read(file, records, recordsCount * sizeof(ProgressRecord)) / sizeof(ProgressRecord);
+        for (int i = 0; i < readCount; i++)
+            page->levels[i].playerBest = records[i].playerBest;
+    }
+    storage_file_free(file);
 
-    LevelsDatabase* levelsMetadata = levels_database_alloc(collectionsCount);
+    // Scores still in the log are newer than their records.
+    for (int entryIndex = 0; entryIndex < database->progressLogCount; entryIndex++)
+    {
+        const ProgressLogEntry* entry = &database->progressLog[entryIndex];
+        int offset = (int)entry->recordIndex - page->firstLevel;
+        if (offset >= 0 && offset < page->levelsCount)
+            page->levels[offset].playerBest = entry->playerBest;
+    }
+}
 
-    for (int collectionIndex = 0; collectionIndex < collectionsCount; collectionIndex++)
+// Returns the cached page holding a level, reading it over the least recently used page if needed.
+static LevelsPage* levels_database_page(LevelsDatabase* database, int level)
+{
+    int firstLevel = level - level % LEVELS_DATABASE_PAGE_LEVELS;
+    LevelsPage* page = &database->pages[0];
+    for (int pageIndex = 0; pageIndex < LEVELS_DATABASE_PAGES_COUNT; pageIndex++)
     {
-        LevelsCollection collection;
+        LevelsPage* candidate = &database->pages[pageIndex];
+        if (candidate->firstLevel == firstLevel)
+        {
+            candidate->lastUse = ++database->pageUses;
+            return candidate;
+        }
+        if (candidate->firstLevel < 0 || candidate->lastUse < page->lastUse)
+            page = candidate;
+    }
+
+    page->firstLevel = firstLevel;
+    page->levelsCount = MIN(LEVELS_DATABASE_PAGE_LEVELS, levels_database_levels_count(database) - firstLevel);
+    page->lastUse = ++database->pageUses;
+
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    levels_database_read_page(storage, database, page);
+    furi_record_close(RECORD_STORAGE);
+    FURI_LOG_T("GAME", "Read levels page at %d", firstLevel);
+    return page;
+}
+
+LevelItem levels_database_get_level(LevelsDatabase* database, int collectionIndex, int levelIndex)
+{
+    int level = database->collections[collectionIndex].firstLevel + levelIndex;
+    LevelsPage* page = levels_database_page(database, level);
+    return page->levels[level - page->firstLevel];
+}
+
+// Where a full save reads the current progress from: the progress file, or the text save of earlier versions of the game.
+// Levels missing from it have no progress.
+typedef struct ProgressSource
+{
+    File* file;
+    FileLinesReader* textReader;
+    uint32_t recordsLeft;
+} ProgressSource;
 
-        file_lines_reader_readln(reader, line, sizeof(line));
-        strncpy(collection.name, line, sizeof(collection.name));
-        FURI_LOG_D("GAME", "Collection name: %s", collection.name);
+// Returns the version of a progress file header, or 0 if it is not one.
+static int progress_header_version(const uint8_t* bytes, size_t size)
+{
+    const ProgressHeader* header = (const ProgressHeader*)bytes;
+    if (size >= sizeof(ProgressHeader) && header->magic == PROGRESS_MAGIC && header->version >= PROGRESS_VERSION &&
+        header->checksum == checksum(header, offsetof(ProgressHeader, checksum)))
+        return header->version;
+    return 0;
+}
 
-        file_lines_reader_readln(reader, line, sizeof(line));
-        FURI_LOG_D("GAME", "Levels count: %s", line);
-        int levelsCount = atoi(line);
-        collection.levelsCount = levelsCount;
-        collection.levels = malloc(levelsCount * sizeof(LevelItem));
+static void progress_source_open(Storage* storage, ProgressSource* source)
+{
+    source->file = storage_file_alloc(storage);
+    source->textReader = NULL;
+    source->recordsLeft = 0;
 
-        for (int levelInCollectionIndex = 0; levelInCollectionIndex < levelsCount; levelInCollectionIndex++)
+    uint8_t bytes[sizeof(ProgressHeader)];
+    if (storage_file_open(source->file, SAVE_DATA_PATH, FSAM_READ, FSOM_OPEN_EXISTING))
+    {
+        int version = progress_header_version(bytes, storage_file_read(source->file, bytes, sizeof(bytes)));
+        const ProgressHeader* header = (const ProgressHeader*)bytes;
+        if (version > PROGRESS_VERSION || (version != 0 && header->recordSize != sizeof(ProgressRecord)))
         {
-            LevelItem levelItem;
-            file_lines_reader_readln(reader, line, sizeof(line));
-            levelItem.worldBest = atoi(line);
-            levelItem.playerBest = 0;
+            FURI_LOG_E("GAME", "Unsupported player progress version: %d", version);
+            furi_crash("Unsupported player progress version");
+        }
 
-            collection.levels[levelInCollectionIndex] = levelItem;
+        if (version == PROGRESS_VERSION)
+        {
+            source->recordsLeft = header->recordsCount;
+            storage_file_seek(source->file, sizeof(ProgressHeader) + header->collectionsCount * sizeof(ProgressSummary), true);
+            return;
         }
+        FURI_LOG_E("GAME", "Player progress header is corrupted: %s", SAVE_DATA_PATH);
+        storage_file_close(source->file);
+    }
 
-        levelsMetadata->collections[collectionIndex] = collection;
-        FURI_LOG_D("GAME", "Loaded %d levels metadata for collection %d.", levelsCount, collectionIndex);
+    if (storage_file_open(source->file, TEXT_SAVE_DATA_PATH, FSAM_READ, FSOM_OPEN_EXISTING))
+    {
+        char line[32];
+        source->textReader = file_lines_reader_alloc(source->file, sizeof(line));
+        file_lines_reader_readln(source->textReader, line, sizeof(line));
+        if (strcmp(line, "1") != 0)
+        {
+            FURI_LOG_E("GAME", "Unsupported player progress version: %s", line);
+            furi_crash("Unsupported player progress version");
+        }
+        source->recordsLeft = UINT32_MAX;
     }
+}
 
-    FURI_LOG_D("GAME", "Loaded %d collections metadata.", collectionsCount);
+static void progress_source_read(ProgressSource* source, uint16_t* playerBests, int count)
+{
+    memset(playerBests, 0, count * sizeof(uint16_t));
+    count = MIN((uint32_t)count, source->recordsLeft);
 
-    file_lines_reader_free(reader);
-    storage_file_free(file);
-    furi_record_close(RECORD_STORAGE);
+    if (source->textReader != NULL)
+    {
+        char line[32];
+        for (int i = 0; i < count && file_lines_reader_readln(source->textReader, line, sizeof(line)); i++)
+            playerBests[i] = atoi(line);
+    }
+    else if (count > 0)
+    {
+        ProgressRecord records[PROGRESS_BATCH_RECORDS];
+        int readCount = storage_file_read(source->file, records, count * sizeof(ProgressRecord)) / sizeof(ProgressRecord);
+        for (int i = 0; i < readCount; i++)
+            playerBests[i] = records[i].playerBest;
+    }
+    source->recordsLeft -= count;
+}
 
-    return levelsMetadata;
+static void progress_source_close(ProgressSource* source)
+{
+    if (source->textReader != NULL)
+        file_lines_reader_free(source->textReader);
+    storage_file_free(source->file);
 }
 
-void levels_database_save_player_progress(LevelsDatabase* database)
+// Writes the whole progress file next to the current one, counting the summaries again, and swaps it in once it is on
+// storage. The scores come from the current progress, updated with the log and the cached pages.
+static bool levels_database_write_progress(Storage* storage, LevelsDatabase* database)
 {
-    Storage* storage = furi_record_open(RECORD_STORAGE);
     File* file = storage_file_alloc(storage);
-    if (!storage_file_open(file, SAVE_DATA_PATH, FSAM_WRITE, FSOM_CREATE_ALWAYS))
+    if (!storage_file_open(file, SAVE_TEMP_PATH, FSAM_WRITE, FSOM_CREATE_ALWAYS))
     {
-        FURI_LOG_E("GAME", "Failed to open file to save progress: %s", SAVE_DATA_PATH);
-        furi_crash("Failed to open file to save progress");
+        FURI_LOG_E("GAME", "Failed to open file to save progress: %s", SAVE_TEMP_PATH);
+        storage_file_free(file);
+        return false;
     }
 
-    const char versionLine[] = "1\n";
-    storage_file_write(file, versionLine, sizeof(versionLine) - 1);
+    ProgressSource source;
+    progress_source_open(storage, &source);
+    bool fromText = source.textReader != NULL;
+    File* worldBestsFile = storage_file_alloc(storage);
+    storage_file_open(worldBestsFile, database->path, FSAM_READ, FSOM_OPEN_EXISTING);
+    storage_file_seek(worldBestsFile, database_levels_offset(database), true);
 
-    for (int collectionIndex = 0; collectionIndex < database->collectionsCount; collectionIndex++)
+    int levelsCount = levels_database_levels_count(database);
+    ProgressHeader header = {
+        .magic = PROGRESS_MAGIC,
+        .version = PROGRESS_VERSION,
+        .recordSize = sizeof(ProgressRecord),
+        .recordsCount = levelsCount,
+        .collectionsCount = database->collectionsCount,
+        .reserved = 0,
+        .databaseSize = database->databaseSize,
+    };
+    header.checksum = checksum(&header, offsetof(ProgressHeader, checksum));
+    size_t expectedSize = progress_records_offset(database) + levelsCount * sizeof(ProgressRecord);
+    size_t writtenSize = storage_file_write(file, &header, sizeof(header));
+
+    // The summaries are written once counted, over placeholders.
+    ProgressSummary* summaries = calloc(database->collectionsCount, sizeof(ProgressSummary));
+    writtenSize += storage_file_write(file, summaries, database->collectionsCount * sizeof(ProgressSummary));
+
+    int collectionIndex = 0;
+    for (int firstLevel = 0; firstLevel < levelsCount; firstLevel += PROGRESS_BATCH_RECORDS)
     {
-        LevelsCollection collection = database->collections[collectionIndex];
-        for (int levelInCollectionIndex = 0; levelInCollectionIndex < collection.levelsCount; levelInCollectionIndex++)
+        int count = MIN(PROGRESS_BATCH_RECORDS, levelsCount - firstLevel);
+        uint16_t playerBests[PROGRESS_BATCH_RECORDS], worldBests[PROGRESS_BATCH_RECORDS];
+        progress_source_read(&source, playerBests, count);
+        memset(worldBests, 0, sizeof(worldBests));
+        storage_file_read(worldBestsFile, worldBests, count * sizeof(uint16_t));
+
+        for (int entryIndex = 0; entryIndex < database->progressLogCount; entryIndex++)
+        {
+            int offset = (int)database->progressLog[entryIndex].recordIndex - firstLevel;
+            if (offset >= 0 && offset < count)
+                playerBests[offset] = database->progressLog[entryIndex].playerBest;
+        }
+        for (int pageIndex = 0; pageIndex < LEVELS_DATABASE_PAGES_COUNT; pageIndex++)
         {
-            LevelItem levelItem = collection.levels[levelInCollectionIndex];
-            char line[32];
-            int length = snprintf(line, sizeof(line), "%d\n", levelItem.playerBest);
-            storage_file_write(file, line, length);
+            LevelsPage* page = &database->pages[pageIndex];
+            for (int i = 0; page->firstLevel >= 0 && i < page->levelsCount; i++)
+            {
+                int offset = page->firstLevel + i - firstLevel;
+                if (offset >= 0 && offset < count)
+                    playerBests[offset] = page->levels[i].playerBest;
+            }
         }
+
+        ProgressRecord records[PROGRESS_BATCH_RECORDS];
+        for (int i = 0; i < count; i++)
+        {
+            LevelsCollection* collection = &database->collections[collectionIndex];
+            while (firstLevel + i >= collection->firstLevel + collection->levelsCount)
+                collection = &database->collections[++collectionIndex];
+            summaries[collectionIndex].completedCount += playerBests[i] != 0;
+            summaries[collectionIndex].starredCount += is_starred(worldBests[i], playerBests[i]);
+            records[i].playerBest = playerBests[i];
+            records[i].reserved = 0;
+        }
+        writtenSize += storage_file_write(file, records, count * sizeof(ProgressRecord));
     }
 
+    storage_file_seek(file, sizeof(header), true);
+    storage_file_write(file, summaries, database->collectionsCount * sizeof(ProgressSummary));
+    bool saved = writtenSize == expectedSize && storage_file_sync(file);
     storage_file_free(file);
+    storage_file_free(worldBestsFile);
+    progress_source_close(&source);
+
+    saved = saved && storage_common_rename(storage, SAVE_TEMP_PATH, SAVE_DATA_PATH) == FSE_OK;
+    if (saved)
+    {
+        for (int i = 0; i < database->collectionsCount; i++)
+        {
+            database->collections[i].completedCount = summaries[i].completedCount;
+            database->collections[i].starredCount = summaries[i].starredCount;
+        }
+        database->progressRecordsCount = levelsCount;
+
+        // Everything in the log, or in the text save, is in the new file now.
+        storage_common_remove(storage, PROGRESS_LOG_PATH);
+        database->progressLogCount = 0;
+        if (fromText)
+            storage_common_remove(storage, TEXT_SAVE_DATA_PATH);
+    }
+    else
+        FURI_LOG_E("GAME", "Failed to save progress: %s", SAVE_DATA_PATH);
+
+    free(summaries);
+    return saved;
+}
+
+void levels_database_save_player_progress(LevelsDatabase* database)
+{
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    levels_database_write_progress(storage, database);
     furi_record_close(RECORD_STORAGE);
 }
 
-void levels_database_load_player_progress(LevelsDatabase* database)
+// Appends a best score to the log, and returns once it is on storage.
+static bool levels_database_append_log(Storage* storage, LevelsDatabase* database, int collectionIndex, int recordIndex, uint16_t playerBest)
+{
+    ProgressLogEntry entry = {
+        .recordIndex = recordIndex,
+        .playerBest = playerBest,
+        .completedCount = database->collections[collectionIndex].completedCount,
+        .starredCount = database->collections[collectionIndex].starredCount,
+    };
+    entry.checksum = checksum16(&entry, offsetof(ProgressLogEntry, checksum));
+
+    File* file = storage_file_alloc(storage);
+    bool saved = storage_file_open(file, PROGRESS_LOG_PATH, FSAM_WRITE, FSOM_OPEN_APPEND) &&
+                 storage_file_write(file, &entry, sizeof(entry)) == sizeof(entry) && storage_file_sync(file);
+    storage_file_free(file);
+
+    if (saved)
+        database->progressLog[database->progressLogCount++] = entry;
+    return saved;
+}
+
+void levels_database_set_player_best(LevelsDatabase* database, int collectionIndex, int levelIndex, unsigned short playerBest)
+{
+    LevelsCollection* collection = &database->collections[collectionIndex];
+    int recordIndex = collection->firstLevel + levelIndex;
+    LevelsPage* page = levels_database_page(database, recordIndex);
+    LevelItem* levelItem = &page->levels[recordIndex - page->firstLevel];
+
+    collection->completedCount += (playerBest != 0) - (levelItem->playerBest != 0);
+    collection->starredCount += is_starred(levelItem->worldBest, playerBest) - is_starred(levelItem->worldBest, levelItem->playerBest);
+    levelItem->playerBest = playerBest;
+
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    if (recordIndex >= database->progressRecordsCount)
+        levels_database_write_progress(storage, database);
+    else if (database->progressLogCount == PROGRESS_LOG_MAX_ENTRIES ||
+             !levels_database_append_log(storage, database, collectionIndex, recordIndex, playerBest))
+    {
+        FURI_LOG_W("GAME", "Failed to log progress, rewriting: %s", SAVE_DATA_PATH);
+        levels_database_write_progress(storage, database);
+    }
+    furi_record_close(RECORD_STORAGE);
+
+    if (database->progressLogCount == PROGRESS_LOG_MAX_ENTRIES)
+        levels_database_compact_progress(database);
+}
+
+bool levels_database_has_pending_progress(const LevelsDatabase* database)
+{
+    return database->progressLogCount > 0;
+}
+
+void levels_database_compact_progress(LevelsDatabase* database)
 {
+    if (database->progressLogCount == 0)
+        return;
+
     Storage* storage = furi_record_open(RECORD_STORAGE);
     File* file = storage_file_alloc(storage);
-    if (!storage_file_open(file, SAVE_DATA_PATH, FSAM_READ, FSOM_OPEN_EXISTING))
+    bool compacted = storage_file_open(file, SAVE_DATA_PATH, FSAM_WRITE, FSOM_OPEN_EXISTING);
+
+    // Entries hold absolute values, so a compaction cut short is simply done again from the same log.
+    for (int entryIndex = 0; entryIndex < database->progressLogCount && compacted; entryIndex++)
+    {
+        const ProgressLogEntry* entry = &database->progressLog[entryIndex];
+        ProgressRecord record = {.playerBest = entry->playerBest, .reserved = 0};
+        ProgressSummary summary = {.completedCount = entry->completedCount, .starredCount = entry->starredCount};
+        int collectionIndex = levels_database_collection_of(database, entry->recordIndex);
+        compacted = storage_file_seek(file, progress_records_offset(database) + entry->recordIndex * sizeof(ProgressRecord), true) &&
+                    storage_file_write(file, &record, sizeof(record)) == sizeof(record) &&
+                    storage_file_seek(file, sizeof(ProgressHeader) + collectionIndex * sizeof(ProgressSummary), true) &&
+                    storage_file_write(file, &summary, sizeof(summary)) == sizeof(summary);
+    }
+    compacted = compacted && storage_file_sync(file);
+    storage_file_free(file);
+
+    if (compacted)
+        compacted = storage_common_remove(storage, PROGRESS_LOG_PATH) == FSE_OK;
+    else
+        compacted = levels_database_write_progress(storage, database);
+    if (compacted)
+        database->progressLogCount = 0;
+    FURI_LOG_D("GAME", "Progress log compaction %s", compacted ? "done" : "failed");
+
+    furi_record_close(RECORD_STORAGE);
+}
+
+// Applies the best scores logged since the last compaction. The log never holds more than PROGRESS_LOG_MAX_ENTRIES, so
+// this takes the same time whatever the size of the database. A torn last entry is cut off, so later appends are readable.
+static void levels_database_replay_log(Storage* storage, LevelsDatabase* database)
+{
+    File* file = storage_file_alloc(storage);
+    if (!storage_file_open(file, PROGRESS_LOG_PATH, FSAM_READ_WRITE, FSOM_OPEN_EXISTING))
     {
-        FURI_LOG_D("GAME", "Could not open file to load progress: %s", SAVE_DATA_PATH);
         storage_file_free(file);
-        furi_record_close(RECORD_STORAGE);
         return;
     }
 
-    FileLinesReader* reader = file_lines_reader_alloc(file, 32);
+    ProgressLogEntry* entries = database->progressLog;
+    int entriesCount = storage_file_read(file, entries, sizeof(database->progressLog)) / sizeof(ProgressLogEntry);
+    int validCount = 0;
+    while (validCount < entriesCount)
+    {
+        ProgressLogEntry* entry = &entries[validCount];
+        if (entry->checksum != checksum16(entry, offsetof(ProgressLogEntry, checksum)) || (int)entry->recordIndex >= database->progressRecordsCount)
+            break;
+        LevelsCollection* collection = &database->collections[levels_database_collection_of(database, entry->recordIndex)];
+        collection->completedCount = entry->completedCount;
+        collection->starredCount = entry->starredCount;
+        validCount += 1;
+    }
 
-    char line[32];
-    file_lines_reader_readln(reader, line, sizeof(line));
-    if (strcmp(line, "1") != 0)
+    if (validCount * sizeof(ProgressLogEntry) < storage_file_size(file))
     {
-        FURI_LOG_E("GAME", "Unsupported player progress version: %s", line);
-        furi_crash("Unsupported player progress version");
+        FURI_LOG_W("GAME", "Progress log truncated to %d entries", validCount);
+        storage_file_seek(file, validCount * sizeof(ProgressLogEntry), true);
+        storage_file_truncate(file);
     }
+    database->progressLogCount = validCount;
+    FURI_LOG_D("GAME", "Replayed %d progress log entries", validCount);
 
-    for (int collectionIndex = 0; collectionIndex < database->collectionsCount; collectionIndex++)
+    storage_file_free(file);
+}
+
+// Reads the log of a current progress file counted against a different database, without its summaries, which are
+// counted again when the file is rewritten. Entries past the records of that file are dropped.
+static void levels_database_read_log(Storage* storage, LevelsDatabase* database, uint32_t recordsCount)
+{
+    File* file = storage_file_alloc(storage);
+    ProgressLogEntry entry;
+    if (storage_file_open(file, PROGRESS_LOG_PATH, FSAM_READ, FSOM_OPEN_EXISTING))
     {
-        LevelsCollection* collection = &database->collections[collectionIndex];
-        for (int levelInCollectionIndex = 0; levelInCollectionIndex < collection->levelsCount; levelInCollectionIndex++)
+        while (database->progressLogCount < PROGRESS_LOG_MAX_ENTRIES && storage_file_read(file, &entry, sizeof(entry)) == sizeof(entry) &&
+               entry.checksum == checksum16(&entry, offsetof(ProgressLogEntry, checksum)))
         {
-            LevelItem levelItem = collection->levels[levelInCollectionIndex];
-            file_lines_reader_readln(reader, line, 32);
-            levelItem.playerBest = atoi(line);
+            if (entry.recordIndex < recordsCount)
+                database->progressLog[database->progressLogCount++] = entry;
+        }
+    }
+    storage_file_free(file);
+}
 
-            collection->levels[levelInCollectionIndex] = levelItem;
+// Finishes a full save cut short between writing the new file and swapping it in.
+static void levels_database_recover_progress(Storage* storage)
+{
+    if (!storage_file_exists(storage, SAVE_TEMP_PATH))
+        return;
+
+    // The new file is only swapped in once complete, so it replaces the current one only if that one is gone.
+    FileInfo info;
+    if (!storage_file_exists(storage, SAVE_DATA_PATH) && storage_common_stat(storage, SAVE_TEMP_PATH, &info) == FSE_OK)
+    {
+        File* file = storage_file_alloc(storage);
+        ProgressHeader header;
+        bool complete = storage_file_open(file, SAVE_TEMP_PATH, FSAM_READ, FSOM_OPEN_EXISTING) &&
+                        progress_header_version((uint8_t*)&header, storage_file_read(file, &header, sizeof(header))) == PROGRESS_VERSION &&
+                        info.size == sizeof(header) + header.collectionsCount * sizeof(ProgressSummary) +
+                                         (uint64_t)header.recordsCount * header.recordSize;
+        storage_file_free(file);
+        if (complete && storage_common_rename(storage, SAVE_TEMP_PATH, SAVE_DATA_PATH) == FSE_OK)
+        {
+            FURI_LOG_W("GAME", "Recovered player progress from %s", SAVE_TEMP_PATH);
+            return;
         }
     }
+    storage_common_remove(storage, SAVE_TEMP_PATH);
+}
 
-    file_lines_reader_free(reader);
+void levels_database_load_player_progress(LevelsDatabase* database)
+{
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    levels_database_recover_progress(storage);
+
+    database->progressRecordsCount = 0;
+    database->progressLogCount = 0;
+    for (int pageIndex = 0; pageIndex < LEVELS_DATABASE_PAGES_COUNT; pageIndex++)
+        database->pages[pageIndex].firstLevel = -1;
+
+    // Only the header and the summaries are read: the records are read a page at a time, when shown.
+    File* file = storage_file_alloc(storage);
+    uint8_t bytes[sizeof(ProgressHeader)];
+    const ProgressHeader* header = (const ProgressHeader*)bytes;
+    int version = 0;
+    bool current = false;
+    if (storage_file_open(file, SAVE_DATA_PATH, FSAM_READ, FSOM_OPEN_EXISTING))
+    {
+        version = progress_header_version(bytes, storage_file_read(file, bytes, sizeof(bytes)));
+        current = version == PROGRESS_VERSION && header->recordSize == sizeof(ProgressRecord) &&
+                  header->collectionsCount == database->collectionsCount && header->databaseSize == database->databaseSize &&
+                  (int)header->recordsCount == levels_database_levels_count(database);
+        for (int collectionIndex = 0; collectionIndex < database->collectionsCount && current; collectionIndex++)
+        {
+            ProgressSummary summary;
+            current = storage_file_read(file, &summary, sizeof(summary)) == sizeof(summary);
+            database->collections[collectionIndex].completedCount = summary.completedCount;
+            database->collections[collectionIndex].starredCount = summary.starredCount;
+        }
+    }
     storage_file_free(file);
+
+    if (current)
+    {
+        database->progressRecordsCount = header->recordsCount;
+        levels_database_replay_log(storage, database);
+    }
+    else if (storage_file_exists(storage, SAVE_DATA_PATH) || storage_file_exists(storage, TEXT_SAVE_DATA_PATH))
+    {
+        // Progress from the text save, or counted against a different database, is rewritten once.
+        FURI_LOG_I("GAME", "Migrating player progress to %s", SAVE_DATA_PATH);
+        if (version == PROGRESS_VERSION)
+            levels_database_read_log(storage, database, header->recordsCount);
+        levels_database_write_progress(storage, database);
+    }
+    else
+        FURI_LOG_D("GAME", "Could not open file to load progress: %s", SAVE_DATA_PATH);
+
     furi_record_close(RECORD_STORAGE);
-}
\ No newline at end of file
+}
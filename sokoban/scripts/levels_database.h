@@ -1,5 +1,49 @@
 #pragma once
 
+#include <stdbool.h>
+#include <stdint.h>
+#include <storage/storage.h>
+
+// Level metadata is kept on storage and read a page at a time, so that startup time and heap use do not depend on the
+// number of levels. Two files are involved, both indexed by the position of the level in the whole database:
+//
+// database.bin, compiled from database.txt by tools/level_compiler, or into the app data folder when missing or stale.
+// Layout, little endian:
+//   LevelsDatabaseHeader
+//   LevelsDatabaseEntry[collectionsCount]
+//   uint16_t worldBest[levels in all collections]
+//
+// sokoban.sav, the player progress:
+//   ProgressHeader
+//   ProgressSummary[collectionsCount], the completed and starred counts of each collection
+//   ProgressRecord[recordsCount]
+// New best scores go first to a write-ahead log, sokoban.wal (see levels_database_set_player_best).
+
+#define LEVELS_DATABASE_MAGIC 0x424B534D // "MSKB"
+#define LEVELS_DATABASE_VERSION 1
+
+typedef struct LevelsDatabaseHeader
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t collectionsCount;
+    uint32_t sourceSize; // Size of the database.txt the file was compiled from.
+} LevelsDatabaseHeader;
+
+typedef struct LevelsDatabaseEntry
+{
+    char name[32];
+    uint32_t firstLevel;
+    uint32_t levelsCount;
+} LevelsDatabaseEntry;
+
+// Levels read from storage at once. The menu shows 5 levels around the selected one, which spans at most two pages.
+#define LEVELS_DATABASE_PAGE_LEVELS 32
+#define LEVELS_DATABASE_PAGES_COUNT 2
+
+// Best scores logged before the progress log is compacted on its own. Also bounds the work of recovering the log.
+#define PROGRESS_LOG_MAX_ENTRIES 32
+
 typedef struct LevelItem
 {
     unsigned short worldBest;
@@ -10,16 +54,59 @@ typedef struct LevelsCollection
 {
     char name[32];
     int levelsCount;
-    LevelItem* levels;
+    int firstLevel; // Position of the first level of the collection in the database.
+    int completedCount;
+    int starredCount; // Levels completed in as many pushes as the world best, or fewer.
 } LevelsCollection;
 
+typedef struct LevelsPage
+{
+    int firstLevel; // Position in the database, or -1 when the page is empty.
+    int levelsCount;
+    uint32_t lastUse;
+    LevelItem levels[LEVELS_DATABASE_PAGE_LEVELS];
+} LevelsPage;
+
+typedef struct ProgressLogEntry
+{
+    uint32_t recordIndex;
+    uint16_t playerBest;
+    // The summary of the collection of the level after this score, so replaying the log twice is harmless.
+    uint16_t completedCount, starredCount;
+    uint16_t checksum; // Of the fields above, to detect an entry torn by a power loss.
+} ProgressLogEntry;
+
 typedef struct LevelsDatabase
 {
     int collectionsCount;
     LevelsCollection* collections;
+    char path[64];         // Of the compiled database in use.
+    uint32_t databaseSize; // Of the database.txt it was compiled from.
+
+    LevelsPage pages[LEVELS_DATABASE_PAGES_COUNT];
+    uint32_t pageUses;
+
+    int progressRecordsCount; // Level records in the progress file; levels past them need the whole file written.
+    int progressLogCount;     // Best scores logged but not yet copied into the progress file.
+    ProgressLogEntry progressLog[PROGRESS_LOG_MAX_ENTRIES];
 } LevelsDatabase;
 
 LevelsDatabase* levels_database_load();
-void levels_database_free(LevelsDatabase* levelsMetadata);
+void levels_database_free(LevelsDatabase* database);
+
+// Compiles database.txt into the binary database.
+bool levels_database_compile(Storage* storage, const char* sourcePath, const char* outputPath);
+
+// Returns the metadata of a level, reading its page from storage if it is not cached.
+LevelItem levels_database_get_level(LevelsDatabase* database, int collectionIndex, int levelIndex);
+
 void levels_database_load_player_progress(LevelsDatabase* database);
-void levels_database_save_player_progress(LevelsDatabase* database);
\ No newline at end of file
+// Writes the whole progress file.
+void levels_database_save_player_progress(LevelsDatabase* database);
+// Sets the best score of a level, and saves it by appending it to the progress log. Falls back to writing the whole file
+// when the level has no record yet.
+void levels_database_set_player_best(LevelsDatabase* database, int collectionIndex, int levelIndex, unsigned short playerBest);
+// Copies the logged progress into the progress file, and clears the log. Meant for idle moments; saving runs it too
+// when the log is full.
+void levels_database_compact_progress(LevelsDatabase* database);
+bool levels_database_has_pending_progress(const LevelsDatabase* database);
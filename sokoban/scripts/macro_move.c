@@ -0,0 +1,285 @@
+#include "macro_move.h"
+
+#include <furi.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DIRECTIONS_COUNT 4
+#define UNREACHED 0xFFFF
+#define NO_CELL LEVEL_NO_FLOOR
+
+// Push search nodes are a floor cell of the box and the direction it was pushed to get there, as cell * 4 + direction.
+// Each holds the direction of the push before it, or one of these.
+#define UNVISITED 0xFF
+#define FIRST_PUSH 0xFE
+
+// The board as a search sees it: the box being moved, if any, is lifted from where it started and put down at a cell.
+// Cells are floor cells, and their neighbors are in the order of the moves of the journal: left, right, up, down.
+typedef struct Search
+{
+    GameState* state;
+    LevelFloor floor;
+    int liftedBox;
+    uint16_t* distance; // From the cell a walk goes to, or the stamp of the last flood.
+    uint16_t* queue;
+    MacroMove* macro;
+    int movesCapacity;
+} Search;
+
+static int neighbor(const Search* search, int cell, int direction)
+{
+    return search->floor.neighbors[cell][direction];
+}
+
+static int floor_cell(const Search* search, int x, int y)
+{
+    return search->floor.cellToFloor[y * search->state->levelWidth + x];
+}
+
+// Returns whether a cell has no box, with the lifted box at boxCell. Floor cells have no walls.
+static bool is_open(const Search* search, int cell, int boxCell)
+{
+    if (cell == NO_CELL || cell == boxCell)
+        return false;
+    int width = search->state->levelWidth, boardCell = search->floor.floorToCell[cell];
+    CellType contents = game_state_get_cell(search->state, boardCell % width, boardCell / width);
+    return !(contents & CellHasBox) || cell == search->liftedBox;
+}
+
+static bool has_memory_for(size_t bytes)
+{
+    return memmgr_get_free_heap() >= bytes + MOVE_JOURNAL_MIN_FREE_HEAP;
+}
+
+static void append_move(Search* search, JournalMove move)
+{
+    MacroMove* macro = search->macro;
+    if (macro->movesCount == search->movesCapacity)
+    {
+        search->movesCapacity = MAX(search->movesCapacity * 2, 64);
+        macro->moves = realloc(macro->moves, search->movesCapacity * sizeof(JournalMove));
+    }
+    macro->moves[macro->movesCount++] = move;
+}
+
+// Appends the shortest walk between two cells, with the lifted box at boxCell. Distances are to the cell the walk goes to,
+// so the walk can be written forwards by following them down. Returns false if there is none.
+static bool append_walk(Search* search, int boxCell, int from, int to)
+{
+    memset(search->distance, 0xFF, search->floor.count * sizeof(uint16_t));
+    int head = 0, tail = 0;
+    search->queue[tail++] = to;
+    search->distance[to] = 0;
+    while (head < tail && search->distance[from] == UNREACHED)
+    {
+        int cell = search->queue[head++];
+        search->macro->nodesExpanded += 1;
+        for (int direction = 0; direction < DIRECTIONS_COUNT; direction++)
+        {
+            int next = neighbor(search, cell, direction);
+            if (!is_open(search, next, boxCell) || search->distance[next] != UNREACHED)
+                continue;
+            search->distance[next] = search->distance[cell] + 1;
+            search->queue[tail++] = next;
+        }
+    }
+    if (search->distance[from] == UNREACHED)
+        return false;
+
+    for (int cell = from; cell != to;)
+    {
+        for (int direction = 0; direction < DIRECTIONS_COUNT; direction++)
+        {
+            int next = neighbor(search, cell, direction);
+            if (next != NO_CELL && search->distance[next] + 1 == search->distance[cell])
+            {
+                append_move(search, direction);
+                cell = next;
+                break;
+            }
+        }
+    }
+    return true;
+}
+
+// Marks the cells the player can reach from a cell, with the lifted box at boxCell, with a new stamp. Returns the stamp.
+static uint16_t flood(Search* search, int boxCell, int from, uint16_t stamp)
+{
+    stamp += 1;
+    if (stamp == UNREACHED)
+    {
+        memset(search->distance, 0, search->floor.count * sizeof(uint16_t));
+        stamp = 1;
+    }
+
+    int head = 0, tail = 0;
+    search->queue[tail++] = from;
+    search->distance[from] = stamp;
+    while (head < tail)
+    {
+        int cell = search->queue[head++];
+        for (int direction = 0; direction < DIRECTIONS_COUNT; direction++)
+        {
+            int next = neighbor(search, cell, direction);
+            if (!is_open(search, next, boxCell) || search->distance[next] == stamp)
+                continue;
+            search->distance[next] = stamp;
+            search->queue[tail++] = next;
+        }
+    }
+    return stamp;
+}
+
+static void start_search(Search* search, GameState* state, MacroMove* macro)
+{
+    memset(macro, 0, sizeof(MacroMove));
+    search->state = state;
+    search->liftedBox = NO_CELL;
+    search->macro = macro;
+    search->movesCapacity = 0;
+}
+
+// Numbers the floor and allocates the buffers of a search, with perFloorCell more bytes for each floor cell, and extra
+// more bytes. Returns false, with nothing allocated, if the heap could run short.
+static bool allocate_search(Search* search, size_t perFloorCell, size_t extra)
+{
+    const Level* level = search->state->level;
+    size_t cellsCount = level->level_width * level->level_height;
+    size_t perCell = 2 * sizeof(uint16_t) + perFloorCell;
+    if (!has_memory_for(level_floor_max_memory(level) + cellsCount * perCell + extra))
+        return false;
+
+    level_floor_init(&search->floor, level);
+    search->distance = calloc(search->floor.count, sizeof(uint16_t));
+    search->queue = malloc(search->floor.count * sizeof(uint16_t));
+    size_t floorMemory = cellsCount * sizeof(int32_t) + search->floor.count * (sizeof(uint16_t) + sizeof(*search->floor.neighbors));
+    search->macro->searchMemory = floorMemory + search->floor.count * perCell + extra;
+    return true;
+}
+
+static void free_search(Search* search)
+{
+    free(search->distance);
+    free(search->queue);
+    level_floor_free(&search->floor);
+}
+
+bool macro_move_find_walk(GameState* state, int x, int y, MacroMove* ret_macro)
+{
+    Search search;
+    start_search(&search, state, ret_macro);
+    if ((game_state_get_cell(state, x, y) & (CellHasWall | CellHasBox)) || !allocate_search(&search, 0, 0))
+        return false;
+
+    int target = floor_cell(&search, x, y);
+    bool isFound = target != NO_CELL && append_walk(&search, NO_CELL, floor_cell(&search, state->playerX, state->playerY), target);
+    free_search(&search);
+    if (!isFound)
+        macro_move_free(ret_macro);
+    return isFound;
+}
+
+bool macro_move_find_push(GameState* state, int boxX, int boxY, int x, int y, int maxNodes, MacroMove* ret_macro)
+{
+    Search search;
+    start_search(&search, state, ret_macro);
+    if (!(game_state_get_cell(state, boxX, boxY) & CellHasBox))
+        return false;
+    if (x == boxX && y == boxY)
+        return true;
+    if (game_state_get_cell(state, x, y) & (CellHasWall | CellHasBox))
+        return false;
+    if (!allocate_search(&search, DIRECTIONS_COUNT * sizeof(uint8_t), maxNodes * sizeof(uint32_t)))
+        return false;
+
+    // A box off the floor can not be pushed, and can not be pushed onto it.
+    int box = floor_cell(&search, boxX, boxY), destination = floor_cell(&search, x, y);
+    if (box == NO_CELL || destination == NO_CELL)
+    {
+        free_search(&search);
+        return false;
+    }
+    search.liftedBox = box;
+
+    uint8_t* previousPush = malloc(search.floor.count * DIRECTIONS_COUNT);
+    memset(previousPush, UNVISITED, search.floor.count * DIRECTIONS_COUNT);
+    uint32_t* nodes = malloc(maxNodes * sizeof(uint32_t));
+    int head = 0, tail = 0, goal = NO_CELL;
+    uint16_t stamp = 0;
+
+    // The first pushes are those from the cells the player reaches from where they stand.
+    int player = floor_cell(&search, state->playerX, state->playerY);
+    stamp = flood(&search, box, player, stamp);
+    for (int direction = 0; direction < DIRECTIONS_COUNT && goal == NO_CELL; direction++)
+    {
+        int from = neighbor(&search, box, direction ^ 1), to = neighbor(&search, box, direction);
+        if (from == NO_CELL || search.distance[from] != stamp || !is_open(&search, to, NO_CELL) || tail == maxNodes)
+            continue;
+        int node = to * DIRECTIONS_COUNT + direction;
+        previousPush[node] = FIRST_PUSH;
+        nodes[tail++] = node;
+        if (to == destination)
+            goal = node;
+    }
+
+    while (head < tail && goal == NO_CELL)
+    {
+        int node = nodes[head++];
+        int boxCell = node / DIRECTIONS_COUNT, pushed = node % DIRECTIONS_COUNT;
+        ret_macro->nodesExpanded += 1;
+
+        // After a push, the player stands where the box was.
+        stamp = flood(&search, boxCell, neighbor(&search, boxCell, pushed ^ 1), stamp);
+        for (int direction = 0; direction < DIRECTIONS_COUNT && goal == NO_CELL; direction++)
+        {
+            int from = neighbor(&search, boxCell, direction ^ 1), to = neighbor(&search, boxCell, direction);
+            if (from == NO_CELL || search.distance[from] != stamp || !is_open(&search, to, NO_CELL))
+                continue;
+            int next = to * DIRECTIONS_COUNT + direction;
+            if (previousPush[next] != UNVISITED || tail == maxNodes)
+                continue;
+            previousPush[next] = pushed;
+            nodes[tail++] = next;
+            if (to == destination)
+                goal = next;
+        }
+    }
+
+    if (goal != NO_CELL)
+    {
+        // The pushes are found from the last one back, and then played forwards with the walks between them.
+        int pushesCount = 0;
+        for (int node = goal;; pushesCount++)
+        {
+            nodes[pushesCount] = node;
+            if (previousPush[node] == FIRST_PUSH)
+                break;
+            int previousBox = neighbor(&search, node / DIRECTIONS_COUNT, (node % DIRECTIONS_COUNT) ^ 1);
+            node = previousBox * DIRECTIONS_COUNT + previousPush[node];
+        }
+
+        int boxCell = box;
+        for (int push = pushesCount; push >= 0; push--)
+        {
+            int direction = nodes[push] % DIRECTIONS_COUNT;
+            append_walk(&search, boxCell, player, neighbor(&search, boxCell, direction ^ 1));
+            append_move(&search, direction | MoveBoxPushed);
+            player = boxCell;
+            boxCell = nodes[push] / DIRECTIONS_COUNT;
+        }
+    }
+
+    free_search(&search);
+    free(previousPush);
+    free(nodes);
+    if (goal == NO_CELL)
+        macro_move_free(ret_macro);
+    return goal != NO_CELL;
+}
+
+void macro_move_free(MacroMove* macro)
+{
+    free(macro->moves);
+    macro->moves = NULL;
+    macro->movesCount = 0;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "game_state.h"
+#include "move_journal.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+// Macro moves: many moves chosen at once, by searching the current position, to be applied in a group with
+// game_state_apply_moves. Searches only use memory for the time they run, and fail rather than take the memory that the
+// move journal keeps free (MOVE_JOURNAL_MIN_FREE_HEAP).
+
+typedef struct MacroMove
+{
+    JournalMove* moves;
+    int movesCount;
+    int nodesExpanded; // Positions taken out of the search queue.
+    size_t searchMemory; // Heap the search used, in bytes.
+} MacroMove;
+
+// Finds the shortest walk of the player to a cell that does not push any box. The search is breadth first, from the cell,
+// over the cells without walls or boxes, and stops as soon as it reaches the player. Returns false if the cell can not be
+// reached, or if there is no memory for the search.
+bool macro_move_find_walk(GameState* state, int x, int y, MacroMove* ret_macro);
+
+// Positions a push search expands at most, unless told otherwise.
+#define MACRO_MOVE_MAX_PUSH_NODES 4096
+
+// Finds pushes that take one box to a destination cell, without moving any other box, along with the walks of the player
+// between them. The search is breadth first over the positions of the box and the side it was pushed from, so it finds
+// the fewest pushes; each position it expands floods the cells the player can reach. It expands at most maxNodes
+// positions, and its memory is allocated up front: a byte for each side of each cell, and 4 bytes for each position.
+// Returns false if the box can not be taken there, if the search runs out of positions, or if there is no memory for it.
+bool macro_move_find_push(GameState* state, int boxX, int boxY, int x, int y, int maxNodes, MacroMove* ret_macro);
+
+void macro_move_free(MacroMove* macro);
@@ -0,0 +1,151 @@
+#include "move_journal.h"
+
+#include <furi.h>
+#include <stdlib.h>
+
+#define MOVE_BITS 3
+#define MOVE_MASK 0x07
+
+static MoveJournalChunk* chunk_alloc(MoveJournal* journal)
+{
+    MoveJournalChunk* chunk = malloc(sizeof(MoveJournalChunk));
+    chunk->previous = chunk->next = NULL;
+    journal->chunksCount += 1;
+    return chunk;
+}
+
+static JournalMove chunk_get(const MoveJournalChunk* chunk, int index)
+{
+    uint32_t word = chunk->words[index / MOVE_JOURNAL_MOVES_PER_WORD];
+    return (word >> (index % MOVE_JOURNAL_MOVES_PER_WORD * MOVE_BITS)) & MOVE_MASK;
+}
+
+static void chunk_set(MoveJournalChunk* chunk, int index, JournalMove move)
+{
+    uint32_t* word = &chunk->words[index / MOVE_JOURNAL_MOVES_PER_WORD];
+    int shift = index % MOVE_JOURNAL_MOVES_PER_WORD * MOVE_BITS;
+    *word = (*word & ~((uint32_t)MOVE_MASK << shift)) | ((uint32_t)(move & MOVE_MASK) << shift);
+}
+
+void move_journal_init(MoveJournal* journal)
+{
+    journal->chunksCount = 0;
+    journal->first = journal->cursor = chunk_alloc(journal);
+    journal->cursorIndex = 0;
+    journal->undoCount = journal->redoCount = 0;
+    journal->droppedCount = 0;
+}
+
+void move_journal_free(MoveJournal* journal)
+{
+    MoveJournalChunk* chunk = journal->first;
+    while (chunk != NULL)
+    {
+        MoveJournalChunk* next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+    journal->first = journal->cursor = NULL;
+    journal->chunksCount = 0;
+}
+
+// Links a chunk after the cursor chunk, for the cursor to move into. Chunks left there by undone moves are reused first;
+// then, when memory is low and dropping is allowed, the oldest chunk; and otherwise a new one.
+static void ensure_next_chunk(MoveJournal* journal, bool canDrop)
+{
+    if (journal->cursor->next != NULL)
+        return;
+
+    MoveJournalChunk* chunk;
+    if (canDrop && journal->first != journal->cursor && memmgr_get_free_heap() < MOVE_JOURNAL_MIN_FREE_HEAP)
+    {
+        chunk = journal->first;
+        journal->first = chunk->next;
+        journal->first->previous = NULL;
+        chunk->next = NULL;
+
+        // Every chunk before the cursor is full.
+        journal->undoCount -= MOVE_JOURNAL_MOVES_PER_CHUNK;
+        journal->droppedCount += MOVE_JOURNAL_MOVES_PER_CHUNK;
+        FURI_LOG_W("GAME", "Low memory: dropped the oldest %d moves", MOVE_JOURNAL_MOVES_PER_CHUNK);
+    }
+    else
+        chunk = chunk_alloc(journal);
+
+    chunk->previous = journal->cursor;
+    journal->cursor->next = chunk;
+}
+
+static void advance(MoveJournal* journal, bool canDrop)
+{
+    journal->cursorIndex += 1;
+    if (journal->cursorIndex == MOVE_JOURNAL_MOVES_PER_CHUNK)
+    {
+        ensure_next_chunk(journal, canDrop);
+        journal->cursor = journal->cursor->next;
+        journal->cursorIndex = 0;
+    }
+}
+
+void move_journal_record(MoveJournal* journal, JournalMove move)
+{
+    chunk_set(journal->cursor, journal->cursorIndex, move);
+    journal->redoCount = 0;
+    journal->undoCount += 1;
+    advance(journal, true);
+}
+
+JournalMove move_journal_undo(MoveJournal* journal)
+{
+    if (journal->undoCount == 0)
+        return MoveInvalid;
+
+    if (journal->cursorIndex == 0)
+    {
+        journal->cursor = journal->cursor->previous;
+        journal->cursorIndex = MOVE_JOURNAL_MOVES_PER_CHUNK;
+    }
+    journal->cursorIndex -= 1;
+
+    journal->undoCount -= 1;
+    journal->redoCount += 1;
+    return chunk_get(journal->cursor, journal->cursorIndex);
+}
+
+JournalMove move_journal_redo(MoveJournal* journal)
+{
+    if (journal->redoCount == 0)
+        return MoveInvalid;
+
+    JournalMove move = chunk_get(journal->cursor, journal->cursorIndex);
+    journal->redoCount -= 1;
+    journal->undoCount += 1;
+    // Only recording drops moves, as the game trims its keyframes and groups after recording.
+    advance(journal, false);
+    return move;
+}
+
+int move_journal_position(const MoveJournal* journal)
+{
+    return journal->droppedCount + journal->undoCount;
+}
+
+MoveJournalMark move_journal_mark(const MoveJournal* journal)
+{
+    MoveJournalMark mark = {.chunk = journal->cursor, .index = journal->cursorIndex, .position = move_journal_position(journal)};
+    return mark;
+}
+
+void move_journal_restore(MoveJournal* journal, MoveJournalMark mark)
+{
+    int movesCount = journal->undoCount + journal->redoCount;
+    journal->cursor = mark.chunk;
+    journal->cursorIndex = mark.index;
+    journal->undoCount = mark.position - journal->droppedCount;
+    journal->redoCount = movesCount - journal->undoCount;
+}
+
+size_t move_journal_heap_size(const MoveJournal* journal)
+{
+    return journal->chunksCount * sizeof(MoveJournalChunk);
+}
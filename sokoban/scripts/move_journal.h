@@ -0,0 +1,76 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+// The moves of a game, for undo and redo. Each move takes 3 bits: its direction, and whether it pushed a box.
+// Moves are kept in a chain of fixed-size chunks, so history is only limited by the free heap. Chunks are recycled:
+// undone moves are overwritten in place, and when the free heap runs low the oldest chunk is reused, dropping its moves,
+// instead of allocating a new one.
+
+typedef uint8_t JournalMove;
+enum {
+    MoveDirectionMask = 0x03,
+    MoveLeft = 0x00,
+    MoveRight = 0x01,
+    MoveUp = 0x02,
+    MoveDown = 0x03,
+
+    MoveBoxPushed = 0x04,
+
+    MoveInvalid = 0x80,
+};
+
+#define MOVE_JOURNAL_CHUNK_WORDS 16
+#define MOVE_JOURNAL_MOVES_PER_WORD 10
+#define MOVE_JOURNAL_MOVES_PER_CHUNK (MOVE_JOURNAL_CHUNK_WORDS * MOVE_JOURNAL_MOVES_PER_WORD)
+
+// Below this much free heap, the oldest chunk is reused instead of allocating a new one.
+#define MOVE_JOURNAL_MIN_FREE_HEAP (16 * 1024)
+
+typedef struct MoveJournalChunk
+{
+    struct MoveJournalChunk* previous;
+    struct MoveJournalChunk* next;
+    uint32_t words[MOVE_JOURNAL_CHUNK_WORDS];
+} MoveJournalChunk;
+
+typedef struct MoveJournal
+{
+    MoveJournalChunk* first;  // Holds the oldest move.
+    MoveJournalChunk* cursor; // Holds the slot of the next move.
+    int cursorIndex;
+    int chunksCount;
+    int undoCount, redoCount;
+    int droppedCount; // Oldest moves dropped to save memory.
+} MoveJournal;
+
+// A position in the journal, to come back to it in constant time. It stays valid while its moves are neither dropped nor
+// discarded by recording over them.
+typedef struct MoveJournalMark
+{
+    MoveJournalChunk* chunk;
+    int index;
+    int position;
+} MoveJournalMark;
+
+void move_journal_init(MoveJournal* journal);
+void move_journal_free(MoveJournal* journal);
+
+// Adds a move after the current one. Moves that could be redone are discarded.
+void move_journal_record(MoveJournal* journal, JournalMove move);
+// Steps back one move and returns it, or MoveInvalid if there are no moves to undo.
+JournalMove move_journal_undo(MoveJournal* journal);
+// Steps forward one move and returns it, or MoveInvalid if there are no moves to redo. Never drops moves, even when the
+// free heap is low: only move_journal_record does.
+JournalMove move_journal_redo(MoveJournal* journal);
+
+// Returns the count of moves done from the start of the level, including the dropped ones.
+int move_journal_position(const MoveJournal* journal);
+MoveJournalMark move_journal_mark(const MoveJournal* journal);
+// Moves the cursor to a mark, as if the moves between them had been undone or redone.
+void move_journal_restore(MoveJournal* journal, MoveJournalMark mark);
+
+// Returns the heap memory used by the journal, in bytes.
+size_t move_journal_heap_size(const MoveJournal* journal);
@@ -60,6 +60,7 @@ void render_controls_guide(Canvas* canvas)
 
     render_boxed_text(canvas, "Move", 36, 18);
     render_boxed_text(canvas, "Undo", 38, 34);
+    render_boxed_text(canvas, "Hold: Menu", 74, 42);
     render_boxed_text(canvas, "Exit", 90, 54);
 }
 
@@ -3,6 +3,11 @@
 #include "levels_database.h"
 #include "level.h"
 #include "game_state.h"
+#include "game_renderer.h"
+#include "hint.h"
+#include "macro_move.h"
+#include "session_journal.h"
+#include "solutions.h"
 #include "wave/scene_management.h"
 #include "wave/calc.h"
 #include "racso_sokoban_icons.h"
@@ -13,13 +18,122 @@
 #include <stdlib.h>
 #include <stdio.h>
 
-const int MAX_UNDO_STATES = 256;
+const uint32_t HINT_TICK_BUDGET_MS = 30;
+// Playback of a solution starts at a move per tick, and goes up to this many.
+const int PLAYBACK_MAX_SPEED = 16;
+// Buffered session operations are written once they are this old, so a crash loses little even if the buffer is not full.
+const uint32_t SESSION_FLUSH_DELAY_MS = 5000;
+
+// Actions of the menu opened by holding Back.
+typedef enum GameAction
+{
+    GameAction_Hint,
+    GameAction_Redo,
+    GameAction_Scrub,
+    GameAction_GoTo,
+    GameAction_Solution,
+    GameActionsCount,
+} GameAction;
 
 static struct {
+    const char* collectionName;
+    int levelIndex;
     Level* level;
     GameState* state;
+    GameRenderer* renderer;
+    Hint* hint;
+    SessionJournal* session;
+    bool isMenuOpen;
+    int menuSelection;
+    bool isScrubbing;
+    bool isPicking; // Choosing a cell with the cursor.
+    int cursorX, cursorY;
+    bool hasPickedBox;
+    int pickedBoxX, pickedBoxY;
+    const char* pickMessage;
+    GameState* playback; // The known solution of the level played from its start, shown instead of the game.
+    char* playbackSolution; // NULL if the level has none.
+    LurdCheck playbackCheck;
+    int playbackSpeed; // Moves per tick.
+    bool isPlaybackPaused;
+    bool isBackPressedInPlay; // The Back press being held began while playing, not in a menu or a mode it closes.
 } game;
 
+// Returns the state on screen: the playback, while a solution is played, or the game.
+static GameState* game_shown_state()
+{
+    return game.playback != NULL ? game.playback : game.state;
+}
+
+// Seeks through the history, keeping the session journal in step.
+static void game_seek(int position)
+{
+    int before = game_state_position(game.state);
+    game_state_seek(game.state, position);
+    session_journal_append_seek(game.session, before, game_state_position(game.state));
+}
+
+static void game_cancel_hint()
+{
+    if (game.hint == NULL)
+        return;
+
+    hint_free(game.hint);
+    game.hint = NULL;
+}
+
+// Applies the moves of a macro as one group, keeping the session journal in step.
+static void game_apply_macro(const MacroMove* macro)
+{
+    game_cancel_hint();
+    int applied = game_state_apply_moves(game.state, macro->moves, macro->movesCount);
+    session_journal_append(game.session, SessionOp_MoveGroup);
+    for (int i = 0; i < applied; i++)
+        session_journal_append(game.session, (SessionOp)(macro->moves[i] & MoveDirectionMask));
+    session_journal_append(game.session, SessionOp_MoveGroup);
+}
+
+// Plays the known solution of the level from its start, in a state of its own, so the game is left as it was.
+static void game_start_playback()
+{
+    game_cancel_hint();
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    game.playbackSolution = solutions_load(storage, game.collectionName, game.levelIndex, SOLUTIONS_MAX_LENGTH);
+    furi_record_close(RECORD_STORAGE);
+
+    // The whole solution is checked before it is played, to tell how long it is and whether it holds up.
+    game.playbackCheck = (LurdCheck){.illegalMove = -1};
+    if (game.playbackSolution != NULL)
+        game_state_check_lurd(game.level, game.playbackSolution, &game.playbackCheck);
+    game.playback = game_state_initialize(game.level);
+    game.playbackSpeed = 1;
+    game.isPlaybackPaused = game.playbackSolution == NULL;
+}
+
+static void game_stop_playback()
+{
+    if (game.playback == NULL)
+        return;
+
+    game_state_free(game.playback);
+    free(game.playbackSolution);
+    game.playback = NULL;
+    game.playbackSolution = NULL;
+    game_state_mark_all_dirty(game.state);
+}
+
+// Plays the next move of the solution. Returns false, and pauses, once there are no more moves to play.
+static bool game_step_playback()
+{
+    int position = game_state_position(game.playback);
+    if (game.playbackSolution == NULL || game.playbackSolution[position] == '\0' || !game_state_apply_lurd_move(game.playback, game.playbackSolution[position]))
+    {
+        game.isPlaybackPaused = true;
+        return false;
+    }
+    return true;
+}
+
 // Victory Popup component
 void victory_popup_render_callback(Canvas* const canvas, AppContext* app)
 {
@@ -27,7 +141,7 @@ void victory_popup_render_callback(Canvas* const canvas, AppContext* app)
 
     AppGameplayState* gameplayState = app->gameplay;
     LevelsDatabase* database = app->database;
-    LevelItem* levelItem = &database->collections[gameplayState->selectedCollection].levels[gameplayState->selectedLevel];
+    LevelItem levelItem = levels_database_get_level(database, gameplayState->selectedCollection, gameplayState->selectedLevel);
 
     GameState* state = game.state;
 
@@ -43,11 +157,11 @@ void victory_popup_render_callback(Canvas* const canvas, AppContext* app)
     canvas_draw_str_aligned(canvas, 64, 20, AlignCenter, AlignCenter, str);
 
     canvas_draw_icon(canvas, 32 - ICON_SIDE / 2, 28, &I_checkbox_checked);
-    snprintf(str, sizeof(str), "Best: %d", levelItem->playerBest);
+    snprintf(str, sizeof(str), "Best: %d", levelItem.playerBest);
     canvas_draw_str_aligned(canvas, 32, 42, AlignCenter, AlignCenter, str);
 
     canvas_draw_icon(canvas, 96 - ICON_SIDE / 2, 28, &I_star);
-    snprintf(str, sizeof(str), "World: %d", levelItem->worldBest);
+    snprintf(str, sizeof(str), "World: %d", levelItem.worldBest);
     canvas_draw_str_aligned(canvas, 96, 42, AlignCenter, AlignCenter, str);
 
     const int START_CENTER_X = 100, START_CENTER_Y = 59;
@@ -76,125 +190,142 @@ void victory_popup_handle_input(InputKey key, InputType type, AppContext* app)
     }
 }
 
-const Icon* findIcon(CellType cellType, int size)
+// Frames the box to push and draws a line towards where it goes.
+static void draw_hint_push(Canvas* const canvas, int x, int y, int dx, int dy, int cellSize)
 {
-    switch (cellType)
-    {
-    case CellHasWall:
-        switch (size)
-        {
-        case 5:
-            return &I_cell_wall_5;
-        case 7:
-            return &I_cell_wall_7;
-        case 9:
-            return &I_cell_wall_9;
-        }
-        break;
-
-    case CellHasBox:
-        switch (size)
-        {
-        case 5:
-            return &I_cell_box_5;
-        case 7:
-            return &I_cell_box_7;
-        case 9:
-            return &I_cell_box_9;
-        }
-        break;
+    canvas_draw_frame(canvas, x - 1, y - 1, cellSize + 2, cellSize + 2);
 
-    case CellHasTarget:
-        switch (size)
-        {
-        case 5:
-            return &I_cell_target_5;
-        case 7:
-            return &I_cell_target_7;
-        case 9:
-            return &I_cell_target_9;
-        }
-        break;
+    int centerX = x + cellSize / 2, centerY = y + cellSize / 2;
+    canvas_draw_line(canvas, centerX, centerY, centerX + dx * cellSize, centerY + dy * cellSize);
+}
 
-    case CellHasPlayer:
-        switch (size)
-        {
-        case 5:
-            return &I_cell_player_5;
-        case 7:
-            return &I_cell_player_7;
-        case 9:
-            return &I_cell_player_9;
-        }
-        break;
+static void draw_status_message(Canvas* const canvas, const char* message)
+{
+    canvas_set_font(canvas, FontSecondary);
+    int width = canvas_string_width(canvas, message);
+    canvas_set_color(canvas, ColorWhite);
+    canvas_draw_box(canvas, 0, 0, width + 4, 11);
+    canvas_set_color(canvas, ColorBlack);
+    canvas_draw_frame(canvas, 0, 0, width + 4, 11);
+    canvas_draw_str_aligned(canvas, 2, 2, AlignLeft, AlignTop, message);
+}
 
-    case CellHasBox | CellHasTarget:
-        switch (size)
-        {
-        case 5:
-            return &I_cell_box_target_5;
-        case 7:
-            return &I_cell_box_target_7;
-        case 9:
-            return &I_cell_box_target_9;
-        }
-        break;
+// Shows where the current position is in the history.
+static void draw_scrub_bar(Canvas* const canvas)
+{
+    const int BAR_HEIGHT = 6;
+    GameState* state = game.state;
+    int first = game_state_first_position(state), last = game_state_last_position(state);
+    int position = game_state_position(state);
 
-    case CellHasPlayer | CellHasTarget:
-        switch (size)
-        {
-        case 5:
-            return &I_cell_player_target_5;
-        case 7:
-            return &I_cell_player_target_7;
-        case 9:
-            return &I_cell_player_target_9;
-        }
-        break;
+    char message[32];
+    snprintf(message, sizeof(message), "Move %d/%d", position, last);
+    draw_status_message(canvas, message);
 
-    default:
-        return NULL;
-    }
+    canvas_set_color(canvas, ColorWhite);
+    canvas_draw_box(canvas, 0, 64 - BAR_HEIGHT, 128, BAR_HEIGHT);
+    canvas_set_color(canvas, ColorBlack);
+    canvas_draw_frame(canvas, 0, 64 - BAR_HEIGHT, 128, BAR_HEIGHT);
+    int filled = last > first ? (position - first) * 126 / (last - first) : 126;
+    canvas_draw_box(canvas, 1, 64 - BAR_HEIGHT + 1, filled, BAR_HEIGHT - 2);
+}
 
-    return NULL;
+static void draw_playback_status(Canvas* const canvas)
+{
+    char message[32];
+    int position = game_state_position(game.playback);
+    if (game.playbackSolution == NULL)
+        snprintf(message, sizeof(message), "No solution");
+    else if (game.playback->isCompleted)
+        snprintf(message, sizeof(message), "Solved: %d pushes", game.playback->pushesCount);
+    else if (position == game.playbackCheck.illegalMove)
+        snprintf(message, sizeof(message), "Illegal move %d", position + 1);
+    else if (game.isPlaybackPaused)
+        snprintf(message, sizeof(message), "Paused %d/%d", position, game.playbackCheck.movesCount);
+    else
+        snprintf(message, sizeof(message), "x%d %d/%d", game.playbackSpeed, position, game.playbackCheck.movesCount);
+    draw_status_message(canvas, message);
 }
 
 void draw_game(Canvas* const canvas)
 {
-    GameState* state = game.state;
-    Level *level = game.level;
+    game_renderer_draw(game.renderer, canvas, game_shown_state());
 
-    int cellSize = level->cell_size;
-    int levelWidth = level->level_width * cellSize;
-    int levelHeight = level->level_height * cellSize;
+    if (game.playback != NULL)
+    {
+        draw_playback_status(canvas);
+        return;
+    }
 
-    int playerX = state->playerX * cellSize;
-    int playerY = state->playerY * cellSize;
+    if (game.isScrubbing)
+    {
+        draw_scrub_bar(canvas);
+        return;
+    }
 
-    int screenWidth = 128;
-    int screenHeight = 64;
+    if (game.isPicking)
+    {
+        if (game.hasPickedBox)
+        {
+            int x, y, cellSize = game.level->cell_size;
+            game_renderer_cell_position(game.renderer, game.pickedBoxX, game.pickedBoxY, &x, &y);
+            canvas_set_color(canvas, ColorXOR);
+            canvas_draw_box(canvas, x, y, cellSize, cellSize);
+            canvas_set_color(canvas, ColorBlack);
+        }
+        draw_status_message(canvas, game.pickMessage);
+        return;
+    }
+
+    if (game.hint == NULL)
+        return;
 
-    int minScrollingWidth = screenWidth + (cellSize - 1) * 2;
-    int minScrollingHeight = screenHeight + (cellSize - 1) * 2;
+    int boxX, boxY, dx, dy;
+    if (hint_get_push(game.hint, &boxX, &boxY, &dx, &dy))
+    {
+        int x, y;
+        game_renderer_cell_position(game.renderer, boxX, boxY, &x, &y);
+        draw_hint_push(canvas, x, y, dx, dy, game.level->cell_size);
+    }
+    else if (hint_status(game.hint) == HintStatus_Searching)
+        draw_status_message(canvas, "Thinking...");
+    else
+        draw_status_message(canvas, "No hint");
+}
 
-    int cameraX = levelWidth / 2;
-    if (levelWidth > minScrollingWidth)
-        cameraX = MAX(screenWidth / 2, MIN(playerX, levelWidth - screenWidth / 2));
+static void draw_actions_menu(Canvas* const canvas)
+{
+    const int ITEM_HEIGHT = 11, MENU_WIDTH = 52;
+    const int x = 128 - MENU_WIDTH, y = 0;
 
-    int cameraY = levelHeight / 2;
-    if (levelHeight > minScrollingHeight)
-        cameraY = MAX(screenHeight / 2, MIN(playerY, levelHeight - screenHeight / 2));
+    canvas_set_font(canvas, FontSecondary);
+    canvas_set_color(canvas, ColorWhite);
+    canvas_draw_box(canvas, x, y, MENU_WIDTH, GameActionsCount * ITEM_HEIGHT + 2);
+    canvas_set_color(canvas, ColorBlack);
+    canvas_draw_frame(canvas, x, y, MENU_WIDTH, GameActionsCount * ITEM_HEIGHT + 2);
 
-    for (int row = 0; row < level->level_height; row++)
+    for (int action = 0; action < GameActionsCount; action++)
     {
-        for (int column = 0; column < level->level_width; column++)
+        char label[32];
+        if (action == GameAction_Hint)
+            snprintf(label, sizeof(label), "Hint");
+        else if (action == GameAction_Redo)
+            snprintf(label, sizeof(label), "Redo (%d)", game.state->journal.redoCount);
+        else if (action == GameAction_Scrub)
+            snprintf(label, sizeof(label), "Scrub");
+        else if (action == GameAction_GoTo)
+            snprintf(label, sizeof(label), "Go to");
+        else
+            snprintf(label, sizeof(label), "Solution");
+
+        int itemY = y + 1 + action * ITEM_HEIGHT;
+        if (action == game.menuSelection)
         {
-            int x = column * cellSize - cameraX + screenWidth / 2;
-            int y = row * cellSize - cameraY + screenHeight / 2;
-            const Icon* icon = findIcon(state->board[row][column], cellSize);
-            if (icon)
-                canvas_draw_icon(canvas, x, y, icon);
+            canvas_draw_box(canvas, x + 1, itemY, MENU_WIDTH - 2, ITEM_HEIGHT);
+            canvas_set_color(canvas, ColorWhite);
         }
+        canvas_draw_str_aligned(canvas, x + 4, itemY + 2, AlignLeft, AlignTop, label);
+        canvas_set_color(canvas, ColorBlack);
     }
 }
 
@@ -213,6 +344,9 @@ void game_render_callback(Canvas* const canvas, void* context)
         victory_popup_render_callback(canvas, app);
     else
         draw_game(canvas);
+
+    if (game.isMenuOpen && !game.state->isCompleted)
+        draw_actions_menu(canvas);
 }
 
 void game_transition_callback(int from, int to, void* context)
@@ -223,30 +357,256 @@ void game_transition_callback(int from, int to, void* context)
 
     if (from == SceneType_Game)
     {
+        game_cancel_hint();
+        game_stop_playback();
+        if (game.session != NULL)
+            session_journal_close(game.session);
+        game.session = NULL;
+        game_renderer_free(game.renderer);
         game_state_free(game.state);
-        free(game.level);
+        level_free(game.level);
     }
 
     if (to == SceneType_Game)
     {
         const char *collectionName = database->collections[gameplayState->selectedCollection].name;
         int levelIndex = gameplayState->selectedLevel;
+        game.collectionName = collectionName;
+        game.levelIndex = levelIndex;
+
+        game.level = level_load(collectionName, levelIndex);
+
+        game.state = game_state_initialize(game.level);
+        game.renderer = game_renderer_alloc(game.level);
+        game_renderer_update(game.renderer, game.state);
+        game.session = session_journal_open(collectionName, levelIndex, game.state);
+        game.isMenuOpen = false;
+        game.menuSelection = GameAction_Hint;
+        game.isScrubbing = false;
+        game.isPicking = false;
+    }
+}
 
-        game.level = malloc(sizeof(Level));
-        level_load(game.level, collectionName, levelIndex);
+// Up and down choose an action, OK runs it and Back closes the menu. Redo keeps the menu open, so it can be repeated.
+void game_handle_menu_input(InputKey key, InputType type)
+{
+    if (type != InputTypePress && type != InputTypeRepeat)
+        return;
 
-        game.state = game_state_initialize(game.level, MAX_UNDO_STATES);
+    switch (key)
+    {
+    case InputKeyUp:
+        game.menuSelection = (game.menuSelection + GameActionsCount - 1) % GameActionsCount;
+        break;
+    case InputKeyDown:
+        game.menuSelection = (game.menuSelection + 1) % GameActionsCount;
+        break;
+    case InputKeyBack:
+        // Repeats still come from the long press that opened the menu.
+        if (type == InputTypePress)
+            game.isMenuOpen = false;
+        break;
+    case InputKeyOk:
+        if (type != InputTypePress)
+            break;
+        game_cancel_hint();
+        if (game.menuSelection == GameAction_Hint)
+        {
+            game.hint = hint_start(game.state);
+            game.isMenuOpen = false;
+        }
+        else if (game.menuSelection == GameAction_Redo)
+            game_seek(game_state_redo_position(game.state));
+        else if (game.menuSelection == GameAction_Scrub)
+        {
+            game.isScrubbing = true;
+            game.isMenuOpen = false;
+        }
+        else if (game.menuSelection == GameAction_Solution)
+        {
+            game_start_playback();
+            game.isMenuOpen = false;
+        }
+        else
+        {
+            game.isPicking = true;
+            game.hasPickedBox = false;
+            game.isMenuOpen = false;
+            game.cursorX = game.state->playerX;
+            game.cursorY = game.state->playerY;
+            game.pickMessage = "Go to";
+            game_renderer_show_cursor(game.renderer, game.cursorX, game.cursorY);
+        }
+        break;
+    default:
+        break;
     }
 }
 
+// Left and right step one move through the history, up and down jump a tenth of it. OK or Back play on from there.
+void game_handle_scrub_input(InputKey key, InputType type)
+{
+    if (type != InputTypePress && type != InputTypeRepeat)
+        return;
+
+    GameState* state = game.state;
+    int jump = MAX(10, (game_state_last_position(state) - game_state_first_position(state)) / 10);
+    switch (key)
+    {
+    case InputKeyLeft:
+        game_seek(game_state_position(state) - 1);
+        break;
+    case InputKeyRight:
+        game_seek(game_state_position(state) + 1);
+        break;
+    case InputKeyDown:
+        game_seek(game_state_position(state) - jump);
+        break;
+    case InputKeyUp:
+        game_seek(game_state_position(state) + jump);
+        break;
+    case InputKeyOk:
+    case InputKeyBack:
+        if (type == InputTypePress)
+            game.isScrubbing = false;
+        break;
+    default:
+        break;
+    }
+}
+
+// OK pauses and resumes, up and down change the speed, and left and right step back and forth while paused. Back goes
+// back to the game.
+void game_handle_playback_input(InputKey key, InputType type)
+{
+    if (type != InputTypePress && type != InputTypeRepeat)
+        return;
+
+    switch (key)
+    {
+    case InputKeyOk:
+        if (type == InputTypePress)
+            game.isPlaybackPaused = !game.isPlaybackPaused;
+        break;
+    case InputKeyUp:
+        game.playbackSpeed = MIN(game.playbackSpeed * 2, PLAYBACK_MAX_SPEED);
+        break;
+    case InputKeyDown:
+        game.playbackSpeed = MAX(game.playbackSpeed / 2, 1);
+        break;
+    case InputKeyLeft:
+        if (game.isPlaybackPaused)
+            game_state_undo_move(game.playback);
+        break;
+    case InputKeyRight:
+        if (game.isPlaybackPaused)
+            game_step_playback();
+        break;
+    case InputKeyBack:
+        if (type == InputTypePress)
+            game_stop_playback();
+        break;
+    default:
+        break;
+    }
+}
+
+static void game_stop_picking()
+{
+    game.isPicking = false;
+    game_renderer_hide_cursor(game.renderer);
+}
+
+// Walks the player to the cell under the cursor, or picks the box under it, or pushes the box picked before to it.
+static void game_pick_cell()
+{
+    MacroMove macro;
+    bool isFound;
+    if (game.hasPickedBox)
+    {
+        if (game.cursorX == game.pickedBoxX && game.cursorY == game.pickedBoxY)
+        {
+            game.hasPickedBox = false;
+            game.pickMessage = "Go to";
+            return;
+        }
+        isFound = macro_move_find_push(game.state, game.pickedBoxX, game.pickedBoxY, game.cursorX, game.cursorY, MACRO_MOVE_MAX_PUSH_NODES, &macro);
+        FURI_LOG_D("GAME", "Push search expanded %d nodes with %u bytes", macro.nodesExpanded, (unsigned)macro.searchMemory);
+    }
+    else if (game_state_get_cell(game.state, game.cursorX, game.cursorY) & CellHasBox)
+    {
+        game.hasPickedBox = true;
+        game.pickedBoxX = game.cursorX;
+        game.pickedBoxY = game.cursorY;
+        game.pickMessage = "Push to";
+        return;
+    }
+    else
+    {
+        isFound = macro_move_find_walk(game.state, game.cursorX, game.cursorY, &macro);
+        FURI_LOG_D("GAME", "Walk search expanded %d cells", macro.nodesExpanded);
+    }
+
+    if (!isFound)
+    {
+        game.pickMessage = "No path";
+        return;
+    }
+    game_apply_macro(&macro);
+    macro_move_free(&macro);
+    game_stop_picking();
+}
+
+// The arrows move the cursor and OK picks the cell under it: a floor cell to walk to, or a box and then the cell to push
+// it to. Back gives up.
+void game_handle_cursor_input(InputKey key, InputType type)
+{
+    if (type != InputTypePress && type != InputTypeRepeat)
+        return;
+
+    int dx = 0, dy = 0;
+    switch (key)
+    {
+    case InputKeyLeft:
+        dx = -1;
+        break;
+    case InputKeyRight:
+        dx = 1;
+        break;
+    case InputKeyUp:
+        dy = -1;
+        break;
+    case InputKeyDown:
+        dy = 1;
+        break;
+    case InputKeyBack:
+        if (type == InputTypePress)
+            game_stop_picking();
+        return;
+    case InputKeyOk:
+        if (type == InputTypePress)
+            game_pick_cell();
+        return;
+    default:
+        return;
+    }
+
+    game.cursorX = MAX(0, MIN(game.cursorX + dx, game.level->level_width - 1));
+    game.cursorY = MAX(0, MIN(game.cursorY + dy, game.level->level_height - 1));
+    game.pickMessage = game.hasPickedBox ? "Push to" : "Go to";
+    game_renderer_show_cursor(game.renderer, game.cursorX, game.cursorY);
+}
+
 void game_handle_player_input(InputKey key, InputType type)
 {
     if (type != InputTypePress && type != InputTypeRepeat)
         return;
 
+    // Holding OK keeps undoing.
     if (key == InputKeyOk)
     {
-        game_state_undo_move(game.state);
+        game_cancel_hint();
+        game_seek(game_state_undo_position(game.state));
         return;
     }
 
@@ -269,7 +629,14 @@ void game_handle_player_input(InputKey key, InputType type)
         return;
     }
 
+    game_cancel_hint();
+    int before = game_state_position(game.state);
     game_state_apply_move(game.state, dx, dy);
+    if (game_state_position(game.state) != before)
+    {
+        SessionOp op = dx < 0 ? SessionOp_Left : dx > 0 ? SessionOp_Right : dy < 0 ? SessionOp_Up : SessionOp_Down;
+        session_journal_append(game.session, op);
+    }
 }
 
 void game_handle_input(InputKey key, InputType type, void* context)
@@ -277,39 +644,90 @@ void game_handle_input(InputKey key, InputType type, void* context)
     AppContext* app = (AppContext*)context;
     GameState* gameState = game.state;
 
+    // Menus, the scrub bar and the victory popup are drawn on every render, so any input may change the screen.
+    scene_manager_request_render(app->sceneManager);
+
     if (key == InputKeyBack && type == InputTypePress)
+        game.isBackPressedInPlay = game.state->isCompleted || (game.playback == NULL && !game.isMenuOpen && !game.isScrubbing && !game.isPicking);
+
+    if (game.playback != NULL)
+        game_handle_playback_input(key, type);
+    else if (game.isMenuOpen && !game.state->isCompleted)
+        game_handle_menu_input(key, type);
+    else if (game.isScrubbing && !game.state->isCompleted)
+        game_handle_scrub_input(key, type);
+    else if (game.isPicking && !game.state->isCompleted)
+        game_handle_cursor_input(key, type);
+    else
     {
-        scene_manager_set_scene(app->sceneManager, SceneType_Menu);
-        return;
-    }
+        // Holding Back opens the menu, and a long press comes after the press, so Back only leaves on short presses. A
+        // completed level has no menu, so there it leaves at once. A press that closed a menu or a mode does neither.
+        if (key == InputKeyBack)
+        {
+            if (!game.isBackPressedInPlay)
+                return;
+            if (type == InputTypeLong && !game.state->isCompleted)
+                game.isMenuOpen = true;
+            else if (type == (game.state->isCompleted ? InputTypePress : InputTypeShort))
+                scene_manager_set_scene(app->sceneManager, SceneType_Menu);
+            return;
+        }
 
-    if (game.state->isCompleted)
-    {
-        victory_popup_handle_input(key, type, app);
-        return;
-    }
+        if (game.state->isCompleted)
+        {
+            victory_popup_handle_input(key, type, app);
+            return;
+        }
 
-    game_handle_player_input(key, type);
+        game_handle_player_input(key, type);
+    }
 
     if (game.state->isCompleted)
     {
         FURI_LOG_D("GAME", "Level completed in %d pushes", gameState->pushesCount);
 
         dolphin_deed(DolphinDeedPluginGameWin);
+        if (game.session != NULL)
+            session_journal_discard(game.session);
+        game.session = NULL;
+
         AppGameplayState* gameplayState = app->gameplay;
         LevelsDatabase* database = app->database;
 
-        LevelItem* levelItem = &database->collections[gameplayState->selectedCollection].levels[gameplayState->selectedLevel];
-        if (levelItem->playerBest == 0 || gameState->pushesCount < levelItem->playerBest)
-        {
-            levelItem->playerBest = gameState->pushesCount;
-            levels_database_save_player_progress(database);
-        }
+        LevelItem levelItem = levels_database_get_level(database, gameplayState->selectedCollection, gameplayState->selectedLevel);
+        if (levelItem.playerBest == 0 || gameState->pushesCount < levelItem.playerBest)
+            levels_database_set_player_best(database, gameplayState->selectedCollection, gameplayState->selectedLevel, gameState->pushesCount);
     }
 }
 
 void game_tick_callback(void* context)
 {
     AppContext* app = (AppContext*)context;
-    UNUSED(app);
+
+    // The victory popup waits for the player, so it is a good moment to fold the new best score into the save.
+    if (game.state->isCompleted && levels_database_has_pending_progress(app->database))
+        levels_database_compact_progress(app->database);
+
+    if (game.hint != NULL)
+    {
+        HintStatus status = hint_status(game.hint);
+        hint_step(game.hint, HINT_TICK_BUDGET_MS);
+        if (hint_status(game.hint) != status)
+            scene_manager_request_render(app->sceneManager);
+    }
+
+    if (game.playback != NULL && !game.isPlaybackPaused)
+    {
+        for (int move = 0; move < game.playbackSpeed && game_step_playback(); move++)
+            ;
+        if (game.isPlaybackPaused)
+            scene_manager_request_render(app->sceneManager);
+    }
+
+    // Ticks that change nothing on screen are not rendered.
+    if (game_renderer_update(game.renderer, game_shown_state()))
+        scene_manager_request_render(app->sceneManager);
+
+    if (game.session != NULL && session_journal_pending_age(game.session) > SESSION_FLUSH_DELAY_MS)
+        session_journal_flush(game.session);
 }
\ No newline at end of file
@@ -79,12 +79,16 @@ void menu_render_callback(Canvas* const canvas, void* context)
             int y = 12 + i * 10;
             char text[64];
 
+            LevelsCollection* collection = &database->collections[item];
             if (item == gameplayState->selectedCollection)
-                snprintf(text, 64, "> %s", database->collections[item].name);
+                snprintf(text, 64, "> %s", collection->name);
             else
-                snprintf(text, 64, "  %s", database->collections[item].name);
+                snprintf(text, 64, "  %s", collection->name);
 
             canvas_draw_str_aligned(canvas, 0, y, AlignLeft, AlignTop, text);
+
+            snprintf(text, 64, "%d/%d", collection->completedCount, collection->levelsCount);
+            canvas_draw_str_aligned(canvas, 128, y, AlignRight, AlignTop, text);
         }
     }
     else if (menuState == MenuState_LevelSelection)
@@ -108,7 +112,7 @@ void menu_render_callback(Canvas* const canvas, void* context)
             canvas_draw_str_aligned(canvas, x, y, AlignLeft, AlignTop, text);
 
             x += 46;
-            LevelItem levelItem = database->collections[gameplayState->selectedCollection].levels[item];
+            LevelItem levelItem = levels_database_get_level(database, gameplayState->selectedCollection, item);
             const Icon* icon;
             if (levelItem.playerBest == 0)
                 icon = &I_checkbox_empty;
@@ -131,11 +135,15 @@ void menu_render_callback(Canvas* const canvas, void* context)
     }
 }
 
-static int get_first_unplayed_level_index(LevelsCollection* collection)
+static int get_first_unplayed_level_index(LevelsDatabase* database, int collectionIndex)
 {
-    for (int i = 0; i < collection->levelsCount; i++)
-        if (collection->levels[i].playerBest == 0)
-            return i;
+    LevelsCollection* collection = &database->collections[collectionIndex];
+    if (collection->completedCount < collection->levelsCount)
+    {
+        for (int i = 0; i < collection->levelsCount; i++)
+            if (levels_database_get_level(database, collectionIndex, i).playerBest == 0)
+                return i;
+    }
     return collection->levelsCount - 1;
 }
 
@@ -170,8 +178,7 @@ void menu_input_callback(InputKey key, InputType type, void* context)
             gameplayState->selectedCollection = 0;
         else if (state == MenuState_CollectionSelection)
         {
-            LevelsCollection *collection = &database->collections[gameplayState->selectedCollection];
-            gameplayState->selectedLevel = get_first_unplayed_level_index(collection);
+            gameplayState->selectedLevel = get_first_unplayed_level_index(database, gameplayState->selectedCollection);
         }
         else if (state == MenuState_LevelSelection)
         {
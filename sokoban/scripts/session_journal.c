@@ -0,0 +1,307 @@
+#include "session_journal.h"
+
+#include "collection_index.h"
+#include <furi.h>
+#include <storage/storage.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SESSION_MAGIC 0x4A534B53 // "SKSJ"
+#define SESSION_VERSION 1
+
+// Operations are packed 8 to a group of 3 bytes, least significant bits first.
+#define OP_BITS 3
+#define OPS_PER_GROUP 8
+#define GROUP_BYTES 3
+#define BUFFER_BYTES (SESSION_JOURNAL_BUFFER_OPS / OPS_PER_GROUP * GROUP_BYTES)
+
+// Seek positions take 2 bits per operation, so 16 of them hold any position.
+#define SEEK_DIGIT_BITS 2
+#define SEEK_DIGIT_MASK 0x03
+#define SEEK_DIGIT_MORE 0x04
+#define SEEK_MAX_DIGITS 16
+
+typedef struct SessionHeader
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t reserved;
+    uint32_t levelSignature;
+} SessionHeader;
+
+// Where replay is in a seek, between its operation and the last digit of its position.
+typedef struct SeekReplay
+{
+    int digitsCount; // -1 outside of a seek.
+    uint32_t position;
+} SeekReplay;
+
+struct SessionJournal
+{
+    char path[256];
+    uint32_t levelSignature;
+    bool hasHeader;
+    int replayedCount;
+
+    int pendingCount;
+    uint32_t pendingSince;
+    uint8_t buffer[BUFFER_BYTES];
+};
+
+// Identifies the layout of a level, including its orientation, so a session is never replayed on a different board.
+static uint32_t level_signature(const Level* level)
+{
+    uint32_t hash = 2166136261u;
+    hash = (hash ^ level->level_width) * 16777619u;
+    hash = (hash ^ level->level_height) * 16777619u;
+    for (int y = 0; y < level->level_height; y++)
+        for (int x = 0; x < level->level_width; x++)
+            hash = (hash ^ (uint8_t)level_get_cell(level, x, y)) * 16777619u;
+    return hash;
+}
+
+static SessionOp group_get(const uint8_t* group, int index)
+{
+    uint32_t bits = group[0] | (group[1] << 8) | (group[2] << 16);
+    return (bits >> (index * OP_BITS)) & 0x07;
+}
+
+static void group_set(uint8_t* group, int index, SessionOp op)
+{
+    uint32_t bits = group[0] | (group[1] << 8) | (group[2] << 16);
+    bits = (bits & ~(0x07u << (index * OP_BITS))) | ((uint32_t)op << (index * OP_BITS));
+    group[0] = bits;
+    group[1] = bits >> 8;
+    group[2] = bits >> 16;
+}
+
+// Applies one operation, or takes one digit of the position of a seek. Returns false for a seek whose position is out of
+// the history, or does not end within SEEK_MAX_DIGITS.
+static bool replay_op(GameState* state, SeekReplay* seek, SessionOp op)
+{
+    static const int DX[4] = {-1, 1, 0, 0};
+    static const int DY[4] = {0, 0, -1, 1};
+
+    if (seek->digitsCount >= 0)
+    {
+        if (seek->digitsCount == SEEK_MAX_DIGITS)
+            return false;
+        seek->position |= (uint32_t)(op & SEEK_DIGIT_MASK) << (seek->digitsCount * SEEK_DIGIT_BITS);
+        seek->digitsCount += 1;
+        if (op & SEEK_DIGIT_MORE)
+            return true;
+
+        seek->digitsCount = -1;
+        if (seek->position < (uint32_t)game_state_first_position(state) || seek->position > (uint32_t)game_state_last_position(state))
+            return false;
+        game_state_seek(state, seek->position);
+        return true;
+    }
+
+    switch (op)
+    {
+    case SessionOp_Left:
+    case SessionOp_Right:
+    case SessionOp_Up:
+    case SessionOp_Down:
+        game_state_apply_move(state, DX[op], DY[op]);
+        break;
+    case SessionOp_Undo:
+        game_state_undo_move(state);
+        break;
+    case SessionOp_Seek:
+        seek->digitsCount = 0;
+        seek->position = 0;
+        break;
+    case SessionOp_MoveGroup:
+        if (state->groupStart < 0)
+            game_state_begin_group(state);
+        else
+            game_state_end_group(state);
+        break;
+    case SessionOp_None:
+        break;
+    }
+    return true;
+}
+
+// Replays the groups of a session file, and returns the size of the file up to the last valid group that does not end
+// within a seek.
+static uint32_t replay(SessionJournal* journal, File* file, GameState* state)
+{
+    uint8_t buffer[BUFFER_BYTES];
+    uint32_t size = sizeof(SessionHeader), validSize = size;
+    SeekReplay seek = {.digitsCount = -1, .position = 0};
+    bool valid = true;
+    while (valid)
+    {
+        size_t read = storage_file_read(file, buffer, sizeof(buffer));
+        int groupsCount = read / GROUP_BYTES;
+        for (int group = 0; group < groupsCount && valid; group++)
+        {
+            for (int index = 0; index < OPS_PER_GROUP && valid; index++)
+            {
+                SessionOp op = group_get(buffer + group * GROUP_BYTES, index);
+                bool isOperation = seek.digitsCount < 0 && op != SessionOp_None;
+                valid = replay_op(state, &seek, op);
+                if (valid && isOperation)
+                    journal->replayedCount += 1;
+            }
+            size += GROUP_BYTES;
+            if (valid && seek.digitsCount < 0)
+                validSize = size;
+        }
+        if (read < sizeof(buffer))
+            break;
+    }
+    return validSize;
+}
+
+SessionJournal* session_journal_open(const char* collectionName, int levelIndex, GameState* state)
+{
+    SessionJournal* journal = malloc(sizeof(SessionJournal));
+    char suffix[24];
+    snprintf(suffix, sizeof(suffix), "_%d.ses", levelIndex + 1);
+    collection_data_path(journal->path, sizeof(journal->path), collectionName, suffix);
+    journal->levelSignature = level_signature(state->level);
+    journal->hasHeader = false;
+    journal->replayedCount = 0;
+    journal->pendingCount = 0;
+    memset(journal->buffer, 0xFF, sizeof(journal->buffer));
+
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    if (storage_file_open(file, journal->path, FSAM_READ_WRITE, FSOM_OPEN_EXISTING))
+    {
+        SessionHeader header;
+        bool headerValid = storage_file_read(file, &header, sizeof(header)) == sizeof(header) && header.magic == SESSION_MAGIC &&
+                           header.version == SESSION_VERSION && header.levelSignature == journal->levelSignature;
+        if (headerValid)
+        {
+            uint32_t start = furi_get_tick();
+            uint32_t validSize = replay(journal, file, state);
+            journal->hasHeader = true;
+
+            // A batch cut short by a power loss would misalign everything appended after it.
+            if (validSize < storage_file_size(file))
+            {
+                FURI_LOG_W("GAME", "Session journal truncated to %lu bytes", (unsigned long)validSize);
+                storage_file_seek(file, validSize, true);
+                storage_file_truncate(file);
+            }
+            FURI_LOG_D("GAME", "Resumed %d operations from %s in %lu ms", journal->replayedCount, journal->path, (unsigned long)(furi_get_tick() - start));
+
+            // A group cut short by a power loss is ended here, and in the log, so the next group begins where it should.
+            if (state->groupStart >= 0)
+            {
+                game_state_end_group(state);
+                session_journal_append(journal, SessionOp_MoveGroup);
+            }
+        }
+        storage_file_close(file);
+        if (!headerValid)
+        {
+            FURI_LOG_W("GAME", "Discarding session journal: %s", journal->path);
+            storage_common_remove(storage, journal->path);
+        }
+    }
+
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+    return journal;
+}
+
+void session_journal_flush(SessionJournal* journal)
+{
+    if (journal->pendingCount == 0)
+        return;
+
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    if (storage_file_open(file, journal->path, FSAM_WRITE, journal->hasHeader ? FSOM_OPEN_APPEND : FSOM_CREATE_ALWAYS))
+    {
+        if (!journal->hasHeader)
+        {
+            SessionHeader header = {.magic = SESSION_MAGIC, .version = SESSION_VERSION, .reserved = 0, .levelSignature = journal->levelSignature};
+            storage_file_write(file, &header, sizeof(header));
+            journal->hasHeader = true;
+        }
+
+        // The last group is completed with SessionOp_None, so every batch starts on a new group.
+        int groupsCount = (journal->pendingCount + OPS_PER_GROUP - 1) / OPS_PER_GROUP;
+        storage_file_write(file, journal->buffer, groupsCount * GROUP_BYTES);
+    }
+    else
+        FURI_LOG_E("GAME", "Failed to open session journal: %s", journal->path);
+
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+
+    journal->pendingCount = 0;
+    memset(journal->buffer, 0xFF, sizeof(journal->buffer));
+}
+
+void session_journal_close(SessionJournal* journal)
+{
+    session_journal_flush(journal);
+    free(journal);
+}
+
+void session_journal_discard(SessionJournal* journal)
+{
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    storage_common_remove(storage, journal->path);
+    furi_record_close(RECORD_STORAGE);
+    free(journal);
+}
+
+void session_journal_append(SessionJournal* journal, SessionOp op)
+{
+    if (journal->pendingCount == 0)
+        journal->pendingSince = furi_get_tick();
+
+    int index = journal->pendingCount;
+    group_set(journal->buffer + index / OPS_PER_GROUP * GROUP_BYTES, index % OPS_PER_GROUP, op);
+    journal->pendingCount += 1;
+
+    if (journal->pendingCount == SESSION_JOURNAL_BUFFER_OPS)
+        session_journal_flush(journal);
+}
+
+void session_journal_append_seek(SessionJournal* journal, int fromPosition, int toPosition)
+{
+    if (toPosition == fromPosition)
+        return;
+    if (toPosition == fromPosition - 1)
+    {
+        session_journal_append(journal, SessionOp_Undo);
+        return;
+    }
+
+    // A seek is never split between batches, as the padding of a batch would be read as digits of its position.
+    uint32_t position = toPosition;
+    int digitsCount = 1;
+    while (digitsCount < SEEK_MAX_DIGITS && position >> (digitsCount * SEEK_DIGIT_BITS) != 0)
+        digitsCount += 1;
+    if (journal->pendingCount + 1 + digitsCount > SESSION_JOURNAL_BUFFER_OPS)
+        session_journal_flush(journal);
+
+    session_journal_append(journal, SessionOp_Seek);
+    for (int digit = 0; digit < digitsCount; digit++)
+    {
+        SessionOp op = (position >> (digit * SEEK_DIGIT_BITS)) & SEEK_DIGIT_MASK;
+        session_journal_append(journal, digit < digitsCount - 1 ? op | SEEK_DIGIT_MORE : op);
+    }
+}
+
+uint32_t session_journal_pending_age(const SessionJournal* journal)
+{
+    if (journal->pendingCount == 0)
+        return 0;
+    return furi_get_tick() - journal->pendingSince;
+}
+
+int session_journal_replayed_count(const SessionJournal* journal)
+{
+    return journal->replayedCount;
+}
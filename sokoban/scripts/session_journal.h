@@ -0,0 +1,49 @@
+#pragma once
+
+#include "game_state.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Keeps the session of each level on storage, so leaving a level does not lose its progress.
+// The session is kept as an append-only log of what the player did: moves, undos, seeks and the bounds of move groups.
+// Each takes 3 bits, or more for a seek, which carries its target position, and they are written in batches: when the buffer fills, when the game asks for it (see
+// session_journal_flush), and when the session is closed. Opening a session replays the log into a new GameState.
+
+typedef enum SessionOp
+{
+    // Moves share their values with MoveLeft, MoveRight, MoveUp and MoveDown.
+    SessionOp_Left = 0,
+    SessionOp_Right = 1,
+    SessionOp_Up = 2,
+    SessionOp_Down = 3,
+    SessionOp_Undo = 4,
+    SessionOp_Seek = 5, // Followed by the position to seek to, 2 bits per operation, lowest first, with bit 2 set but on the last.
+    SessionOp_MoveGroup = 6, // Begins a move group (see game_state_begin_group), or ends the one begun.
+    SessionOp_None = 7, // Fills the last group of a batch.
+} SessionOp;
+
+// Operations buffered before a batch is written on its own.
+#define SESSION_JOURNAL_BUFFER_OPS 256
+
+typedef struct SessionJournal SessionJournal;
+
+// Opens the session of a level, and replays it into a state that is at the start of the level.
+// A session saved for a different layout of the level is discarded.
+SessionJournal* session_journal_open(const char* collectionName, int levelIndex, GameState* state);
+// Writes the buffered operations, and frees the journal. The session stays on storage for the next time.
+void session_journal_close(SessionJournal* journal);
+// Removes the session from storage, and frees the journal. For levels that are completed.
+void session_journal_discard(SessionJournal* journal);
+
+void session_journal_append(SessionJournal* journal, SessionOp op);
+// Records a move through the history from one position to another, after an undo, a redo or a seek: a single undo, or
+// else a seek, so scrubbing through the history logs the same whatever the distance.
+void session_journal_append_seek(SessionJournal* journal, int fromPosition, int toPosition);
+
+// Writes the buffered operations, if any.
+void session_journal_flush(SessionJournal* journal);
+// Returns the ticks since the oldest buffered operation was appended, or 0 if there are none.
+uint32_t session_journal_pending_age(const SessionJournal* journal);
+
+// Returns the operations replayed when the session was opened.
+int session_journal_replayed_count(const SessionJournal* journal);
@@ -0,0 +1,95 @@
+#include "solutions.h"
+
+#include "collection_index.h"
+#include "wave/files/buffered_reader.h"
+#include <furi.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define READ_BUFFER_SIZE 256
+
+struct SolutionsReader
+{
+    File* file;
+    BufferedReader* buffer;
+    char* solution;
+    int maxLength;
+};
+
+SolutionsReader* solutions_reader_open(Storage* storage, const char* collectionName, int maxLength)
+{
+    char path[256];
+    collection_source_path(path, sizeof(path), collectionName, "lurd");
+
+    File* file = storage_file_alloc(storage);
+    if (!storage_file_open(file, path, FSAM_READ, FSOM_OPEN_EXISTING))
+    {
+        storage_file_free(file);
+        return NULL;
+    }
+
+    SolutionsReader* reader = malloc(sizeof(SolutionsReader));
+    reader->file = file;
+    reader->buffer = bufferedReader_alloc(file, READ_BUFFER_SIZE);
+    reader->solution = malloc(maxLength + 1);
+    reader->maxLength = maxLength;
+    return reader;
+}
+
+void solutions_reader_free(SolutionsReader* reader)
+{
+    buffered_reader_free(reader->buffer);
+    storage_file_free(reader->file);
+    free(reader->solution);
+    free(reader);
+}
+
+bool solutions_reader_next(SolutionsReader* reader, const char** ret_solution)
+{
+    if (buffered_reader_is_eof(reader->buffer))
+        return false;
+
+    // Lines that do not fit are read to their end all the same, so the next read starts at the next level.
+    int length = 0;
+    while (!buffered_reader_is_eof(reader->buffer))
+    {
+        char ch = buffered_reader_read_char(reader->buffer);
+        if (ch == '\n')
+            break;
+        if (ch == '\r')
+            continue;
+        if (length < reader->maxLength)
+            reader->solution[length] = ch;
+        length += 1;
+    }
+
+    reader->solution[MIN(length, reader->maxLength)] = '\0';
+    *ret_solution = length <= reader->maxLength ? reader->solution : NULL;
+    return true;
+}
+
+char* solutions_load(Storage* storage, const char* collectionName, int levelIndex, int maxLength)
+{
+    SolutionsReader* reader = solutions_reader_open(storage, collectionName, maxLength);
+    if (reader == NULL)
+        return NULL;
+
+    const char* solution = NULL;
+    for (int level = 0; level <= levelIndex; level++)
+    {
+        if (!solutions_reader_next(reader, &solution))
+        {
+            solution = NULL;
+            break;
+        }
+    }
+
+    char* copy = NULL;
+    if (solution != NULL && solution[0] != '\0')
+    {
+        copy = malloc(strlen(solution) + 1);
+        strcpy(copy, solution);
+    }
+    solutions_reader_free(reader);
+    return copy;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <stdbool.h>
+#include <storage/storage.h>
+
+// Known solutions of the levels of a collection, kept in the app assets next to the collection, e.g. "microban.lurd":
+// one line per level, in order, with its moves in LURD notation (see game_state_lurd_move), as the level is written in
+// the collection. A level with no known solution has an empty line.
+
+// Longest solution read on the Flipper, in moves.
+#define SOLUTIONS_MAX_LENGTH 4096
+
+typedef struct SolutionsReader SolutionsReader;
+
+// Opens the solutions of a collection, or returns NULL if it has none. Solutions longer than maxLength are skipped.
+SolutionsReader* solutions_reader_open(Storage* storage, const char* collectionName, int maxLength);
+void solutions_reader_free(SolutionsReader* reader);
+
+// Reads the solution of the next level. Returns false past the last level. The solution is NULL if it was longer than
+// the reader allows, and is only valid until the next read.
+bool solutions_reader_next(SolutionsReader* reader, const char** ret_solution);
+
+// Reads the solution of a level, or returns NULL if there is none, or it is longer than maxLength. The caller frees it.
+char* solutions_load(Storage* storage, const char* collectionName, int levelIndex, int maxLength);
@@ -0,0 +1,1230 @@
+#include "solver.h"
+#include "deadlock.h"
+
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NO_CELL LEVEL_NO_FLOOR
+#define NO_NODE 0xFFFFFFFF
+#define DIRECTIONS_COUNT 4
+// The cost of matching a box with a target it can not be pushed to. It is higher than any sum of push distances.
+#define MATCH_NO_PATH (1 << 20)
+// Sets of boxes frozen on targets whose target distances are kept, as positions close in the search mostly share them.
+#define FROZEN_CACHE_SIZE 8
+// The part of the floor a neighbor of a box cell is in, when it is not the root of a subtree (see BoxSides).
+#define PART_NONE -2
+#define PART_PARENT -1
+
+// Floor neighbors are in the same order as the moves of the undo buffer: left, right, up, down.
+static const char DIRECTION_WALKS[DIRECTIONS_COUNT] = {'l', 'r', 'u', 'd'};
+static const char DIRECTION_PUSHES[DIRECTIONS_COUNT] = {'L', 'R', 'U', 'D'};
+
+static int opposite_direction(int direction)
+{
+    return direction ^ 1;
+}
+
+typedef struct SolverNode
+{
+    uint32_t parent;
+    uint16_t player; // Top-left cell of the area the player can reach.
+    uint16_t pushes;
+    uint16_t estimate;
+    uint16_t pushedBox; // Cell of the box pushed from the parent node.
+    uint8_t direction;
+    uint8_t closed;
+} SolverNode;
+
+// Where the player can stand around a box alone on the floor. A box on a cut cell splits the floor into parts, and the
+// player can only push it from the sides next to the part it is in. The parts come from a depth-first search of the floor:
+// each subtree of the box cell with no edge back above it is a part of its own, and the rest of the floor is one more.
+typedef struct BoxSides
+{
+    uint16_t* order; // Preorder number of each floor cell, or SOLVER_DEADLOCK on walls.
+    uint16_t* last; // The last preorder number of the subtree of each floor cell.
+    uint16_t* tree; // The preorder number of the root of the tree of each floor cell, as walls can split the floor.
+    int32_t (*part)[4]; // For each cell and direction, the root of the subtree its neighbor is in if that is a part of its
+                        // own, PART_PARENT for the rest of the floor, or PART_NONE if there is no neighbor.
+} BoxSides;
+
+// Push distances of a box to each target, from each side the player can stand on, for a set of walls. A side stands for
+// its whole part: it is the first direction of the box cell with a neighbor in the part.
+typedef struct TargetDistances
+{
+    BoxSides sides;
+    uint16_t* distance; // [(cell * 4 + side) * targetsCount + target], or SOLVER_DEADLOCK.
+} TargetDistances;
+
+// What the matching heuristic needs. Positions with boxes frozen on targets take those as walls, and their target
+// distances are kept in a cache, whose entries are replaced in turn.
+typedef struct Matching
+{
+    TargetDistances open;
+    int nextEntry;
+    bool isUsed[FROZEN_CACHE_SIZE];
+    uint32_t* frozen[FROZEN_CACHE_SIZE];
+    TargetDistances cached[FROZEN_CACHE_SIZE];
+
+    // Scratch buffers.
+    int* costs; // The costs of every box and target, and the labels of the Hungarian algorithm.
+    uint16_t* targets;
+    uint32_t* boxes;
+    uint32_t* frozenBoxes;
+    uint32_t* queue; // Search states of the target distances, or floor cells of the depth-first search.
+    uint16_t* low;
+    int32_t* parent;
+    uint8_t* nextDirection;
+} Matching;
+
+struct Solver
+{
+    const Level* level;
+    SolverHeuristic heuristic;
+    SolverStatus status;
+
+    LevelFloor floor;
+    uint16_t* pushDistance;
+    uint32_t* targets;
+    int targetsCount;
+    uint16_t* targetCells;
+    int boxWords, boxesCount;
+    int startPlayer;
+
+    int maxNodes, nodesCount, expansionsCount;
+    bool nodesExhausted;
+    uint32_t goalNode;
+    uint32_t bestNode; // The node closest to a solution, by its estimate, other than the starting one.
+    SolverNode* nodes;
+    uint32_t* nodeBoxes;
+    uint32_t* table;
+    uint32_t tableMask;
+    uint32_t* heap; // Open nodes, each once.
+    uint32_t* heapIndex; // For each open node, its index in the heap.
+    int heapCount;
+
+    // Scratch buffers for the expansions.
+    uint16_t* queue;
+    uint32_t* reachStamps;
+    uint32_t stamp;
+    uint32_t* corralStamps;
+    uint32_t corralStamp;
+    uint8_t* parentReach;
+    uint16_t* boxList;
+    uint16_t* parentBoxList;
+    uint32_t* childBoxes;
+    Matching* matching; // Only for the matching heuristic.
+};
+
+static bool bits_get(const uint32_t* bits, int index)
+{
+    return (bits[index / 32] >> (index % 32)) & 1;
+}
+
+static void bits_set(uint32_t* bits, int index)
+{
+    bits[index / 32] |= (uint32_t)1 << (index % 32);
+}
+
+static void bits_clear(uint32_t* bits, int index)
+{
+    bits[index / 32] &= ~((uint32_t)1 << (index % 32));
+}
+
+static uint32_t* node_boxes(const Solver* solver, uint32_t node)
+{
+    return solver->nodeBoxes + (size_t)node * solver->boxWords;
+}
+
+static int box_list(const Solver* solver, const uint32_t* boxes, uint16_t* output)
+{
+    int count = 0;
+    for (int word = 0; word < solver->boxWords; word++)
+    {
+        uint32_t bits = boxes[word];
+        while (bits)
+        {
+            int bit = __builtin_ctz(bits);
+            output[count++] = word * 32 + bit;
+            bits &= bits - 1;
+        }
+    }
+    return count;
+}
+
+// Marks the floor cells the player can reach with the current stamp, and returns the top-left one.
+static int flood_reach(Solver* solver, int start, const uint32_t* boxes)
+{
+    solver->stamp += 1;
+    int head = 0, tail = 0, topLeft = start;
+    solver->queue[tail++] = start;
+    solver->reachStamps[start] = solver->stamp;
+    while (head < tail)
+    {
+        int cell = solver->queue[head++];
+        if (cell < topLeft)
+            topLeft = cell;
+        for (int direction = 0; direction < DIRECTIONS_COUNT; direction++)
+        {
+            int next = solver->floor.neighbors[cell][direction];
+            if (next == NO_CELL || solver->reachStamps[next] == solver->stamp || bits_get(boxes, next))
+                continue;
+            solver->reachStamps[next] = solver->stamp;
+            solver->queue[tail++] = next;
+        }
+    }
+    return topLeft;
+}
+
+static void compute_push_distances(Solver* solver)
+{
+    solver->pushDistance = malloc(solver->floor.count * sizeof(uint16_t));
+    uint16_t* queue = malloc(solver->floor.count * sizeof(uint16_t));
+    int head = 0, tail = 0;
+
+    for (int floor = 0; floor < solver->floor.count; floor++)
+    {
+        solver->pushDistance[floor] = SOLVER_DEADLOCK;
+        if (bits_get(solver->targets, floor))
+        {
+            solver->pushDistance[floor] = 0;
+            queue[tail++] = floor;
+        }
+    }
+
+    while (head < tail)
+    {
+        int box = queue[head++];
+        for (int direction = 0; direction < DIRECTIONS_COUNT; direction++)
+        {
+            // Pulling the box one cell in this direction: the player stands there and steps one cell further.
+            int pulledTo = solver->floor.neighbors[box][direction];
+            if (pulledTo == NO_CELL || solver->floor.neighbors[pulledTo][direction] == NO_CELL)
+                continue;
+            if (solver->pushDistance[pulledTo] != SOLVER_DEADLOCK)
+                continue;
+            solver->pushDistance[pulledTo] = solver->pushDistance[box] + 1;
+            queue[tail++] = pulledTo;
+        }
+    }
+
+    free(queue);
+}
+
+static uint32_t hash_position(const Solver* solver, const uint32_t* boxes, int player)
+{
+    uint32_t hash = 2166136261u ^ player;
+    for (int word = 0; word < solver->boxWords; word++)
+    {
+        hash ^= boxes[word];
+        hash *= 16777619u;
+        hash ^= hash >> 15;
+    }
+    return hash;
+}
+
+// Returns the slot of a position in the transposition table: either the slot holding it, or the empty slot where it belongs.
+static uint32_t table_find(const Solver* solver, const uint32_t* boxes, int player)
+{
+    uint32_t slot = hash_position(solver, boxes, player) & solver->tableMask;
+    while (solver->table[slot] != NO_NODE)
+    {
+        uint32_t node = solver->table[slot];
+        if (solver->nodes[node].player == player && memcmp(node_boxes(solver, node), boxes, solver->boxWords * sizeof(uint32_t)) == 0)
+            return slot;
+        slot = (slot + 1) & solver->tableMask;
+    }
+    return slot;
+}
+
+static bool heap_less(const Solver* solver, uint32_t a, uint32_t b)
+{
+    const SolverNode* nodeA = &solver->nodes[a];
+    const SolverNode* nodeB = &solver->nodes[b];
+    int costA = nodeA->pushes + nodeA->estimate, costB = nodeB->pushes + nodeB->estimate;
+    if (costA != costB)
+        return costA < costB;
+    return nodeA->pushes > nodeB->pushes;
+}
+
+// Moves a node up the heap from an index, to where its cost belongs.
+static void heap_sift_up(Solver* solver, uint32_t node, int index)
+{
+    while (index > 0)
+    {
+        int parent = (index - 1) / 2;
+        if (!heap_less(solver, node, solver->heap[parent]))
+            break;
+        solver->heap[index] = solver->heap[parent];
+        solver->heapIndex[solver->heap[index]] = index;
+        index = parent;
+    }
+    solver->heap[index] = node;
+    solver->heapIndex[node] = index;
+}
+
+static void heap_push(Solver* solver, uint32_t node)
+{
+    heap_sift_up(solver, node, solver->heapCount++);
+}
+
+// Moves an open node up the heap once its pushes are lowered. Its cost must not change while it is in the heap otherwise,
+// or nodes further up could be taken for cheaper than it.
+static void heap_decrease(Solver* solver, uint32_t node)
+{
+    heap_sift_up(solver, node, solver->heapIndex[node]);
+}
+
+static uint32_t heap_pop(Solver* solver)
+{
+    uint32_t top = solver->heap[0];
+    uint32_t last = solver->heap[--solver->heapCount];
+    int index = 0;
+    while (true)
+    {
+        int child = index * 2 + 1;
+        if (child >= solver->heapCount)
+            break;
+        if (child + 1 < solver->heapCount && heap_less(solver, solver->heap[child + 1], solver->heap[child]))
+            child += 1;
+        if (!heap_less(solver, solver->heap[child], last))
+            break;
+        solver->heap[index] = solver->heap[child];
+        solver->heapIndex[solver->heap[index]] = index;
+        index = child;
+    }
+    if (solver->heapCount > 0)
+    {
+        solver->heap[index] = last;
+        solver->heapIndex[last] = index;
+    }
+    return top;
+}
+
+static bool is_solved(const Solver* solver, const uint32_t* boxes)
+{
+    for (int word = 0; word < solver->boxWords; word++)
+        if (boxes[word] & ~solver->targets[word])
+            return false;
+    return true;
+}
+
+// Adds a position reached from a parent node, unless it is already known with fewer pushes.
+static void add_position(Solver* solver, uint32_t parent, const uint32_t* boxes, int player, int pushedBox, int direction)
+{
+    int pushes = parent == NO_NODE ? 0 : solver->nodes[parent].pushes + 1;
+
+    uint32_t slot = table_find(solver, boxes, player);
+    uint32_t node = solver->table[slot];
+    if (node != NO_NODE)
+    {
+        SolverNode* known = &solver->nodes[node];
+        if (known->closed || known->pushes <= pushes)
+            return;
+        known->pushes = pushes;
+        known->parent = parent;
+        known->pushedBox = pushedBox;
+        known->direction = direction;
+        heap_decrease(solver, node);
+        return;
+    }
+
+    int boxesCount = box_list(solver, boxes, solver->boxList);
+    int estimate = solver->heuristic(solver, solver->boxList, boxesCount, player);
+    if (estimate >= SOLVER_DEADLOCK)
+        return;
+
+    if (solver->nodesCount >= solver->maxNodes)
+    {
+        solver->nodesExhausted = true;
+        return;
+    }
+
+    node = solver->nodesCount++;
+    SolverNode* added = &solver->nodes[node];
+    added->parent = parent;
+    added->player = player;
+    added->pushes = pushes;
+    added->estimate = estimate;
+    added->pushedBox = pushedBox;
+    added->direction = direction;
+    added->closed = false;
+    memcpy(node_boxes(solver, node), boxes, solver->boxWords * sizeof(uint32_t));
+
+    solver->table[slot] = node;
+    heap_push(solver, node);
+
+    if (parent != NO_NODE)
+    {
+        const SolverNode* best = solver->bestNode == NO_NODE ? NULL : &solver->nodes[solver->bestNode];
+        if (best == NULL || estimate < best->estimate || (estimate == best->estimate && pushes < best->pushes))
+            solver->bestNode = node;
+    }
+}
+
+// Freeze deadlocks are found by deadlock_is_cell_frozen, over floor cells. Walls are the missing neighbors.
+typedef struct SolverPosition
+{
+    const Solver* solver;
+    const uint32_t* boxes;
+} SolverPosition;
+
+static int solver_position_neighbor(const void* position, int cell, int direction)
+{
+    return ((const SolverPosition*)position)->solver->floor.neighbors[cell][direction];
+}
+
+static bool solver_position_has_box(const void* position, int cell)
+{
+    return bits_get(((const SolverPosition*)position)->boxes, cell);
+}
+
+static bool solver_position_is_dead_square(const void* position, int cell)
+{
+    return ((const SolverPosition*)position)->solver->pushDistance[cell] == SOLVER_DEADLOCK;
+}
+
+static bool solver_position_has_target(const void* position, int cell)
+{
+    return bits_get(((const SolverPosition*)position)->solver->targets, cell);
+}
+
+static const FreezeLookups SOLVER_FREEZE_LOOKUPS = {
+    .neighbor = solver_position_neighbor,
+    .has_box = solver_position_has_box,
+    .is_dead_square = solver_position_is_dead_square,
+    .has_target = solver_position_has_target,
+};
+
+static bool is_freeze_deadlock(const Solver* solver, const uint32_t* boxes, int pushedBox)
+{
+    SolverPosition position = {.solver = solver, .boxes = boxes};
+    bool offTarget;
+    return deadlock_is_cell_frozen(&SOLVER_FREEZE_LOOKUPS, &position, pushedBox, &offTarget) && offTarget;
+}
+
+// Returns whether every push of the fence boxes of a corral goes into the corral, and can be made from where the player
+// stands. The corral cells and its fence boxes hold its stamp. Pushes from inside the corral can not be made before a
+// fence box moves, and neither can pushes into another fence box.
+static bool is_pi_corral(const Solver* solver, const uint32_t* boxes, const uint16_t* boxList, int boxesCount, uint32_t corral)
+{
+    for (int i = 0; i < boxesCount; i++)
+    {
+        int box = boxList[i];
+        if (solver->corralStamps[box] != corral)
+            continue;
+        for (int direction = 0; direction < DIRECTIONS_COUNT; direction++)
+        {
+            int from = solver->floor.neighbors[box][opposite_direction(direction)];
+            int to = solver->floor.neighbors[box][direction];
+            if (from == NO_CELL || to == NO_CELL || solver->corralStamps[from] == corral)
+                continue;
+            if (solver->corralStamps[to] != corral)
+                return false;
+            if (!bits_get(boxes, to) && !solver->parentReach[from])
+                return false;
+        }
+    }
+    return true;
+}
+
+// Looks for a PI-corral: an area the player can not reach, whose fence boxes can only be pushed into it, all of them from
+// where the player stands, and that is not solved yet. Some fence box must be pushed before the level is solved, and
+// nothing else can reach the corral before one is, so a solution can start with one of these pushes without taking
+// more pushes. Only they need to be expanded. Returns the stamp of the corral, or 0 if there is none.
+static uint32_t find_pi_corral(Solver* solver, const uint32_t* boxes, const uint16_t* boxList, int boxesCount)
+{
+    int floorCount = solver->floor.count;
+    if (solver->corralStamp > UINT32_MAX - floorCount)
+    {
+        memset(solver->corralStamps, 0, floorCount * sizeof(uint32_t));
+        solver->corralStamp = 0;
+    }
+
+    uint32_t firstCorral = solver->corralStamp + 1;
+    for (int start = 0; start < floorCount; start++)
+    {
+        if (solver->parentReach[start] || bits_get(boxes, start) || solver->corralStamps[start] >= firstCorral)
+            continue;
+
+        uint32_t corral = ++solver->corralStamp;
+        bool isSolved = true;
+        int head = 0, tail = 0;
+        solver->queue[tail++] = start;
+        solver->corralStamps[start] = corral;
+        while (head < tail)
+        {
+            int cell = solver->queue[head++];
+            if (bits_get(solver->targets, cell))
+                isSolved = false;
+            for (int direction = 0; direction < DIRECTIONS_COUNT; direction++)
+            {
+                int next = solver->floor.neighbors[cell][direction];
+                if (next == NO_CELL || solver->corralStamps[next] == corral)
+                    continue;
+                solver->corralStamps[next] = corral;
+                if (bits_get(boxes, next))
+                {
+                    if (!bits_get(solver->targets, next))
+                        isSolved = false;
+                }
+                else
+                    solver->queue[tail++] = next;
+            }
+        }
+
+        if (!isSolved && is_pi_corral(solver, boxes, boxList, boxesCount, corral))
+            return corral;
+    }
+    return 0;
+}
+
+static void expand(Solver* solver, uint32_t node)
+{
+    const uint32_t* boxes = node_boxes(solver, node);
+    int player = solver->nodes[node].player;
+
+    flood_reach(solver, player, boxes);
+    for (int floor = 0; floor < solver->floor.count; floor++)
+        solver->parentReach[floor] = solver->reachStamps[floor] == solver->stamp;
+
+    int boxesCount = box_list(solver, boxes, solver->parentBoxList);
+    uint32_t corral = find_pi_corral(solver, boxes, solver->parentBoxList, boxesCount);
+    for (int i = 0; i < boxesCount; i++)
+    {
+        int box = solver->parentBoxList[i];
+        if (corral != 0 && solver->corralStamps[box] != corral)
+            continue;
+        for (int direction = 0; direction < DIRECTIONS_COUNT; direction++)
+        {
+            int from = solver->floor.neighbors[box][opposite_direction(direction)];
+            int to = solver->floor.neighbors[box][direction];
+            if (from == NO_CELL || to == NO_CELL || !solver->parentReach[from] || bits_get(boxes, to))
+                continue;
+            if (solver->pushDistance[to] == SOLVER_DEADLOCK)
+                continue;
+
+            memcpy(solver->childBoxes, boxes, solver->boxWords * sizeof(uint32_t));
+            bits_clear(solver->childBoxes, box);
+            bits_set(solver->childBoxes, to);
+            if (is_freeze_deadlock(solver, solver->childBoxes, to))
+                continue;
+
+            int childPlayer = flood_reach(solver, box, solver->childBoxes);
+            add_position(solver, node, solver->childBoxes, childPlayer, box, direction);
+        }
+    }
+}
+
+static bool is_open(const uint32_t* walls, int cell)
+{
+    return cell != NO_CELL && (walls == NULL || !bits_get(walls, cell));
+}
+
+// Finds the parts of the floor around every cell, without the walls, with an iterative depth-first search from each cell
+// not found yet. A subtree is a part of its own if none of its cells has an edge to a cell found before its parent.
+static void find_box_sides(const Solver* solver, const uint32_t* walls, BoxSides* sides)
+{
+    Matching* matching = solver->matching;
+    int floorCount = solver->floor.count, order = 0;
+    for (int floor = 0; floor < floorCount; floor++)
+        sides->order[floor] = SOLVER_DEADLOCK;
+
+    for (int root = 0; root < floorCount; root++)
+    {
+        if (!is_open(walls, root) || sides->order[root] != SOLVER_DEADLOCK)
+            continue;
+        int top = 0;
+        matching->queue[top++] = root;
+        matching->parent[root] = NO_CELL;
+        matching->nextDirection[root] = 0;
+        sides->order[root] = matching->low[root] = order++;
+        sides->tree[root] = sides->order[root];
+        while (top > 0)
+        {
+            int cell = matching->queue[top - 1];
+            if (matching->nextDirection[cell] < DIRECTIONS_COUNT)
+            {
+                int next = solver->floor.neighbors[cell][matching->nextDirection[cell]++];
+                if (!is_open(walls, next))
+                    continue;
+                if (sides->order[next] == SOLVER_DEADLOCK)
+                {
+                    matching->parent[next] = cell;
+                    matching->nextDirection[next] = 0;
+                    sides->order[next] = matching->low[next] = order++;
+                    sides->tree[next] = sides->order[root];
+                    matching->queue[top++] = next;
+                }
+                else if (next != matching->parent[cell] && sides->order[next] < matching->low[cell])
+                    matching->low[cell] = sides->order[next];
+                continue;
+            }
+
+            top -= 1;
+            sides->last[cell] = order - 1;
+            int parent = matching->parent[cell];
+            if (parent != NO_CELL && matching->low[cell] < matching->low[parent])
+                matching->low[parent] = matching->low[cell];
+        }
+    }
+
+    for (int floor = 0; floor < floorCount; floor++)
+    {
+        for (int direction = 0; direction < DIRECTIONS_COUNT; direction++)
+        {
+            int next = solver->floor.neighbors[floor][direction];
+            int32_t part = PART_NONE;
+            if (is_open(walls, floor) && is_open(walls, next))
+            {
+                part = PART_PARENT;
+                if (sides->order[next] > sides->order[floor] && sides->order[next] <= sides->last[floor])
+                {
+                    int child = next;
+                    while (matching->parent[child] != floor)
+                        child = matching->parent[child];
+                    if (matching->low[child] >= sides->order[floor])
+                        part = child;
+                }
+            }
+            sides->part[floor][direction] = part;
+        }
+    }
+}
+
+// Returns the first side of a box cell with a neighbor in the same part as the given side.
+static int first_side(const BoxSides* sides, int box, int side)
+{
+    int first = 0;
+    while (sides->part[box][first] != sides->part[box][side])
+        first += 1;
+    return first;
+}
+
+// Returns the side of a box cell next to the part the player is in, or -1 if walls keep the player away from the box.
+static int player_side(const BoxSides* sides, int box, int player)
+{
+    if (sides->tree[player] != sides->tree[box])
+        return -1;
+
+    int32_t part = PART_PARENT;
+    for (int direction = 0; direction < DIRECTIONS_COUNT; direction++)
+    {
+        int32_t child = sides->part[box][direction];
+        if (child >= 0 && sides->order[child] <= sides->order[player] && sides->order[player] <= sides->last[child])
+            part = child;
+    }
+    for (int direction = 0; direction < DIRECTIONS_COUNT; direction++)
+        if (sides->part[box][direction] == part)
+            return direction;
+    return -1;
+}
+
+// Breadth-first search of box pulls from each target, over the cells of the box and the sides of the player. A push moves
+// the box one cell and leaves the player where the box was, so a pull comes from a side of the box only if the cell it
+// pulls the box to is in the part of that side. Cells of walls, if any, can hold neither the box nor the player.
+static void compute_target_distances(const Solver* solver, const uint32_t* walls, TargetDistances* distances)
+{
+    const BoxSides* sides = &distances->sides;
+    uint32_t* queue = solver->matching->queue;
+    int targetsCount = solver->targetsCount;
+    find_box_sides(solver, walls, &distances->sides);
+    for (size_t i = 0; i < (size_t)solver->floor.count * DIRECTIONS_COUNT * targetsCount; i++)
+        distances->distance[i] = SOLVER_DEADLOCK;
+
+    for (int target = 0; target < targetsCount; target++)
+    {
+        int targetCell = solver->targetCells[target];
+        if (!is_open(walls, targetCell))
+            continue;
+        uint16_t* distance = distances->distance + target;
+        int head = 0, tail = 0;
+        for (int side = 0; side < DIRECTIONS_COUNT; side++)
+        {
+            if (sides->part[targetCell][side] == PART_NONE || first_side(sides, targetCell, side) != side)
+                continue;
+            distance[(targetCell * DIRECTIONS_COUNT + side) * targetsCount] = 0;
+            queue[tail++] = targetCell * DIRECTIONS_COUNT + side;
+        }
+
+        while (head < tail)
+        {
+            int state = queue[head++];
+            int box = state / DIRECTIONS_COUNT, side = state % DIRECTIONS_COUNT;
+            for (int direction = 0; direction < DIRECTIONS_COUNT; direction++)
+            {
+                // Pulling the box one cell in this direction: the player stands there and steps one cell further.
+                int pulledTo = solver->floor.neighbors[box][direction];
+                if (!is_open(walls, pulledTo) || sides->part[box][direction] != sides->part[box][side])
+                    continue;
+                if (!is_open(walls, solver->floor.neighbors[pulledTo][direction]))
+                    continue;
+                int pulledState = pulledTo * DIRECTIONS_COUNT + first_side(sides, pulledTo, direction);
+                if (distance[pulledState * targetsCount] != SOLVER_DEADLOCK)
+                    continue;
+                distance[pulledState * targetsCount] = distance[state * targetsCount] + 1;
+                queue[tail++] = pulledState;
+            }
+        }
+    }
+}
+
+static void target_distances_alloc(TargetDistances* distances, int floorCount, int targetsCount)
+{
+    distances->sides.order = malloc(floorCount * sizeof(uint16_t));
+    distances->sides.last = malloc(floorCount * sizeof(uint16_t));
+    distances->sides.tree = malloc(floorCount * sizeof(uint16_t));
+    distances->sides.part = malloc(floorCount * sizeof(*distances->sides.part));
+    distances->distance = malloc((size_t)floorCount * DIRECTIONS_COUNT * targetsCount * sizeof(uint16_t));
+}
+
+static void target_distances_free(TargetDistances* distances)
+{
+    free(distances->sides.order);
+    free(distances->sides.last);
+    free(distances->sides.tree);
+    free(distances->sides.part);
+    free(distances->distance);
+}
+
+static size_t target_distances_size(int floorCount, int targetsCount)
+{
+    return floorCount * (3 * sizeof(uint16_t) + DIRECTIONS_COUNT * sizeof(int32_t)) + (size_t)floorCount * DIRECTIONS_COUNT * targetsCount * sizeof(uint16_t);
+}
+
+// The Hungarian algorithm keeps the costs of every box and target, and labels of the boxes and targets.
+static size_t match_costs_count(int boxesCount, int targetsCount)
+{
+    return (size_t)boxesCount * targetsCount + (boxesCount + 1) + (targetsCount + 1) * 5;
+}
+
+// The memory of the matching heuristic, without its few bytes per box.
+static size_t matching_memory_size(int floorCount, int boxWords, int boxesCount, int targetsCount)
+{
+    size_t perFloor = sizeof(uint32_t) * DIRECTIONS_COUNT + sizeof(uint16_t) + sizeof(int32_t) + 1;
+    return sizeof(Matching) + (1 + FROZEN_CACHE_SIZE) * target_distances_size(floorCount, targetsCount) + floorCount * perFloor +
+           match_costs_count(boxesCount, targetsCount) * sizeof(int) + (2 + FROZEN_CACHE_SIZE) * boxWords * sizeof(uint32_t);
+}
+
+static void matching_alloc(Solver* solver)
+{
+    int floorCount = solver->floor.count, targetsCount = solver->targetsCount;
+    Matching* matching = calloc(1, sizeof(Matching));
+    solver->matching = matching;
+    matching->costs = malloc(match_costs_count(solver->boxesCount, targetsCount) * sizeof(int));
+    matching->targets = malloc((targetsCount + 1) * sizeof(uint16_t));
+    matching->boxes = malloc(solver->boxWords * sizeof(uint32_t));
+    matching->frozenBoxes = malloc(solver->boxWords * sizeof(uint32_t));
+    matching->queue = malloc(floorCount * DIRECTIONS_COUNT * sizeof(uint32_t));
+    matching->low = malloc(floorCount * sizeof(uint16_t));
+    matching->parent = malloc(floorCount * sizeof(int32_t));
+    matching->nextDirection = malloc(floorCount);
+    target_distances_alloc(&matching->open, floorCount, targetsCount);
+    for (int entry = 0; entry < FROZEN_CACHE_SIZE; entry++)
+    {
+        matching->frozen[entry] = malloc(solver->boxWords * sizeof(uint32_t));
+        target_distances_alloc(&matching->cached[entry], floorCount, targetsCount);
+    }
+    compute_target_distances(solver, NULL, &matching->open);
+}
+
+static void matching_free(Matching* matching)
+{
+    free(matching->costs);
+    free(matching->targets);
+    free(matching->boxes);
+    free(matching->frozenBoxes);
+    free(matching->queue);
+    free(matching->low);
+    free(matching->parent);
+    free(matching->nextDirection);
+    target_distances_free(&matching->open);
+    for (int entry = 0; entry < FROZEN_CACHE_SIZE; entry++)
+    {
+        free(matching->frozen[entry]);
+        target_distances_free(&matching->cached[entry]);
+    }
+    free(matching);
+}
+
+Solver* solver_alloc(const GameState* state, int maxNodes, SolverHeuristic heuristic)
+{
+    Solver* solver = malloc(sizeof(Solver));
+    memset(solver, 0, sizeof(Solver));
+    solver->level = state->level;
+    solver->heuristic = heuristic;
+    solver->status = SolverStatus_Running;
+    solver->goalNode = NO_NODE;
+    solver->bestNode = NO_NODE;
+
+    level_floor_init(&solver->floor, solver->level);
+
+    solver->boxWords = (solver->floor.count + 31) / 32;
+    solver->targets = calloc(solver->boxWords, sizeof(uint32_t));
+    uint32_t* startBoxes = calloc(solver->boxWords, sizeof(uint32_t));
+    const Level* level = solver->level;
+    for (int y = 0; y < level->level_height; y++)
+    {
+        for (int x = 0; x < level->level_width; x++)
+        {
+            int floor = solver->floor.cellToFloor[y * level->level_width + x];
+            bool hasBox = box_layer_has_box(&level->board, &state->boxes, x, y);
+            if (floor == NO_CELL)
+            {
+                // A box outside the player area can never be moved, so it must already be on its target.
+                if (hasBox && !board_has_target(&level->board, x, y))
+                    solver->status = SolverStatus_Unsolvable;
+                continue;
+            }
+            if (board_has_target(&level->board, x, y))
+            {
+                bits_set(solver->targets, floor);
+                solver->targetsCount += 1;
+            }
+            if (hasBox)
+            {
+                bits_set(startBoxes, floor);
+                solver->boxesCount += 1;
+            }
+        }
+    }
+
+    // Boxes off the floor are all on targets, so the floor must have a target for each of its boxes.
+    if (solver->boxesCount > solver->targetsCount)
+        solver->status = SolverStatus_Unsolvable;
+    solver->targetCells = malloc((solver->targetsCount + 1) * sizeof(uint16_t));
+    box_list(solver, solver->targets, solver->targetCells);
+    compute_push_distances(solver);
+
+    solver->maxNodes = maxNodes;
+    solver->nodes = malloc(maxNodes * sizeof(SolverNode));
+    solver->nodeBoxes = malloc((size_t)maxNodes * solver->boxWords * sizeof(uint32_t));
+    uint32_t tableSize = 1;
+    while (tableSize < (uint32_t)maxNodes * 2)
+        tableSize *= 2;
+    solver->table = malloc(tableSize * sizeof(uint32_t));
+    memset(solver->table, 0xFF, tableSize * sizeof(uint32_t));
+    solver->tableMask = tableSize - 1;
+    solver->heap = malloc(maxNodes * sizeof(uint32_t));
+    solver->heapIndex = malloc(maxNodes * sizeof(uint32_t));
+
+    solver->queue = malloc(solver->floor.count * sizeof(uint16_t));
+    solver->reachStamps = calloc(solver->floor.count, sizeof(uint32_t));
+    solver->parentReach = malloc(solver->floor.count);
+    solver->corralStamps = calloc(solver->floor.count, sizeof(uint32_t));
+    solver->boxList = malloc((solver->boxesCount + 1) * sizeof(uint16_t));
+    solver->parentBoxList = malloc((solver->boxesCount + 1) * sizeof(uint16_t));
+    solver->childBoxes = malloc(solver->boxWords * sizeof(uint32_t));
+    if (heuristic == solver_heuristic_matching && solver->status == SolverStatus_Running)
+        matching_alloc(solver);
+
+    int playerCell = state->playerY * level->level_width + state->playerX;
+    solver->startPlayer = solver->floor.cellToFloor[playerCell];
+    if (solver->status == SolverStatus_Running)
+    {
+        int player = flood_reach(solver, solver->startPlayer, startBoxes);
+        add_position(solver, NO_NODE, startBoxes, player, 0, 0);
+    }
+    free(startBoxes);
+
+    return solver;
+}
+
+void solver_free(Solver* solver)
+{
+    level_floor_free(&solver->floor);
+    free(solver->pushDistance);
+    free(solver->targets);
+    free(solver->targetCells);
+    free(solver->nodes);
+    free(solver->nodeBoxes);
+    free(solver->table);
+    free(solver->heap);
+    free(solver->heapIndex);
+    free(solver->queue);
+    free(solver->reachStamps);
+    free(solver->parentReach);
+    free(solver->corralStamps);
+    free(solver->boxList);
+    free(solver->parentBoxList);
+    free(solver->childBoxes);
+    if (solver->matching != NULL)
+        matching_free(solver->matching);
+    free(solver);
+}
+
+SolverStatus solver_run(Solver* solver, int maxExpansions)
+{
+    for (int expansions = 0; solver->status == SolverStatus_Running && (maxExpansions == 0 || expansions < maxExpansions); expansions++)
+    {
+        if (solver->heapCount == 0)
+        {
+            solver->status = solver->nodesExhausted ? SolverStatus_OutOfMemory : SolverStatus_Unsolvable;
+            break;
+        }
+
+        uint32_t node = heap_pop(solver);
+        solver->nodes[node].closed = true;
+        solver->expansionsCount += 1;
+
+        if (is_solved(solver, node_boxes(solver, node)))
+        {
+            solver->goalNode = node;
+            solver->status = SolverStatus_Solved;
+            break;
+        }
+
+        expand(solver, node);
+    }
+    return solver->status;
+}
+
+SolverStatus solver_status(const Solver* solver)
+{
+    return solver->status;
+}
+
+int solver_nodes_count(const Solver* solver)
+{
+    return solver->nodesCount;
+}
+
+int solver_expansions_count(const Solver* solver)
+{
+    return solver->expansionsCount;
+}
+
+size_t solver_memory_size(const Solver* solver)
+{
+    int cellsCount = solver->level->level_width * solver->level->level_height;
+    size_t perNode = sizeof(SolverNode) + solver->boxWords * sizeof(uint32_t) + 2 * sizeof(uint32_t);
+    size_t perFloor = sizeof(uint16_t) * 3 + sizeof(*solver->floor.neighbors) + sizeof(uint32_t) * 2 + 1;
+    size_t size = sizeof(Solver) + (size_t)solver->maxNodes * perNode + (solver->tableMask + 1) * sizeof(uint32_t) + solver->floor.count * perFloor + cellsCount * sizeof(int32_t);
+    if (solver->matching != NULL)
+        size += matching_memory_size(solver->floor.count, solver->boxWords, solver->boxesCount, solver->targetsCount);
+    return size;
+}
+
+int solver_max_nodes_for_memory(const Level* level, SolverHeuristic heuristic, size_t bytes)
+{
+    // Upper bounds: every cell taken as floor, and a transposition table twice as big as it can get.
+    int cellsCount = level->level_width * level->level_height;
+    // The flood fill queue of the floor is freed before the scratch queue is allocated.
+    size_t perCell = sizeof(uint16_t) + sizeof(uint32_t) * 2 + 1;
+    size_t fixed = sizeof(Solver) + level_floor_max_memory(level) + cellsCount * perCell;
+    if (heuristic == solver_heuristic_matching)
+    {
+        // The matching is only made when there are no more boxes than targets.
+        int targetsCount = 0;
+        for (int y = 0; y < level->level_height; y++)
+            for (int x = 0; x < level->level_width; x++)
+                if (board_has_target(&level->board, x, y))
+                    targetsCount += 1;
+        fixed += matching_memory_size(cellsCount, (cellsCount + 31) / 32, targetsCount, targetsCount);
+    }
+    size_t perNode = sizeof(SolverNode) + (cellsCount + 31) / 32 * sizeof(uint32_t) + 2 * sizeof(uint32_t) + 4 * sizeof(uint32_t);
+    if (bytes <= fixed)
+        return 0;
+    return (bytes - fixed) / perNode;
+}
+
+int solver_floor_cells_count(const Solver* solver)
+{
+    return solver->floor.count;
+}
+
+int solver_push_distance(const Solver* solver, int floorCell)
+{
+    return solver->pushDistance[floorCell];
+}
+
+int solver_heuristic_none(const Solver* solver, const uint16_t* boxCells, int boxesCount, int player)
+{
+    (void)solver;
+    (void)boxCells;
+    (void)boxesCount;
+    (void)player;
+    return 0;
+}
+
+int solver_heuristic_push_distance(const Solver* solver, const uint16_t* boxCells, int boxesCount, int player)
+{
+    (void)player;
+    int estimate = 0;
+    for (int i = 0; i < boxesCount; i++)
+    {
+        int distance = solver->pushDistance[boxCells[i]];
+        if (distance == SOLVER_DEADLOCK)
+            return SOLVER_DEADLOCK;
+        estimate += distance;
+    }
+    return estimate;
+}
+
+// Returns the least sum of the costs of a matching of every box with a target of its own, or SOLVER_DEADLOCK if every
+// matching has a box that can not reach its target. The costs are given as boxesCount rows of targetsCount columns at
+// the start of the buffer. This is the Hungarian algorithm, adding the boxes one at a time along shortest augmenting
+// paths. Boxes and targets are numbered from 1 here, and target 0 stands for the box being added.
+static int match_boxes(int* buffer, int boxesCount, int targetsCount)
+{
+    const int* cost = buffer;
+    int* boxLabel = buffer + boxesCount * targetsCount;
+    int* targetLabel = boxLabel + boxesCount + 1;
+    int* targetBox = targetLabel + targetsCount + 1;
+    int* previousTarget = targetBox + targetsCount + 1;
+    int* slack = previousTarget + targetsCount + 1;
+    int* isTargetVisited = slack + targetsCount + 1;
+    memset(boxLabel, 0, (boxesCount + 1) * sizeof(int));
+    memset(targetLabel, 0, (targetsCount + 1) * sizeof(int));
+    memset(targetBox, 0, (targetsCount + 1) * sizeof(int));
+
+    for (int box = 1; box <= boxesCount; box++)
+    {
+        targetBox[0] = box;
+        int target = 0;
+        for (int j = 0; j <= targetsCount; j++)
+        {
+            slack[j] = INT_MAX;
+            isTargetVisited[j] = false;
+        }
+        do
+        {
+            isTargetVisited[target] = true;
+            int from = targetBox[target], delta = INT_MAX, next = 0;
+            for (int j = 1; j <= targetsCount; j++)
+            {
+                if (isTargetVisited[j])
+                    continue;
+                int reduced = cost[(from - 1) * targetsCount + j - 1] - boxLabel[from] - targetLabel[j];
+                if (reduced < slack[j])
+                {
+                    slack[j] = reduced;
+                    previousTarget[j] = target;
+                }
+                if (slack[j] < delta)
+                {
+                    delta = slack[j];
+                    next = j;
+                }
+            }
+            for (int j = 0; j <= targetsCount; j++)
+            {
+                if (isTargetVisited[j])
+                {
+                    boxLabel[targetBox[j]] += delta;
+                    targetLabel[j] -= delta;
+                }
+                else
+                    slack[j] -= delta;
+            }
+            target = next;
+        } while (targetBox[target] != 0);
+
+        do
+        {
+            int previous = previousTarget[target];
+            targetBox[target] = targetBox[previous];
+            target = previous;
+        } while (target != 0);
+    }
+
+    int estimate = 0;
+    for (int target = 1; target <= targetsCount; target++)
+    {
+        if (targetBox[target] == 0)
+            continue;
+        int pairCost = cost[(targetBox[target] - 1) * targetsCount + target - 1];
+        if (pairCost == MATCH_NO_PATH)
+            return SOLVER_DEADLOCK;
+        estimate += pairCost;
+    }
+    return estimate < SOLVER_DEADLOCK ? estimate : SOLVER_DEADLOCK;
+}
+
+// Returns the target distances with the given boxes as walls, from the cache or computed into it.
+static const TargetDistances* frozen_target_distances(const Solver* solver, const uint32_t* frozen)
+{
+    Matching* matching = solver->matching;
+    size_t frozenSize = solver->boxWords * sizeof(uint32_t);
+    for (int entry = 0; entry < FROZEN_CACHE_SIZE; entry++)
+        if (matching->isUsed[entry] && memcmp(matching->frozen[entry], frozen, frozenSize) == 0)
+            return &matching->cached[entry];
+
+    int entry = matching->nextEntry;
+    matching->nextEntry = (entry + 1) % FROZEN_CACHE_SIZE;
+    matching->isUsed[entry] = true;
+    memcpy(matching->frozen[entry], frozen, frozenSize);
+    compute_target_distances(solver, frozen, &matching->cached[entry]);
+    return &matching->cached[entry];
+}
+
+int solver_heuristic_matching(const Solver* solver, const uint16_t* boxCells, int boxesCount, int player)
+{
+    // Boxes frozen on targets never move again: they are walls to the other boxes and to the player, and their targets are
+    // taken. Targets they fence off can then be found unreachable.
+    Matching* matching = solver->matching;
+    uint32_t* boxes = matching->boxes;
+    uint32_t* frozen = matching->frozenBoxes;
+    memset(boxes, 0, solver->boxWords * sizeof(uint32_t));
+    memset(frozen, 0, solver->boxWords * sizeof(uint32_t));
+    for (int box = 0; box < boxesCount; box++)
+    {
+        if (solver->pushDistance[boxCells[box]] == SOLVER_DEADLOCK)
+            return SOLVER_DEADLOCK;
+        bits_set(boxes, boxCells[box]);
+    }
+
+    SolverPosition position = {.solver = solver, .boxes = boxes};
+    bool hasFrozen = false;
+    for (int box = 0; box < boxesCount; box++)
+    {
+        if (bits_get(solver->targets, boxCells[box]) && deadlock_is_cell_frozen(&SOLVER_FREEZE_LOOKUPS, &position, boxCells[box], NULL))
+        {
+            bits_set(frozen, boxCells[box]);
+            hasFrozen = true;
+        }
+    }
+    const TargetDistances* distances = hasFrozen ? frozen_target_distances(solver, frozen) : &matching->open;
+
+    int targetsCount = 0;
+    for (int target = 0; target < solver->targetsCount; target++)
+        if (!bits_get(frozen, solver->targetCells[target]))
+            matching->targets[targetsCount++] = target;
+
+    // Each box is taken alone, from the side of the player: the player can only walk around it where the floor goes around.
+    // Other boxes never split the floor any further, and the player never crosses a box, so the sides of the boxes that are
+    // not pushed stay the same from one position to the next.
+    int* cost = matching->costs;
+    int movingCount = 0;
+    for (int box = 0; box < boxesCount; box++)
+    {
+        int cell = boxCells[box];
+        if (bits_get(frozen, cell))
+            continue;
+        int side = player_side(&distances->sides, cell, player);
+        for (int target = 0; target < targetsCount; target++)
+        {
+            int targetIndex = matching->targets[target];
+            // A box the player can never reach again can only stay where it is.
+            int pushes = solver->targetCells[targetIndex] == cell ? 0 : SOLVER_DEADLOCK;
+            if (side >= 0)
+                pushes = distances->distance[(cell * DIRECTIONS_COUNT + side) * solver->targetsCount + targetIndex];
+            cost[movingCount * targetsCount + target] = pushes == SOLVER_DEADLOCK ? MATCH_NO_PATH : pushes;
+        }
+        movingCount += 1;
+    }
+    return match_boxes(matching->costs, movingCount, targetsCount);
+}
+
+int solver_solution_pushes(const Solver* solver)
+{
+    if (solver->status != SolverStatus_Solved)
+        return -1;
+    return solver->nodes[solver->goalNode].pushes;
+}
+
+bool solver_first_push(const Solver* solver, int* ret_x, int* ret_y, int* ret_direction)
+{
+    uint32_t node = solver->status == SolverStatus_Solved ? solver->goalNode : solver->bestNode;
+    if (node == NO_NODE || solver->nodes[node].parent == NO_NODE)
+        return false;
+
+    while (solver->nodes[solver->nodes[node].parent].parent != NO_NODE)
+        node = solver->nodes[node].parent;
+
+    int cell = solver->floor.floorToCell[solver->nodes[node].pushedBox];
+    *ret_x = cell % solver->level->level_width;
+    *ret_y = cell / solver->level->level_width;
+    *ret_direction = solver->nodes[node].direction;
+    return true;
+}
+
+// Appends the shortest walk between two floor cells, avoiding boxes. Returns the new length, or -1 if it does not fit.
+static int append_walk(Solver* solver, const uint32_t* boxes, int from, int to, char* output, int length, int size)
+{
+    if (from == to)
+        return length;
+
+    // Breadth-first search from the destination, so the walk can be written forwards by following the distances.
+    uint16_t* distance = malloc(solver->floor.count * sizeof(uint16_t));
+    for (int floor = 0; floor < solver->floor.count; floor++)
+        distance[floor] = SOLVER_DEADLOCK;
+    int head = 0, tail = 0;
+    solver->queue[tail++] = to;
+    distance[to] = 0;
+    while (head < tail && distance[from] == SOLVER_DEADLOCK)
+    {
+        int cell = solver->queue[head++];
+        for (int direction = 0; direction < DIRECTIONS_COUNT; direction++)
+        {
+            int next = solver->floor.neighbors[cell][direction];
+            if (next == NO_CELL || distance[next] != SOLVER_DEADLOCK || bits_get(boxes, next))
+                continue;
+            distance[next] = distance[cell] + 1;
+            solver->queue[tail++] = next;
+        }
+    }
+
+    int cell = from;
+    while (cell != to && length >= 0)
+    {
+        for (int direction = 0; direction < DIRECTIONS_COUNT; direction++)
+        {
+            int next = solver->floor.neighbors[cell][direction];
+            if (next != NO_CELL && distance[next] + 1 == distance[cell])
+            {
+                if (length + 1 >= size)
+                    length = -1;
+                else
+                    output[length++] = DIRECTION_WALKS[direction];
+                cell = next;
+                break;
+            }
+        }
+    }
+
+    free(distance);
+    return length;
+}
+
+int solver_solution_lurd(Solver* solver, char* output, int size)
+{
+    if (solver->status != SolverStatus_Solved || size <= 0)
+        return -1;
+
+    int pushesCount = solver->nodes[solver->goalNode].pushes;
+    uint32_t* path = malloc((pushesCount + 1) * sizeof(uint32_t));
+    int pathLength = 0;
+    for (uint32_t node = solver->goalNode; node != NO_NODE; node = solver->nodes[node].parent)
+        path[pathLength++] = node;
+
+    uint32_t* boxes = malloc(solver->boxWords * sizeof(uint32_t));
+    memcpy(boxes, node_boxes(solver, path[pathLength - 1]), solver->boxWords * sizeof(uint32_t));
+
+    int length = 0, player = solver->startPlayer;
+    for (int i = pathLength - 2; i >= 0 && length >= 0; i--)
+    {
+        const SolverNode* node = &solver->nodes[path[i]];
+        int box = node->pushedBox;
+        int pushFrom = solver->floor.neighbors[box][opposite_direction(node->direction)];
+
+        length = append_walk(solver, boxes, player, pushFrom, output, length, size);
+        if (length < 0 || length + 1 >= size)
+        {
+            length = -1;
+            break;
+        }
+        output[length++] = DIRECTION_PUSHES[node->direction];
+
+        bits_clear(boxes, box);
+        bits_set(boxes, solver->floor.neighbors[box][node->direction]);
+        player = box;
+    }
+
+    if (length >= 0)
+        output[length] = '\0';
+
+    free(boxes);
+    free(path);
+    return length;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "game_state.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Push-optimal solver. It runs an A* search over push positions: where the boxes are, plus the area the player can reach.
+// Positions already seen are kept in a transposition table, and a pluggable lower bound heuristic guides the search.
+// Pushes to dead squares and pushes that freeze a box out of a target are never explored (see deadlock.h). When the player
+// is fenced off from an area by boxes that can only be pushed into it (a PI-corral), only the pushes of those boxes are.
+// All the memory the search needs is allocated up front, sized by the maximum count of nodes.
+// The search can run in slices (see solver_run), so it can be spread over several frames.
+
+typedef struct Solver Solver;
+
+typedef enum SolverStatus
+{
+    SolverStatus_Running,
+    SolverStatus_Solved,
+    SolverStatus_Unsolvable,
+    SolverStatus_OutOfMemory,
+} SolverStatus;
+
+#define SOLVER_DEADLOCK 0xFFFF
+
+// A lower bound of the pushes needed to solve a position, given the floor cells of its boxes and of the player.
+// It must never overestimate, or solutions may not be push-optimal. SOLVER_DEADLOCK marks the position as unsolvable.
+// It must not drop by more than one from a position to the next either, as positions are never expanded twice.
+typedef int (*SolverHeuristic)(const Solver* solver, const uint16_t* boxCells, int boxesCount, int player);
+
+// Always 0: the search becomes a breadth-first search over pushes.
+int solver_heuristic_none(const Solver* solver, const uint16_t* boxCells, int boxesCount, int player);
+// The sum, for every box, of the pushes to its nearest target, ignoring every other box and the player.
+int solver_heuristic_push_distance(const Solver* solver, const uint16_t* boxCells, int boxesCount, int player);
+// The least sum of pushes that takes every box to a target of its own, each box alone on the floor with the player where it
+// is: a minimum cost matching of boxes and targets. It is never lower than the push distance. It finds positions where two
+// boxes need the same target, and boxes that block the only way of the player to the side they must be pushed from.
+// Boxes frozen on targets are taken as walls. It needs about 8 bytes per floor cell and target, 9 times over.
+int solver_heuristic_matching(const Solver* solver, const uint16_t* boxCells, int boxesCount, int player);
+
+// Returns the maximum count of nodes a search of a level with the given heuristic can use without taking more than the
+// given memory.
+int solver_max_nodes_for_memory(const Level* level, SolverHeuristic heuristic, size_t bytes);
+
+// Prepares a search from the current position of a game.
+Solver* solver_alloc(const GameState* state, int maxNodes, SolverHeuristic heuristic);
+void solver_free(Solver* solver);
+
+// Expands up to maxExpansions nodes (or until the search ends, if maxExpansions is 0), and returns the status of the search.
+SolverStatus solver_run(Solver* solver, int maxExpansions);
+SolverStatus solver_status(const Solver* solver);
+
+int solver_nodes_count(const Solver* solver);
+int solver_expansions_count(const Solver* solver);
+size_t solver_memory_size(const Solver* solver);
+
+// Floor cells are the cells the player can reach in an empty level. They are numbered from 0, row by row.
+int solver_floor_cells_count(const Solver* solver);
+// Returns the pushes needed to take a box from a floor cell to its nearest target, ignoring every other box, or SOLVER_DEADLOCK.
+int solver_push_distance(const Solver* solver, int floorCell);
+
+// Returns the first push towards a solution: the first push of the solution once solved, or otherwise the first push towards
+// the position that looks closest to a solution so far. Directions are 0 left, 1 right, 2 up and 3 down.
+// Returns false if no push has been explored yet.
+bool solver_first_push(const Solver* solver, int* ret_x, int* ret_y, int* ret_direction);
+
+// Once solved, returns the pushes of the solution.
+int solver_solution_pushes(const Solver* solver);
+// Once solved, writes the solution in LURD notation: lowercase letters are walks, uppercase letters are pushes.
+// Returns the length of the solution, or -1 if it does not fit.
+int solver_solution_lurd(Solver* solver, char* output, int size);
@@ -51,4 +51,9 @@ char buffered_reader_read_char(BufferedReader* reader)
         return '\0';
 
     return reader->buffer[reader->bufferPos++];
+}
+
+uint32_t buffered_reader_tell(BufferedReader* reader)
+{
+    return storage_file_tell(reader->file) - (reader->bufferLen - reader->bufferPos);
 }
\ No newline at end of file
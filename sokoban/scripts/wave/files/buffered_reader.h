@@ -1,4 +1,5 @@
 #include <stdbool.h>
+#include <stdint.h>
 #include <storage/storage.h>
 
 typedef struct BufferedReader BufferedReader;
@@ -7,4 +8,7 @@ BufferedReader* bufferedReader_alloc(File* file, int bufferSize);
 void buffered_reader_free(BufferedReader* reader);
 
 bool buffered_reader_is_eof(BufferedReader* reader);
-char buffered_reader_read_char(BufferedReader* reader);
\ No newline at end of file
+char buffered_reader_read_char(BufferedReader* reader);
+
+// Returns the position in the file of the next char to be read.
+uint32_t buffered_reader_tell(BufferedReader* reader);
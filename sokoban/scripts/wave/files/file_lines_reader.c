@@ -48,4 +48,9 @@ bool file_lines_reader_readln(FileLinesReader* reader, char* output, uint16_t si
 bool file_lines_reader_is_eof(FileLinesReader* reader)
 {
     return buffered_reader_is_eof(reader->buffer);
+}
+
+uint32_t file_lines_reader_tell(FileLinesReader* reader)
+{
+    return buffered_reader_tell(reader->buffer);
 }
\ No newline at end of file
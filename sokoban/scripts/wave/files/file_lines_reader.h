@@ -8,4 +8,7 @@ FileLinesReader* file_lines_reader_alloc(File* file, int bufferSize);
 void file_lines_reader_free(FileLinesReader* reader);
 
 bool file_lines_reader_readln(FileLinesReader* reader, char* output, uint16_t size);
-bool file_lines_reader_is_eof(FileLinesReader* reader);
\ No newline at end of file
+bool file_lines_reader_is_eof(FileLinesReader* reader);
+
+// Returns the position in the file where the next line starts.
+uint32_t file_lines_reader_tell(FileLinesReader* reader);
\ No newline at end of file
@@ -17,6 +17,7 @@ struct Scene
     InputCallback inputCallback;
     TransitionCallback transitionCallback;
     void* context;
+    bool isRenderedOnRequest;
 };
 
 typedef struct ScenesListNode
@@ -34,6 +35,7 @@ struct SceneManager
     FuriMessageQueue* eventQueue;
     Gui* gui;
     bool isAutoManaged;
+    bool isRenderRequested;
 };
 
 Scene* scene_alloc(RenderCallback renderCallback, TickCallback tickCallback, InputCallback inputCallback, TransitionCallback transitionCallback, void* context)
@@ -44,9 +46,15 @@ Scene* scene_alloc(RenderCallback renderCallback, TickCallback tickCallback, Inp
     scene->inputCallback = inputCallback;
     scene->transitionCallback = transitionCallback;
     scene->context = context;
+    scene->isRenderedOnRequest = false;
     return scene;
 }
 
+void scene_set_rendered_on_request(Scene* scene, bool isRenderedOnRequest)
+{
+    scene->isRenderedOnRequest = isRenderedOnRequest;
+}
+
 void scene_destroy(Scene* s)
 {
     free(s);
@@ -75,9 +83,19 @@ void scene_manager_tick(SceneManager* sceneManager)
     if (currentScene && currentScene->tickCallback)
         currentScene->tickCallback(currentScene->context);
 
+    currentScene = scene_manager_get_current_scene(sceneManager);
+    if (currentScene && currentScene->isRenderedOnRequest && !sceneManager->isRenderRequested)
+        return;
+
+    sceneManager->isRenderRequested = false;
     view_port_update(sceneManager->viewPort);
 }
 
+void scene_manager_request_render(SceneManager* sceneManager)
+{
+    sceneManager->isRenderRequested = true;
+}
+
 void scene_manager_draw_callback(Canvas* canvas, void* context)
 {
     SceneManager* sceneManager = (SceneManager*)context;
@@ -137,6 +155,7 @@ void scene_manager_set_scene(SceneManager* sceneManager, int to)
     }
 
     sceneManager->currentScene = nextNode;
+    sceneManager->isRenderRequested = true;
 }
 
 int scene_manager_get_current_scene_id(SceneManager* sceneManager)
@@ -158,6 +177,8 @@ SceneManager* scene_manager_alloc(ViewPort* viewPort, Gui* gui, FuriMessageQueue
     sceneManager->viewPort = viewPort;
     sceneManager->eventQueue = eventQueue;
     sceneManager->gui = gui;
+    sceneManager->isAutoManaged = false;
+    sceneManager->isRenderRequested = true;
     gui_add_view_port(gui, viewPort, GuiLayerFullscreen);
 
     view_port_draw_callback_set(viewPort, scene_manager_draw_callback, sceneManager);
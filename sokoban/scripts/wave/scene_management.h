@@ -15,6 +15,9 @@ typedef struct SceneManager SceneManager;
 
 Scene* scene_alloc(RenderCallback render_callback, TickCallback tick_callback, InputCallback input_callback, TransitionCallback transition_callback, void* context);
 void scene_destroy(Scene* s);
+// Scenes are rendered on every tick, unless they are rendered on request: then only after they call
+// scene_manager_request_render, and when they are entered.
+void scene_set_rendered_on_request(Scene* scene, bool isRenderedOnRequest);
 
 SceneManager* scene_manager_alloc_auto();
 SceneManager* scene_manager_alloc(ViewPort* viewPort, Gui* gui, FuriMessageQueue* eventQueue);
@@ -24,5 +27,6 @@ void scene_manager_detach_from_gui(SceneManager* sceneManager, Gui* gui);
 void scene_manager_register_scene(SceneManager* sm, int id, Scene* scene);
 void scene_manager_set_scene(SceneManager* sm, int id);
 void scene_manager_tick(SceneManager* sm);
+void scene_manager_request_render(SceneManager* sm);
 int scene_manager_get_current_scene_id(SceneManager* sm);
 bool scene_manager_has_scene(SceneManager* sm);
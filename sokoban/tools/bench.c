@@ -0,0 +1,1768 @@
+// Host benchmarks for the Sokoban engine. Run without arguments to execute all of them, or pass benchmark names.
+#include "collection_import.h"
+#include "collection_index.h"
+#include "deadlock.h"
+#include "game_renderer.h"
+#include "game_state.h"
+#include "hint.h"
+#include "host/host_canvas.h"
+#include "host/host_storage.h"
+#include "level.h"
+#include "levels_database.h"
+#include "macro_move.h"
+#include "move_journal.h"
+#include "racso_sokoban_icons.h"
+#include "session_journal.h"
+#include "solutions.h"
+#include "state_store.h"
+
+#include <furi.h>
+#include <malloc.h>
+#include <storage/storage.h>
+#include <string.h>
+#include <time.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static double now_us(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1e6 + now.tv_nsec / 1e3;
+}
+
+
+// Stack use is measured by filling the stack below the caller with a pattern, and finding how much of it was overwritten.
+// The painted area is found again through its address, as the frame that held it is gone by then.
+#define STACK_PROBE_SIZE 65536
+
+static uintptr_t paintedStack = 0;
+
+static __attribute__((noinline)) void paint_stack(void)
+{
+    volatile uint8_t area[STACK_PROBE_SIZE];
+    for (size_t i = 0; i < sizeof(area); i++)
+        area[i] = 0xA5;
+    paintedStack = (uintptr_t)area;
+}
+
+static __attribute__((noinline)) size_t measure_stack(void)
+{
+    volatile const uint8_t* area = (volatile const uint8_t*)paintedStack;
+    size_t untouched = 0;
+    while (untouched < STACK_PROBE_SIZE && area[untouched] == 0xA5)
+        untouched += 1;
+    return STACK_PROBE_SIZE - untouched;
+}
+
+// Level open time, depending on where the level sits in its collection file, through the pack and through the text. Also
+// the peak stack used by a load, dead squares included.
+static void bench_level_load(LevelsDatabase* database)
+{
+    const int REPETITIONS = 200;
+    const struct
+    {
+        const char* name;
+        Level* (*load)(const char*, int);
+    } loaders[] = {
+        {"level_load", level_load},
+        {"text", level_load_text},
+    };
+
+    printf("== level_load ==\n");
+    printf("%-10s %-10s %6s %10s %12s %10s\n", "loader", "collection", "level", "us/load", "bytes/load", "stack B");
+
+    for (size_t loaderIndex = 0; loaderIndex < sizeof(loaders) / sizeof(loaders[0]); loaderIndex++)
+    {
+        for (int collectionIndex = 0; collectionIndex < database->collectionsCount; collectionIndex++)
+        {
+            LevelsCollection* collection = &database->collections[collectionIndex];
+
+            // The first load builds the index if it is missing or stale.
+            double start = now_us();
+            level_free(loaders[loaderIndex].load(collection->name, 0));
+            printf("%-10s %-10s %6s %10.1f %12s %10s\n", loaders[loaderIndex].name, collection->name, "first", now_us() - start, "-", "-");
+
+            for (int step = 0; step <= 4; step++)
+            {
+                int levelIndex = (collection->levelsCount - 1) * step / 4;
+
+                host_storage_reset_stats();
+                start = now_us();
+                for (int i = 0; i < REPETITIONS; i++)
+                    level_free(loaders[loaderIndex].load(collection->name, levelIndex));
+                double elapsed = (now_us() - start) / REPETITIONS;
+                HostStorageStats stats = host_storage_stats();
+
+                paint_stack();
+                level_free(loaders[loaderIndex].load(collection->name, levelIndex));
+                size_t stack = measure_stack();
+
+                printf("%-10s %-10s %6d %10.1f %12llu %10zu\n", loaders[loaderIndex].name, collection->name, levelIndex + 1, elapsed,
+                       (unsigned long long)(stats.bytesRead / REPETITIONS), stack);
+            }
+        }
+    }
+    printf("\n");
+}
+
+// Deterministic pseudo-random numbers, so runs are comparable.
+static uint32_t random_state = 1;
+static uint32_t next_random(void)
+{
+    random_state = random_state * 1103515245 + 12345;
+    return (random_state >> 16) & 0x7FFF;
+}
+
+// Cost of moves and undos, grouped by board area: a random walk over every level, with one undo for every four moves.
+static void bench_moves(LevelsDatabase* database)
+{
+    const int OPERATIONS = 200000;
+    const int AREA_LIMITS[] = {50, 100, 200, 400, MAX_BOARD_SIZE * MAX_BOARD_SIZE};
+    const int BUCKETS_COUNT = sizeof(AREA_LIMITS) / sizeof(AREA_LIMITS[0]);
+    const int DIRECTIONS[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+
+    double bucketTime[BUCKETS_COUNT];
+    int bucketLevels[BUCKETS_COUNT];
+    memset(bucketTime, 0, sizeof(bucketTime));
+    memset(bucketLevels, 0, sizeof(bucketLevels));
+
+    for (int collectionIndex = 0; collectionIndex < database->collectionsCount; collectionIndex++)
+    {
+        LevelsCollection* collection = &database->collections[collectionIndex];
+        for (int levelIndex = 0; levelIndex < collection->levelsCount; levelIndex++)
+        {
+            Level* level = level_load(collection->name, levelIndex);
+            GameState* state = game_state_initialize(level);
+
+            random_state = 1;
+            double start = now_us();
+            for (int i = 0; i < OPERATIONS; i++)
+            {
+                uint32_t random = next_random();
+                if (random % 5 == 0)
+                    game_state_undo_move(state);
+                else
+                    game_state_apply_move(state, DIRECTIONS[random % 4][0], DIRECTIONS[random % 4][1]);
+            }
+            double elapsed = now_us() - start;
+            game_state_free(state);
+
+            int area = level->level_width * level->level_height;
+            int bucket = 0;
+            while (area > AREA_LIMITS[bucket])
+                bucket += 1;
+            bucketTime[bucket] += elapsed * 1000 / OPERATIONS;
+            bucketLevels[bucket] += 1;
+            level_free(level);
+        }
+    }
+
+    printf("== moves ==\n");
+    printf("%-12s %8s %10s\n", "area", "levels", "ns/op");
+    for (int bucket = 0; bucket < BUCKETS_COUNT; bucket++)
+    {
+        if (bucketLevels[bucket] == 0)
+            continue;
+        char range[32];
+        snprintf(range, sizeof(range), "%d-%d", bucket == 0 ? 0 : AREA_LIMITS[bucket - 1] + 1, AREA_LIMITS[bucket]);
+        printf("%-12s %8d %10.1f\n", range, bucketLevels[bucket], bucketTime[bucket] / bucketLevels[bucket]);
+    }
+    printf("\n");
+}
+
+// Memory used by a level being played: the shared level, and the game state with its box layer and move journal.
+static void bench_memory(LevelsDatabase* database)
+{
+    printf("== memory ==\n");
+    printf("%-10s %12s %12s %12s %12s\n", "collection", "level avg", "level max", "state avg", "state max");
+
+    for (int collectionIndex = 0; collectionIndex < database->collectionsCount; collectionIndex++)
+    {
+        LevelsCollection* collection = &database->collections[collectionIndex];
+        int maxLevelSize = 0, maxStateSize = 0;
+        long totalLevelSize = 0, totalStateSize = 0;
+        for (int levelIndex = 0; levelIndex < collection->levelsCount; levelIndex++)
+        {
+            Level* level = level_load(collection->name, levelIndex);
+            GameState* state = game_state_initialize(level);
+            int levelSize = sizeof(Level) + board_heap_size(&level->board);
+            int stateSize = game_state_memory_size(state);
+            game_state_free(state);
+            level_free(level);
+
+            maxLevelSize = MAX(maxLevelSize, levelSize);
+            maxStateSize = MAX(maxStateSize, stateSize);
+            totalLevelSize += levelSize;
+            totalStateSize += stateSize;
+        }
+        printf("%-10s %12ld %12d %12ld %12d\n", collection->name, totalLevelSize / collection->levelsCount, maxLevelSize, totalStateSize / collection->levelsCount, maxStateSize);
+    }
+    printf("\n");
+}
+
+// Cost of the deadlock detection: the dead squares pass done when a level is loaded, and the freeze check done after each
+// push, measured over the pushes of a random walk.
+static void bench_deadlocks(LevelsDatabase* database)
+{
+    const int REPETITIONS = 200;
+    const int OPERATIONS = 20000;
+    const int CHECK_REPETITIONS = 16;
+    const int DIRECTIONS[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+
+    printf("== deadlocks ==\n");
+    printf("%-10s %10s %10s %10s %12s %12s %12s\n", "collection", "dead avg", "us/level", "us max", "ns/push", "pushes", "deadlocked");
+
+    for (int collectionIndex = 0; collectionIndex < database->collectionsCount; collectionIndex++)
+    {
+        LevelsCollection* collection = &database->collections[collectionIndex];
+        double totalPassTime = 0, maxPassTime = 0, totalCheckTime = 0;
+        long totalDeadSquares = 0, totalPushes = 0, deadlockedPushes = 0;
+
+        for (int levelIndex = 0; levelIndex < collection->levelsCount; levelIndex++)
+        {
+            Level* level = level_load(collection->name, levelIndex);
+
+            int deadSquaresCount = 0;
+            double start = now_us();
+            for (int i = 0; i < REPETITIONS; i++)
+                deadSquaresCount = deadlock_find_dead_squares(level);
+            double passTime = (now_us() - start) / REPETITIONS;
+            totalPassTime += passTime;
+            maxPassTime = MAX(maxPassTime, passTime);
+            totalDeadSquares += deadSquaresCount;
+
+            GameState* state = game_state_initialize(level);
+            random_state = 1;
+            for (int i = 0; i < OPERATIONS; i++)
+            {
+                uint32_t random = next_random();
+                if (random % 5 == 0)
+                {
+                    game_state_undo_move(state);
+                    continue;
+                }
+
+                int dx = DIRECTIONS[random % 4][0], dy = DIRECTIONS[random % 4][1];
+                int pushesBefore = state->pushesCount;
+                game_state_apply_move(state, dx, dy);
+                if (state->pushesCount == pushesBefore)
+                    continue;
+
+                int boxX = state->playerX + dx, boxY = state->playerY + dy;
+                bool deadlocked = false;
+                start = now_us();
+                for (int check = 0; check < CHECK_REPETITIONS; check++)
+                    deadlocked |= deadlock_check_push(&level->board, &state->boxes, boxX, boxY);
+                totalCheckTime += (now_us() - start) / CHECK_REPETITIONS;
+                totalPushes += 1;
+                deadlockedPushes += deadlocked;
+            }
+
+            game_state_free(state);
+            level_free(level);
+        }
+
+        printf("%-10s %10.1f %10.2f %10.2f %12.1f %12ld %11.1f%%\n", collection->name, (double)totalDeadSquares / collection->levelsCount, totalPassTime / collection->levelsCount, maxPassTime, totalPushes > 0 ? totalCheckTime * 1000 / totalPushes : 0, totalPushes, totalPushes > 0 ? deadlockedPushes * 100.0 / totalPushes : 0);
+    }
+    printf("\n");
+}
+
+// Time to a hint from the starting position of every level, with the memory budget of the device and the time budget of a frame.
+static void bench_hint(LevelsDatabase* database)
+{
+    const uint32_t TICK_BUDGET_MS = 30;
+
+    printf("== hint ==\n");
+    printf("%-10s %8s %8s %10s %10s %10s %10s\n", "collection", "found", "guessed", "not found", "ms avg", "ms max", "ticks avg");
+
+    for (int collectionIndex = 0; collectionIndex < database->collectionsCount; collectionIndex++)
+    {
+        LevelsCollection* collection = &database->collections[collectionIndex];
+        int statusCounts[HintStatus_NotFound + 1] = {0};
+        double totalTime = 0, maxTime = 0;
+        long totalTicks = 0;
+
+        for (int levelIndex = 0; levelIndex < collection->levelsCount; levelIndex++)
+        {
+            Level* level = level_load(collection->name, levelIndex);
+            GameState* state = game_state_initialize(level);
+
+            double start = now_us();
+            Hint* hint = hint_start(state);
+            int ticks = 0;
+            while (hint_step(hint, TICK_BUDGET_MS) == HintStatus_Searching)
+                ticks += 1;
+            double elapsed = (now_us() - start) / 1000;
+
+            statusCounts[hint_status(hint)] += 1;
+            totalTime += elapsed;
+            maxTime = MAX(maxTime, elapsed);
+            totalTicks += ticks + 1;
+
+            hint_free(hint);
+            game_state_free(state);
+            level_free(level);
+        }
+
+        printf("%-10s %8d %8d %10d %10.2f %10.2f %10.1f\n", collection->name, statusCounts[HintStatus_Found], statusCounts[HintStatus_Guessed], statusCounts[HintStatus_NotFound], totalTime / collection->levelsCount, maxTime, (double)totalTicks / collection->levelsCount);
+    }
+    printf("\n");
+}
+
+// Move journal: memory per 1000 moves and cost of each operation, checked against a plain array of moves. Then, with the
+// free heap reported as low, the journal must keep its size by dropping its oldest moves.
+static void bench_journal(LevelsDatabase* database)
+{
+    UNUSED(database);
+    const int MOVES = 1000000;
+
+    JournalMove* reference = malloc(MOVES * sizeof(JournalMove));
+    int referenceCount = 0, referenceTop = 0;
+    MoveJournal journal;
+    move_journal_init(&journal);
+
+    random_state = 1;
+    bool consistent = true;
+    double start = now_us();
+    for (int i = 0; i < MOVES; i++)
+    {
+        uint32_t random = next_random();
+        if (random % 8 == 0)
+        {
+            JournalMove move = move_journal_undo(&journal);
+            JournalMove expected = referenceCount > 0 ? reference[--referenceCount] : MoveInvalid;
+            consistent &= move == expected;
+        }
+        else if (random % 8 == 1)
+        {
+            JournalMove move = move_journal_redo(&journal);
+            JournalMove expected = referenceCount < referenceTop ? reference[referenceCount++] : MoveInvalid;
+            consistent &= move == expected;
+        }
+        else
+        {
+            JournalMove move = random % 8;
+            move_journal_record(&journal, move);
+            reference[referenceCount++] = move;
+            referenceTop = referenceCount;
+        }
+    }
+    double elapsed = now_us() - start;
+
+    printf("== journal ==\n");
+    printf("%-24s %10s\n", "operations", consistent ? "match" : "MISMATCH");
+    printf("%-24s %10.1f\n", "ns/op", elapsed * 1000 / MOVES);
+    printf("%-24s %10d\n", "moves", journal.undoCount + journal.redoCount);
+    printf("%-24s %10.1f\n", "bytes per 1000 moves", move_journal_heap_size(&journal) * 1000.0 / (journal.undoCount + journal.redoCount));
+    printf("%-24s %10.1f\n", "(undo ring: 1 per move)", 1000.0);
+
+    size_t sizeBefore = move_journal_heap_size(&journal);
+    int undoBefore = journal.undoCount;
+    host_set_free_heap(1024);
+    for (int i = 0; i < MOVES / 10; i++)
+        move_journal_record(&journal, MoveRight);
+    host_set_free_heap(0);
+
+    int undone = 0;
+    while (move_journal_undo(&journal) != MoveInvalid)
+        undone += 1;
+    printf("%-24s %10d\n", "low memory: dropped", journal.droppedCount);
+    printf("%-24s %10s\n", "low memory: size kept", move_journal_heap_size(&journal) <= sizeBefore + sizeof(MoveJournalChunk) ? "yes" : "NO");
+    printf("%-24s %10d\n", "low memory: undoable", undone);
+    printf("%-24s %10d\n", "(moves before)", undoBefore + MOVES / 10);
+    printf("\n");
+
+    move_journal_free(&journal);
+    free(reference);
+}
+
+// Seek latency against history length: random seeks through a long random walk, with keyframes, compared with stepping
+// there one undo or redo at a time.
+static void bench_seek(LevelsDatabase* database)
+{
+    const int LENGTHS[] = {100, 1000, 10000, 100000};
+    const int SEEKS = 2000;
+    const int DIRECTIONS[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+
+    Level* level = level_load(database->collections[0].name, 0);
+
+    printf("== seek ==\n");
+    printf("%-10s %12s %12s %14s %12s\n", "moves", "us/seek", "us max", "us/step seek", "keyframes");
+
+    for (size_t lengthIndex = 0; lengthIndex < sizeof(LENGTHS) / sizeof(LENGTHS[0]); lengthIndex++)
+    {
+        int length = LENGTHS[lengthIndex];
+        GameState* state = game_state_initialize(level);
+        random_state = 1;
+        while (game_state_position(state) < length)
+        {
+            uint32_t random = next_random();
+            game_state_apply_move(state, DIRECTIONS[random % 4][0], DIRECTIONS[random % 4][1]);
+        }
+
+        double total = 0, maxTime = 0;
+        for (int i = 0; i < SEEKS; i++)
+        {
+            int target = next_random() * 0x8000 + next_random();
+            target %= length + 1;
+            double start = now_us();
+            game_state_seek(state, target);
+            double elapsed = now_us() - start;
+            total += elapsed;
+            maxTime = MAX(maxTime, elapsed);
+        }
+
+        // The same seeks, one move at a time.
+        random_state = 7;
+        double stepTotal = 0;
+        for (int i = 0; i < SEEKS; i++)
+        {
+            int target = next_random() * 0x8000 + next_random();
+            target %= length + 1;
+            double start = now_us();
+            while (game_state_position(state) < target)
+                game_state_redo_move(state);
+            while (game_state_position(state) > target)
+                game_state_undo_move(state);
+            stepTotal += now_us() - start;
+        }
+
+        printf("%-10d %12.2f %12.2f %14.2f %12d\n", length, total / SEEKS, maxTime, stepTotal / SEEKS, state->keyframesCount);
+        game_state_free(state);
+    }
+    printf("\n");
+    level_free(level);
+}
+
+// Session journal cost over long sessions: what the appends write, and how long resuming takes. The session is written
+// with a flush every FLUSH_INTERVAL operations, as the game's timer would, and resumed into a new state that must match.
+// Scrubs to anywhere in the history are among the operations.
+static void bench_session(LevelsDatabase* database)
+{
+    const int LENGTHS[] = {1000, 10000, 100000};
+    const int FLUSH_INTERVAL = 50;
+    const int DIRECTIONS[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+    const char* collectionName = database->collections[0].name;
+
+    Level* level = level_load(collectionName, 0);
+    char path[256], hostPath[512];
+    collection_data_path(path, sizeof(path), collectionName, "_1.ses");
+    host_storage_resolve_path(hostPath, sizeof(hostPath), path);
+
+    printf("== session ==\n");
+    printf("%-10s %10s %10s %10s %12s %12s %10s\n", "ops", "file B", "B/op", "writes", "written B", "resume ms", "resumed");
+
+    for (size_t lengthIndex = 0; lengthIndex < sizeof(LENGTHS) / sizeof(LENGTHS[0]); lengthIndex++)
+    {
+        int length = LENGTHS[lengthIndex];
+        remove(hostPath);
+
+        GameState* state = game_state_initialize(level);
+        SessionJournal* session = session_journal_open(collectionName, 0, state);
+        host_storage_reset_stats();
+        uint32_t writes = 0;
+
+        random_state = 1;
+        for (int i = 0; i < length; i++)
+        {
+            uint32_t random = next_random() % 8;
+            int before = game_state_position(state);
+            if (random == 0)
+            {
+                game_state_seek(state, before - 1);
+                session_journal_append_seek(session, before, game_state_position(state));
+            }
+            else if (random == 1)
+            {
+                game_state_seek(state, before + 1);
+                session_journal_append_seek(session, before, game_state_position(state));
+            }
+            else if (random == 2)
+            {
+                // A scrub to anywhere in the history.
+                int first = game_state_first_position(state), last = game_state_last_position(state);
+                game_state_seek(state, first + next_random() % (last - first + 1));
+                session_journal_append_seek(session, before, game_state_position(state));
+            }
+            else
+            {
+                int direction = random % 4;
+                game_state_apply_move(state, DIRECTIONS[direction][0], DIRECTIONS[direction][1]);
+                if (game_state_position(state) != before)
+                    session_journal_append(session, (SessionOp)direction);
+            }
+
+            if (i % FLUSH_INTERVAL == FLUSH_INTERVAL - 1)
+            {
+                session_journal_flush(session);
+                writes += 1;
+            }
+        }
+        session_journal_close(session);
+        HostStorageStats stats = host_storage_stats();
+
+        FILE* file = fopen(hostPath, "rb");
+        long fileSize = 0;
+        if (file != NULL)
+        {
+            fseek(file, 0, SEEK_END);
+            fileSize = ftell(file);
+            fclose(file);
+        }
+
+        double start = now_us();
+        GameState* resumed = game_state_initialize(level);
+        session = session_journal_open(collectionName, 0, resumed);
+        double elapsed = now_us() - start;
+
+        bool match = resumed->playerX == state->playerX && resumed->playerY == state->playerY &&
+                     resumed->pushesCount == state->pushesCount && game_state_position(resumed) == game_state_position(state) &&
+                     game_state_last_position(resumed) == game_state_last_position(state);
+        for (int y = 0; y < level->level_height && match; y++)
+            for (int x = 0; x < level->level_width && match; x++)
+                match = game_state_get_cell(resumed, x, y) == game_state_get_cell(state, x, y);
+
+        printf("%-10d %10ld %10.2f %10lu %12llu %12.2f %10s\n", length, fileSize, (double)fileSize / length, (unsigned long)writes,
+               (unsigned long long)stats.bytesWritten, elapsed / 1000, match ? "match" : "MISMATCH");
+
+        session_journal_discard(session);
+        game_state_free(resumed);
+        game_state_free(state);
+    }
+    printf("\n");
+    level_free(level);
+}
+
+// The text progress format written before the binary one: a version line, then one line per level, rewritten in full.
+static void save_text_progress(const uint16_t* playerBests, int levelsCount)
+{
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    storage_file_open(file, APP_DATA_PATH("sokoban.save"), FSAM_WRITE, FSOM_CREATE_ALWAYS);
+    storage_file_write(file, "1\n", 2);
+    for (int level = 0; level < levelsCount; level++)
+    {
+        char line[32];
+        int length = snprintf(line, sizeof(line), "%d\n", playerBests[level]);
+        storage_file_write(file, line, length);
+    }
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+}
+
+// Points the host storage at a generated database.txt of `collections` collections of `levels` levels each, with a data
+// folder of its own, and removes the progress files there. use_shipped_database() points it back.
+static void use_generated_database(int collections, int levels)
+{
+    const char* ASSETS_FOLDER = "/tmp/sokoban_bench_assets";
+    mkdir(ASSETS_FOLDER, 0755);
+    setenv("SOKOBAN_ASSETS", ASSETS_FOLDER, 1);
+    setenv("SOKOBAN_DATA", "/tmp/sokoban_bench_data", 1);
+
+    char path[512];
+    host_storage_resolve_path(path, sizeof(path), APP_ASSETS_PATH("database.txt"));
+    FILE* file = fopen(path, "w");
+    fprintf(file, "1\n%d\n", collections);
+    uint32_t state = random_state;
+    random_state = 11;
+    for (int collectionIndex = 0; collectionIndex < collections; collectionIndex++)
+    {
+        fprintf(file, "Generated %d\n%d\n", collectionIndex + 1, levels);
+        for (int levelIndex = 0; levelIndex < levels; levelIndex++)
+            fprintf(file, "%d\n", (int)(next_random() % 300 + 10));
+    }
+    fclose(file);
+    random_state = state;
+
+    const char* PROGRESS_FILES[] = {"sokoban.sav", "sokoban.sav.tmp", "sokoban.wal", "sokoban.save"};
+    for (size_t i = 0; i < sizeof(PROGRESS_FILES) / sizeof(PROGRESS_FILES[0]); i++)
+    {
+        char dataPath[64];
+        snprintf(dataPath, sizeof(dataPath), STORAGE_APP_DATA_PATH_PREFIX "/%s", PROGRESS_FILES[i]);
+        host_storage_resolve_path(path, sizeof(path), dataPath);
+        remove(path);
+    }
+}
+
+static char* shippedAssets = NULL;
+static char* shippedData = NULL;
+
+static void remember_shipped_database(void)
+{
+    if (getenv("SOKOBAN_ASSETS") != NULL)
+        shippedAssets = strdup(getenv("SOKOBAN_ASSETS"));
+    if (getenv("SOKOBAN_DATA") != NULL)
+        shippedData = strdup(getenv("SOKOBAN_DATA"));
+}
+
+static void use_shipped_database(void)
+{
+    if (shippedAssets != NULL)
+        setenv("SOKOBAN_ASSETS", shippedAssets, 1);
+    else
+        unsetenv("SOKOBAN_ASSETS");
+    if (shippedData != NULL)
+        setenv("SOKOBAN_DATA", shippedData, 1);
+    else
+        unsetenv("SOKOBAN_DATA");
+}
+
+static LevelsDatabase* load_progress(void)
+{
+    LevelsDatabase* database = levels_database_load();
+    levels_database_load_player_progress(database);
+    return database;
+}
+
+// Checks every best score against `playerBests`, and the summaries against the scores.
+static bool progress_matches(LevelsDatabase* database, const uint16_t* playerBests)
+{
+    for (int collectionIndex = 0; collectionIndex < database->collectionsCount; collectionIndex++)
+    {
+        LevelsCollection* collection = &database->collections[collectionIndex];
+        int completedCount = 0, starredCount = 0;
+        for (int levelIndex = 0; levelIndex < collection->levelsCount; levelIndex++)
+        {
+            LevelItem levelItem = levels_database_get_level(database, collectionIndex, levelIndex);
+            if (levelItem.playerBest != playerBests[collection->firstLevel + levelIndex])
+                return false;
+            completedCount += levelItem.playerBest != 0;
+            starredCount += levelItem.playerBest != 0 && levelItem.playerBest <= levelItem.worldBest;
+        }
+        if (completedCount != collection->completedCount || starredCount != collection->starredCount)
+            return false;
+    }
+    return true;
+}
+
+// Save latency when a level is completed, for a database of 10,000 levels: the text format rewritten in full, the binary
+// format rewritten in full, and the best score logged. Also checks migration from text.
+static void bench_save(LevelsDatabase* database)
+{
+    UNUSED(database);
+    const int COLLECTIONS = 100, LEVELS = 100, SAVES = 200;
+    const int LEVELS_COUNT = COLLECTIONS * LEVELS;
+
+    use_generated_database(COLLECTIONS, LEVELS);
+    uint16_t* playerBests = malloc(LEVELS_COUNT * sizeof(uint16_t));
+    random_state = 1;
+    for (int level = 0; level < LEVELS_COUNT; level++)
+        playerBests[level] = next_random() % 500;
+
+    char textPath[512];
+    host_storage_resolve_path(textPath, sizeof(textPath), APP_DATA_PATH("sokoban.save"));
+
+    printf("== save (%d levels) ==\n", LEVELS_COUNT);
+    printf("%-20s %10s %12s %10s %10s\n", "method", "us/save", "bytes/save", "writes", "syncs");
+
+    // Migration from the text format.
+    save_text_progress(playerBests, LEVELS_COUNT);
+    LevelsDatabase* saved = load_progress();
+    bool migrated = progress_matches(saved, playerBests) && access(textPath, F_OK) != 0;
+
+    for (int method = 0; method < 3; method++)
+    {
+        static const char* NAMES[] = {"text rewrite", "binary rewrite", "logged"};
+        double elapsed = 0;
+        uint64_t bytesWritten = 0, writes = 0, syncs = 0;
+        for (int i = 0; i < SAVES; i++)
+        {
+            int collectionIndex = next_random() % COLLECTIONS, levelIndex = next_random() % LEVELS;
+            int level = collectionIndex * LEVELS + levelIndex;
+            playerBests[level] = next_random() % 500 + 1;
+
+            // Only the save itself is measured. The score gets into the database through the log, as when playing.
+            if (method != 2)
+                levels_database_set_player_best(saved, collectionIndex, levelIndex, playerBests[level]);
+
+            host_storage_reset_stats();
+            double start = now_us();
+            if (method == 0)
+                save_text_progress(playerBests, LEVELS_COUNT);
+            else if (method == 1)
+                levels_database_save_player_progress(saved);
+            else
+                levels_database_set_player_best(saved, collectionIndex, levelIndex, playerBests[level]);
+            elapsed += now_us() - start;
+            HostStorageStats stats = host_storage_stats();
+            bytesWritten += stats.bytesWritten;
+            writes += stats.writes;
+            syncs += stats.syncs;
+        }
+        printf("%-20s %10.1f %12llu %10.2f %10.2f\n", NAMES[method], elapsed / SAVES, (unsigned long long)(bytesWritten / SAVES),
+               (double)writes / SAVES, (double)syncs / SAVES);
+    }
+    // A last score stays in the log, for the update below.
+    playerBests[0] = playerBests[0] == 1 ? 2 : 1;
+    levels_database_set_player_best(saved, 0, 0, playerBests[0]);
+    bool logged = levels_database_has_pending_progress(saved);
+    levels_database_free(saved);
+
+    LevelsDatabase* loaded = load_progress();
+    bool reloaded = progress_matches(loaded, playerBests);
+    levels_database_free(loaded);
+
+    // A database.txt of another size, as after an update of the app, rewrites the progress, which must keep the log.
+    char databasePath[512];
+    host_storage_resolve_path(databasePath, sizeof(databasePath), APP_ASSETS_PATH("database.txt"));
+    FILE* databaseFile = fopen(databasePath, "a");
+    fputc('\n', databaseFile);
+    fclose(databaseFile);
+    loaded = load_progress();
+    bool updated = logged && progress_matches(loaded, playerBests);
+    levels_database_free(loaded);
+
+    printf("%-20s %10s\n", "migration", migrated ? "match" : "MISMATCH");
+    printf("%-20s %10s\n", "reload", reloaded ? "match" : "MISMATCH");
+    printf("%-20s %10s\n", "database update", updated ? "match" : "MISMATCH");
+    printf("\n");
+
+    free(playerBests);
+    use_shipped_database();
+}
+
+// Power loss at every point of a run of saves: best scores logged one by one, compactions, and a full rewrite. After each
+// simulated loss the progress is loaded again, and must be the progress after some prefix of the saves, including every
+// save that returned before the loss, with matching summaries. Then the reads recovery adds to loading, against database
+// size, with a full log.
+static void bench_crash(LevelsDatabase* database)
+{
+    UNUSED(database);
+    const int COLLECTIONS = 5, LEVELS = 40, SAVES = 40;
+    const int LEVELS_COUNT = COLLECTIONS * LEVELS;
+
+    // The progress after each prefix of the saves.
+    uint16_t* prefixes = calloc((SAVES + 1) * LEVELS_COUNT, sizeof(uint16_t));
+    int* savedLevels = malloc(SAVES * sizeof(int));
+    random_state = 3;
+    for (int save = 0; save < SAVES; save++)
+    {
+        memcpy(&prefixes[(save + 1) * LEVELS_COUNT], &prefixes[save * LEVELS_COUNT], LEVELS_COUNT * sizeof(uint16_t));
+        savedLevels[save] = next_random() % LEVELS_COUNT;
+        prefixes[(save + 1) * LEVELS_COUNT + savedLevels[save]] = next_random() % 500 + 1;
+    }
+
+    int runs = 0, failures = 0, inFlightKept = 0;
+    for (int64_t budget = 0;; budget++)
+    {
+        use_generated_database(COLLECTIONS, LEVELS);
+        LevelsDatabase* progress = load_progress();
+        levels_database_save_player_progress(progress);
+
+        host_storage_set_fault_budget(budget);
+        int acknowledged = 0;
+        for (int save = 0; save < SAVES && !host_storage_faulted(); save++)
+        {
+            int level = savedLevels[save];
+            if (save == SAVES / 2)
+                levels_database_save_player_progress(progress);
+            levels_database_set_player_best(progress, level / LEVELS, level % LEVELS, prefixes[(save + 1) * LEVELS_COUNT + level]);
+            if (save % 7 == 6)
+                levels_database_compact_progress(progress);
+            if (!host_storage_faulted())
+                acknowledged = save + 1;
+        }
+        bool finished = !host_storage_faulted();
+        host_storage_set_fault_budget(-1);
+        levels_database_free(progress);
+
+        // Power comes back.
+        LevelsDatabase* recovered = load_progress();
+        int prefix = -1;
+        for (int candidate = SAVES; candidate >= acknowledged && prefix < 0; candidate--)
+            if (progress_matches(recovered, &prefixes[candidate * LEVELS_COUNT]))
+                prefix = candidate;
+
+        // The recovered files must keep working.
+        bool usable = false;
+        if (prefix >= 0)
+        {
+            uint16_t* expected = &prefixes[prefix * LEVELS_COUNT];
+            uint16_t previous = expected[0];
+            expected[0] = 999;
+            levels_database_set_player_best(recovered, 0, 0, 999);
+            LevelsDatabase* reloaded = load_progress();
+            usable = progress_matches(reloaded, expected);
+            expected[0] = previous;
+            levels_database_free(reloaded);
+        }
+
+        runs += 1;
+        if (prefix < 0 || !usable)
+        {
+            failures += 1;
+            if (failures <= 5)
+                printf("failure at budget %lld: acknowledged %d, recovered prefix %d, usable %d\n", (long long)budget, acknowledged, prefix, usable);
+        }
+        else if (!finished && prefix > acknowledged)
+            inFlightKept += 1;
+
+        levels_database_free(recovered);
+        if (finished)
+            break;
+    }
+
+    printf("== crash ==\n");
+    printf("%-24s %10d\n", "power loss points", runs);
+    printf("%-24s %10d\n", "bad recoveries", failures);
+    printf("%-24s %10d\n", "in-flight save kept", inFlightKept);
+    printf("\n");
+
+    printf("%-10s %14s %14s %14s\n", "levels", "log entries", "recovery B", "recovery opens");
+    for (int levels = 1000; levels <= 100000; levels *= 10)
+    {
+        use_generated_database(levels / 100, 100);
+        LevelsDatabase* progress = load_progress();
+        levels_database_save_player_progress(progress);
+
+        // Recovery is what loading costs beyond reading the progress file, so loading is measured with and without a log.
+        host_storage_reset_stats();
+        levels_database_load_player_progress(progress);
+        HostStorageStats withoutLog = host_storage_stats();
+        for (int i = 0; i < PROGRESS_LOG_MAX_ENTRIES - 1; i++)
+            levels_database_set_player_best(progress, i % progress->collectionsCount, i, i + 1);
+        int logEntries = progress->progressLogCount;
+        host_storage_reset_stats();
+        levels_database_load_player_progress(progress);
+        HostStorageStats withLog = host_storage_stats();
+        printf("%-10d %14d %14llu %14lu\n", levels, logEntries, (unsigned long long)(withLog.bytesRead - withoutLog.bytesRead),
+               (unsigned long)(withLog.opens - withoutLog.opens));
+        levels_database_free(progress);
+    }
+    printf("\n");
+
+    free(prefixes);
+    free(savedLevels);
+    use_shipped_database();
+}
+
+// App startup against the number of levels: loading the database and the player progress, for the shipped level count
+// and 100 times it, with some progress saved. The first start also compiles database.txt, which is what every start used
+// to cost: one line read per level.
+static void bench_startup(LevelsDatabase* database)
+{
+    const int REPETITIONS = 50;
+    int shippedLevelsCount = 0;
+    for (int i = 0; i < database->collectionsCount; i++)
+        shippedLevelsCount += database->collections[i].levelsCount;
+
+    printf("== startup ==\n");
+    printf("%-10s %14s %14s %12s %12s %10s\n", "levels", "first start us", "compile B", "start us", "start B", "heap B");
+
+    for (int scale = 1; scale <= 100; scale *= 10)
+    {
+        const int COLLECTIONS = 2;
+        int levels = shippedLevelsCount * scale / COLLECTIONS;
+        use_generated_database(COLLECTIONS, levels);
+        char cachePath[512];
+        host_storage_resolve_path(cachePath, sizeof(cachePath), APP_DATA_PATH("database.bin"));
+        remove(cachePath);
+
+        host_storage_reset_stats();
+        double start = now_us();
+        LevelsDatabase* loaded = load_progress();
+        double firstStart = now_us() - start;
+        HostStorageStats compileStats = host_storage_stats();
+
+        random_state = 5;
+        for (int i = 0; i < 100; i++)
+            levels_database_set_player_best(loaded, next_random() % COLLECTIONS, next_random() % levels, next_random() % 300 + 1);
+        levels_database_compact_progress(loaded);
+        levels_database_free(loaded);
+
+        host_storage_reset_stats();
+        start = now_us();
+        for (int i = 0; i < REPETITIONS; i++)
+        {
+            loaded = load_progress();
+            if (i < REPETITIONS - 1)
+                levels_database_free(loaded);
+        }
+        double elapsed = (now_us() - start) / REPETITIONS;
+        HostStorageStats stats = host_storage_stats();
+        size_t heap = sizeof(LevelsDatabase) + loaded->collectionsCount * sizeof(LevelsCollection);
+        printf("%-10d %14.1f %14llu %12.1f %12llu %10zu\n", levels * COLLECTIONS, firstStart, (unsigned long long)compileStats.bytesRead,
+               elapsed, (unsigned long long)(stats.bytesRead / REPETITIONS), heap);
+        levels_database_free(loaded);
+    }
+    printf("\n");
+    use_shipped_database();
+}
+
+#define GENERATED_LEVEL_SIZE 128
+
+// A generated level to import: a walled room with some inner walls, and as many boxes as targets. One level in 7 is tall
+// enough to be rotated, and one in 1000 is larger than 50x50.
+static void generate_import_level(int levelIndex, CellType cells[GENERATED_LEVEL_SIZE][GENERATED_LEVEL_SIZE], int* ret_width, int* ret_height)
+{
+    random_state = levelIndex + 1;
+    int width = 7 + next_random() % 20, height = 7 + next_random() % 10;
+    if (levelIndex % 7 == 0)
+    {
+        width = 7 + next_random() % 2;
+        height = 12 + next_random() % 20;
+    }
+    if (levelIndex % 1000 == 500)
+    {
+        width = 60 + next_random() % 60;
+        height = 51 + next_random() % 20;
+    }
+
+    for (int y = 0; y < height; y++)
+        for (int x = 0; x < width; x++)
+            cells[y][x] = (x == 0 || y == 0 || x == width - 1 || y == height - 1 || next_random() % 10 == 0) ? CellHasWall : 0;
+
+    int boxesCount = 1 + next_random() % 6;
+    for (int i = 0; i < boxesCount * 2 + 1; i++)
+    {
+        int x, y;
+        do
+        {
+            x = 1 + next_random() % (width - 2);
+            y = 1 + next_random() % (height - 2);
+        } while (cells[y][x] != 0);
+        cells[y][x] = i < boxesCount ? CellHasTarget : i < boxesCount * 2 ? CellHasBox : CellHasPlayer;
+    }
+
+    *ret_width = width;
+    *ret_height = height;
+}
+
+static char cell_char(CellType cell, char floor)
+{
+    switch (cell)
+    {
+    case CellHasWall: return '#';
+    case CellHasBox: return '$';
+    case CellHasTarget: return '.';
+    case CellHasPlayer: return '@';
+    default: return floor;
+    }
+}
+
+// Writes a collection of generated levels with comments and titles around them. One level in 3 is run-length encoded on a
+// single line, and one level in 500 has two players, to be left out.
+static void write_import_source(const char* hostPath, int levelsCount)
+{
+    FILE* file = fopen(hostPath, "w");
+    fprintf(file, "Generated collection\n\n");
+    CellType cells[GENERATED_LEVEL_SIZE][GENERATED_LEVEL_SIZE];
+    for (int levelIndex = 0; levelIndex < levelsCount; levelIndex++)
+    {
+        int width, height;
+        generate_import_level(levelIndex, cells, &width, &height);
+        if (levelIndex % 500 == 499)
+            cells[1][1] = cells[height - 2][width - 2] = CellHasPlayer;
+
+        fprintf(file, "; %d\n", levelIndex + 1);
+        bool encoded = levelIndex % 3 == 1;
+        for (int y = 0; y < height; y++)
+        {
+            for (int x = 0; x < width;)
+            {
+                int run = 1;
+                while (encoded && x + run < width && cells[y][x + run] == cells[y][x])
+                    run += 1;
+                if (run > 1)
+                    fprintf(file, "%d", run);
+                fputc(cell_char(cells[y][x], encoded ? '-' : ' '), file);
+                x += run;
+            }
+            fputc(encoded && y < height - 1 ? '|' : '\n', file);
+        }
+        fprintf(file, "Title: Generated %d\nAuthor: bench\n\n", levelIndex + 1);
+    }
+    fclose(file);
+}
+
+static size_t importHeapBase, importHeapPeak;
+
+static void track_import_heap(void* context, const CollectionImportStats* stats)
+{
+    UNUSED(context);
+    UNUSED(stats);
+    importHeapPeak = MAX(importHeapPeak, mallinfo2().uordblks - importHeapBase);
+}
+
+// Checks a sample of the imported levels, large ones included, against the generated ones, through level_load and so
+// through their layout.
+static bool imported_levels_match(int levelsCount)
+{
+    CellType cells[GENERATED_LEVEL_SIZE][GENERATED_LEVEL_SIZE];
+    for (int levelIndex = 0; levelIndex < levelsCount; levelIndex++)
+    {
+        if (levelIndex % 500 == 499 || (levelIndex % 97 != 0 && levelIndex % 1000 != 500))
+            continue;
+        int width, height;
+        generate_import_level(levelIndex, cells, &width, &height);
+        Level* level = level_load("generated", levelIndex - (levelIndex + 1) / 500);
+        bool rotated = level->level_width != width;
+        bool match = level->level_width == (rotated ? height : width) && level->level_height == (rotated ? width : height);
+        for (int y = 0; y < height && match; y++)
+            for (int x = 0; x < width && match; x++)
+                match = level_get_cell(level, rotated ? y : x, rotated ? x : y) == cells[y][x];
+        level_free(level);
+        if (!match)
+            return false;
+    }
+    return true;
+}
+
+// Importing generated .sok collections of growing size: the heap used while importing must not grow with the collection.
+static void bench_import(LevelsDatabase* database)
+{
+    UNUSED(database);
+    const int SIZES[] = {1000, 10000};
+    use_generated_database(1, 10);
+
+    char sourceHostPath[512], packPath[256];
+    host_storage_resolve_path(sourceHostPath, sizeof(sourceHostPath), APP_ASSETS_PATH("generated.sok"));
+    collection_source_path(packPath, sizeof(packPath), "generated", "pack");
+
+    printf("== import ==\n");
+    printf("%-8s %10s %10s %8s %12s %12s %10s %8s %8s\n", "levels", "source B", "pack B", "ms", "read B", "written B", "heap B",
+           "skipped", "levels");
+
+    for (size_t sizeIndex = 0; sizeIndex < sizeof(SIZES) / sizeof(SIZES[0]); sizeIndex++)
+    {
+        write_import_source(sourceHostPath, SIZES[sizeIndex]);
+
+        CollectionImportStats stats;
+        importHeapBase = mallinfo2().uordblks;
+        importHeapPeak = 0;
+        host_storage_reset_stats();
+        double start = now_us();
+        bool imported = collection_import(NULL, APP_ASSETS_PATH("generated.sok"), packPath, track_import_heap, NULL, &stats);
+        double elapsed = now_us() - start;
+        HostStorageStats storageStats = host_storage_stats();
+
+        bool match = imported && stats.skippedCount == SIZES[sizeIndex] / 500 && imported_levels_match(SIZES[sizeIndex]);
+        printf("%-8d %10lu %10lu %8.1f %12llu %12llu %10zu %8d %8s\n", SIZES[sizeIndex], (unsigned long)stats.sourceSize,
+               (unsigned long)stats.packSize, elapsed / 1000, (unsigned long long)storageStats.bytesRead,
+               (unsigned long long)storageStats.bytesWritten, importHeapPeak, stats.skippedCount, match ? "match" : "MISMATCH");
+    }
+    printf("\n");
+    remove(sourceHostPath);
+    use_shipped_database();
+}
+
+// The drawing of a level before the game renderer: every cell of the level is drawn as an icon, on screen or not.
+static void draw_every_cell(Canvas* canvas, const Level* level, GameState* state)
+{
+    int cellSize = level->cell_size;
+    int levelWidth = level->level_width * cellSize;
+    int levelHeight = level->level_height * cellSize;
+
+    int cameraX = levelWidth / 2;
+    if (levelWidth > 128 + (cellSize - 1) * 2)
+        cameraX = MAX(64, MIN(state->playerX * cellSize, levelWidth - 64));
+    int cameraY = levelHeight / 2;
+    if (levelHeight > 64 + (cellSize - 1) * 2)
+        cameraY = MAX(32, MIN(state->playerY * cellSize, levelHeight - 32));
+
+    for (int row = 0; row < level->level_height; row++)
+    {
+        for (int column = 0; column < level->level_width; column++)
+        {
+            int x = column * cellSize - cameraX + 64;
+            int y = row * cellSize - cameraY + 32;
+            const Icon* icon = findIcon(game_state_get_cell(state, column, row), cellSize);
+            if (icon)
+                canvas_draw_icon(canvas, x, y, icon);
+            if (state->isDeadlocked && game_state_is_box_doomed(state, column, row))
+            {
+                canvas_draw_line(canvas, x, y, x + cellSize - 1, y + cellSize - 1);
+                canvas_draw_line(canvas, x + cellSize - 1, y, x, y + cellSize - 1);
+            }
+        }
+    }
+}
+
+// Returns the level with the largest board, in pixels, of a collection.
+static int find_largest_level(LevelsCollection* collection)
+{
+    int largestIndex = 0, largestArea = 0;
+    for (int levelIndex = 0; levelIndex < collection->levelsCount; levelIndex++)
+    {
+        Level* level = level_load(collection->name, levelIndex);
+        int area = level->level_width * level->level_height * level->cell_size * level->cell_size;
+        if (area > largestArea)
+        {
+            largestArea = area;
+            largestIndex = levelIndex;
+        }
+        level_free(level);
+    }
+    return largestIndex;
+}
+
+typedef struct RenderCost
+{
+    double time;
+    long frames, drawCalls, pixels;
+} RenderCost;
+
+static void add_render_cost(RenderCost* cost, Canvas* canvas, double time)
+{
+    HostCanvasStats stats = host_canvas_stats(canvas);
+    cost->time += time;
+    cost->frames += 1;
+    cost->drawCalls += stats.drawCalls;
+    cost->pixels += stats.pixelsVisited;
+}
+
+static void print_render_cost(const char* drawer, const RenderCost* cost, int ticks)
+{
+    printf("  %-14s %8ld %9.2f %9.1f %9ld\n", drawer, cost->frames, cost->time / ticks, (double)cost->drawCalls / MAX(1, cost->frames),
+           cost->pixels / MAX(1, cost->frames));
+}
+
+// Cost of drawing the largest level of each collection, over ticks of the game scene in which the player makes a move or
+// an undo one time out of three. It compares drawing every cell on every tick, as the scene did before the game renderer,
+// with the renderer drawing its frame on every tick, and with the renderer only drawing the ticks that changed something.
+// All of them must show the same pixels after every tick. Pixels are those the canvas visits, clipped or not.
+static void bench_render(LevelsDatabase* database)
+{
+    const int TICKS = 3000;
+    const int DIRECTIONS[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+
+    printf("== render ==\n");
+    Canvas* everyCellCanvas = host_canvas_alloc();
+    Canvas* alwaysCanvas = host_canvas_alloc();
+    Canvas* changedCanvas = host_canvas_alloc();
+    for (int collectionIndex = 0; collectionIndex < database->collectionsCount; collectionIndex++)
+    {
+        LevelsCollection* collection = &database->collections[collectionIndex];
+        int levelIndex = find_largest_level(collection);
+        Level* level = level_load(collection->name, levelIndex);
+        GameState* state = game_state_initialize(level);
+        GameRenderer* renderer = game_renderer_alloc(level);
+
+        RenderCost everyCell = {0}, always = {0}, changed = {0};
+        int scrolls = 0, dirtyCells = 0, mismatches = 0;
+        random_state = 1;
+        for (int tick = 0; tick < TICKS; tick++)
+        {
+            uint32_t random = next_random();
+            if (random % 3 == 0)
+            {
+                random = next_random();
+                if (random % 5 == 0)
+                    game_state_undo_move(state);
+                else
+                    game_state_apply_move(state, DIRECTIONS[random % 4][0], DIRECTIONS[random % 4][1]);
+            }
+
+            canvas_clear(everyCellCanvas);
+            host_canvas_reset_stats(everyCellCanvas);
+            double start = now_us();
+            draw_every_cell(everyCellCanvas, level, state);
+            add_render_cost(&everyCell, everyCellCanvas, now_us() - start);
+
+            int cameraX, cameraY, x, y;
+            game_renderer_cell_position(renderer, 0, 0, &cameraX, &cameraY);
+            bool isAllDirty = state->dirty.isAllDirty;
+            dirtyCells += state->dirty.count;
+
+            start = now_us();
+            bool isChanged = game_renderer_update(renderer, state);
+            double updateTime = now_us() - start;
+
+            game_renderer_cell_position(renderer, 0, 0, &x, &y);
+            if (isChanged && (x != cameraX || y != cameraY || isAllDirty))
+                scrolls += 1;
+
+            canvas_clear(alwaysCanvas);
+            host_canvas_reset_stats(alwaysCanvas);
+            start = now_us();
+            game_renderer_draw(renderer, alwaysCanvas, state);
+            add_render_cost(&always, alwaysCanvas, updateTime + now_us() - start);
+
+            // A tick that is not rendered leaves the screen as it was.
+            if (isChanged)
+            {
+                canvas_clear(changedCanvas);
+                host_canvas_reset_stats(changedCanvas);
+                start = now_us();
+                game_renderer_draw(renderer, changedCanvas, state);
+                add_render_cost(&changed, changedCanvas, updateTime + now_us() - start);
+            }
+            else
+                changed.time += updateTime;
+
+            if (memcmp(host_canvas_frame(everyCellCanvas), host_canvas_frame(changedCanvas), HOST_CANVAS_WIDTH * HOST_CANVAS_HEIGHT) != 0 ||
+                memcmp(host_canvas_frame(everyCellCanvas), host_canvas_frame(alwaysCanvas), HOST_CANVAS_WIDTH * HOST_CANVAS_HEIGHT) != 0)
+                mismatches += 1;
+        }
+
+        printf("%s level %d (%dx%d, %s, %s layer): %d ticks, %d full redraws, %.2f dirty cells per cell redraw\n", collection->name,
+               levelIndex + 1, level->level_width, level->level_height, game_renderer_has_frame(renderer) ? "frame" : "no frame",
+               game_renderer_has_layer(renderer) ? "with" : "no", TICKS, scrolls, (double)dirtyCells / MAX(1, changed.frames - scrolls));
+        printf("  %-14s %8s %9s %9s %9s\n", "drawer", "frames", "us/tick", "calls/f", "pixels/f");
+        print_render_cost("every cell", &everyCell, TICKS);
+        print_render_cost("every tick", &always, TICKS);
+        print_render_cost("changed ticks", &changed, TICKS);
+        printf("  CPU saved: %.0f%% against every cell, %.0f%% against every tick; mismatched ticks: %d\n",
+               100 * (1 - changed.time / everyCell.time), 100 * (1 - changed.time / always.time), mismatches);
+
+        game_renderer_free(renderer);
+        game_state_free(state);
+        level_free(level);
+    }
+    host_canvas_free(everyCellCanvas);
+    host_canvas_free(alwaysCanvas);
+    host_canvas_free(changedCanvas);
+    printf("\n");
+}
+
+#define WALK_LEVEL_SIZE 50
+
+// Writes square rooms of WALK_LEVEL_SIZE cells, with inner walls scattered in one cell out of four, and ten boxes.
+static void write_walk_source(const char* hostPath, int levelsCount)
+{
+    FILE* file = fopen(hostPath, "w");
+    CellType cells[WALK_LEVEL_SIZE][WALK_LEVEL_SIZE];
+    for (int levelIndex = 0; levelIndex < levelsCount; levelIndex++)
+    {
+        random_state = levelIndex + 1;
+        for (int y = 0; y < WALK_LEVEL_SIZE; y++)
+            for (int x = 0; x < WALK_LEVEL_SIZE; x++)
+                cells[y][x] = (x == 0 || y == 0 || x == WALK_LEVEL_SIZE - 1 || y == WALK_LEVEL_SIZE - 1 || next_random() % 4 == 0) ? CellHasWall : 0;
+        for (int i = 0; i < 21; i++)
+        {
+            int x, y;
+            do
+            {
+                x = 1 + next_random() % (WALK_LEVEL_SIZE - 2);
+                y = 1 + next_random() % (WALK_LEVEL_SIZE - 2);
+            } while (cells[y][x] != 0);
+            cells[y][x] = i < 10 ? CellHasTarget : i < 20 ? CellHasBox : CellHasPlayer;
+        }
+
+        for (int y = 0; y < WALK_LEVEL_SIZE; y++)
+        {
+            for (int x = 0; x < WALK_LEVEL_SIZE; x++)
+                fputc(cell_char(cells[y][x], ' '), file);
+            fputc('\n', file);
+        }
+        fprintf(file, "\n");
+    }
+    fclose(file);
+}
+
+// Cost of walking the player to a chosen cell on 50x50 levels: the breadth-first search, and applying the walk found as one
+// group, against applying its moves one by one. Undoing the group must take a single step back to where it started.
+static void bench_walk(LevelsDatabase* database)
+{
+    UNUSED(database);
+    const int LEVELS = 20;
+    const int SEARCHES = 200;
+    use_generated_database(1, LEVELS);
+
+    char sourceHostPath[512], packPath[256];
+    host_storage_resolve_path(sourceHostPath, sizeof(sourceHostPath), APP_ASSETS_PATH("generated.sok"));
+    collection_source_path(packPath, sizeof(packPath), "generated", "pack");
+    write_walk_source(sourceHostPath, LEVELS);
+    CollectionImportStats stats;
+    collection_import(NULL, APP_ASSETS_PATH("generated.sok"), packPath, NULL, NULL, &stats);
+
+    double searchTime = 0, groupTime = 0, singleTime = 0;
+    long searches = 0, walks = 0, nodes = 0, moves = 0, fullRedraws = 0, singleFullRedraws = 0;
+    size_t searchMemory = 0;
+    int badUndos = 0;
+    for (int levelIndex = 0; levelIndex < stats.levelsCount; levelIndex++)
+    {
+        Level* level = level_load("generated", levelIndex);
+        GameState* state = game_state_initialize(level);
+        random_state = levelIndex + 1;
+        for (int search = 0; search < SEARCHES; search++)
+        {
+            int x = next_random() % level->level_width, y = next_random() % level->level_height;
+            if (game_state_get_cell(state, x, y) & (CellHasWall | CellHasBox))
+                continue;
+
+            MacroMove walk;
+            double start = now_us();
+            bool isFound = macro_move_find_walk(state, x, y, &walk);
+            searchTime += now_us() - start;
+            searches += 1;
+            nodes += walk.nodesExpanded;
+            searchMemory = MAX(searchMemory, walk.searchMemory);
+            if (!isFound)
+                continue;
+
+            int position = game_state_position(state);
+            int playerX = state->playerX, playerY = state->playerY;
+            game_state_clear_dirty(state);
+            start = now_us();
+            game_state_apply_moves(state, walk.moves, walk.movesCount);
+            groupTime += now_us() - start;
+            fullRedraws += state->dirty.isAllDirty;
+            game_state_seek(state, game_state_undo_position(state));
+            badUndos += game_state_position(state) != position || state->playerX != playerX || state->playerY != playerY;
+
+            game_state_clear_dirty(state);
+            start = now_us();
+            for (int move = 0; move < walk.movesCount; move++)
+            {
+                int dx = walk.moves[move] == MoveLeft ? -1 : walk.moves[move] == MoveRight ? 1 : 0;
+                int dy = walk.moves[move] == MoveUp ? -1 : walk.moves[move] == MoveDown ? 1 : 0;
+                game_state_apply_move(state, dx, dy);
+            }
+            singleTime += now_us() - start;
+            singleFullRedraws += state->dirty.isAllDirty;
+            game_state_seek(state, position);
+
+            walks += 1;
+            moves += walk.movesCount;
+            macro_move_free(&walk);
+        }
+        game_state_free(state);
+        level_free(level);
+    }
+
+    printf("== walk ==\n");
+    printf("%d levels of %dx%d, %ld searches, %ld reachable\n", stats.levelsCount, WALK_LEVEL_SIZE, WALK_LEVEL_SIZE, searches, walks);
+    printf("%-26s %10.2f\n", "search us", searchTime / searches);
+    printf("%-26s %10.1f\n", "cells expanded", (double)nodes / searches);
+    printf("%-26s %10zu\n", "search memory B", searchMemory);
+    printf("%-26s %10.1f\n", "moves per walk", (double)moves / MAX(1, walks));
+    printf("%-26s %10.2f\n", "apply as a group us", groupTime / MAX(1, walks));
+    printf("%-26s %10.2f\n", "apply one by one us", singleTime / MAX(1, walks));
+    printf("%-26s %10ld\n", "groups dirtying all", fullRedraws);
+    printf("%-26s %10ld\n", "one by one dirtying all", singleFullRedraws);
+    printf("%-26s %10d\n", "undos not back to start", badUndos);
+    printf("\n");
+    remove(sourceHostPath);
+    use_shipped_database();
+}
+
+// Returns whether two states have their boxes in the same cells, but for one cell each.
+static bool boxes_match_but(GameState* a, GameState* b, int aX, int aY, int bX, int bY)
+{
+    for (int y = 0; y < a->levelHeight; y++)
+    {
+        for (int x = 0; x < a->levelWidth; x++)
+        {
+            if ((x == aX && y == aY) || (x == bX && y == bY))
+                continue;
+            if ((game_state_get_cell(a, x, y) & CellHasBox) != (game_state_get_cell(b, x, y) & CellHasBox))
+                return false;
+        }
+    }
+    return true;
+}
+
+// Cost of pushing a box to a chosen cell: for every box of every shipped level, a search to each target. Applying a push
+// found must leave the box there and every other box where it was, and undoing it must take a single step.
+static void bench_push(LevelsDatabase* database)
+{
+    double searchTime = 0;
+    long searches = 0, found = 0, nodes = 0, moves = 0, pushes = 0;
+    size_t searchMemory = 0;
+    int failures = 0;
+
+    for (int collectionIndex = 0; collectionIndex < database->collectionsCount; collectionIndex++)
+    {
+        LevelsCollection* collection = &database->collections[collectionIndex];
+        for (int levelIndex = 0; levelIndex < collection->levelsCount; levelIndex++)
+        {
+            Level* level = level_load(collection->name, levelIndex);
+            GameState* state = game_state_initialize(level);
+            GameState* start = game_state_initialize(level);
+            for (int boxY = 0; boxY < level->level_height; boxY++)
+            {
+                for (int boxX = 0; boxX < level->level_width; boxX++)
+                {
+                    if (!(game_state_get_cell(state, boxX, boxY) & CellHasBox))
+                        continue;
+                    for (int y = 0; y < level->level_height; y++)
+                    {
+                        for (int x = 0; x < level->level_width; x++)
+                        {
+                            if ((game_state_get_cell(state, x, y) & (CellHasTarget | CellHasBox)) != CellHasTarget)
+                                continue;
+
+                            MacroMove push;
+                            double begin = now_us();
+                            bool isFound = macro_move_find_push(state, boxX, boxY, x, y, MACRO_MOVE_MAX_PUSH_NODES, &push);
+                            searchTime += now_us() - begin;
+                            searches += 1;
+                            nodes += push.nodesExpanded;
+                            searchMemory = MAX(searchMemory, push.searchMemory);
+                            if (!isFound)
+                                continue;
+
+                            int position = game_state_position(state);
+                            int applied = game_state_apply_moves(state, push.moves, push.movesCount);
+                            bool isValid = applied == push.movesCount && (game_state_get_cell(state, x, y) & CellHasBox) &&
+                                           boxes_match_but(state, start, x, y, boxX, boxY);
+                            game_state_seek(state, game_state_undo_position(state));
+                            isValid &= game_state_position(state) == position && boxes_match_but(state, start, -1, -1, -1, -1);
+                            failures += !isValid;
+
+                            found += 1;
+                            moves += push.movesCount;
+                            for (int move = 0; move < push.movesCount; move++)
+                                pushes += (push.moves[move] & MoveBoxPushed) != 0;
+                            macro_move_free(&push);
+                        }
+                    }
+                }
+            }
+            game_state_free(start);
+            game_state_free(state);
+            level_free(level);
+        }
+    }
+
+    printf("== push ==\n");
+    printf("%ld searches of a box to a target, %ld found\n", searches, found);
+    printf("%-26s %10.2f\n", "search us", searchTime / searches);
+    printf("%-26s %10.1f\n", "nodes expanded", (double)nodes / searches);
+    printf("%-26s %10zu\n", "search memory max B", searchMemory);
+    printf("%-26s %10.1f\n", "moves per push macro", (double)moves / MAX(1, found));
+    printf("%-26s %10.1f\n", "pushes per push macro", (double)pushes / MAX(1, found));
+    printf("%-26s %10d\n", "failed checks", failures);
+    printf("\n");
+}
+
+// Cost of checking the known solutions of the shipped collections, with the levels as the game loads them, rotated or not.
+// The check only moves the player and the boxes; playing the same moves through the game rules, with the journal,
+// deadlock checks and dirty cells, is measured for comparison.
+static void bench_lurd(LevelsDatabase* database)
+{
+    const int ROUNDS = 20;
+
+    printf("== lurd ==\n");
+    printf("%-12s %9s %8s %8s %8s %10s %12s %10s %12s\n", "collection", "solutions", "failed", "rotated", "moves", "check ms", "check mv/s", "play ms", "play mv/s");
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    for (int collectionIndex = 0; collectionIndex < database->collectionsCount; collectionIndex++)
+    {
+        LevelsCollection* collection = &database->collections[collectionIndex];
+        SolutionsReader* reader = solutions_reader_open(storage, collection->name, 65536);
+        if (reader == NULL)
+            continue;
+
+        int solutionsCount = 0, failures = 0, rotatedCount = 0;
+        long movesCount = 0;
+        double checkTime = 0, playTime = 0;
+        const char* solution;
+        for (int levelIndex = 0; levelIndex < collection->levelsCount && solutions_reader_next(reader, &solution); levelIndex++)
+        {
+            if (solution == NULL || solution[0] == '\0')
+                continue;
+            Level* level = level_load(collection->name, levelIndex);
+            int worldBest = levels_database_get_level(database, collectionIndex, levelIndex).worldBest;
+
+            LurdCheck check;
+            double start = now_us();
+            for (int round = 0; round < ROUNDS; round++)
+                game_state_check_lurd(level, solution, &check);
+            checkTime += (now_us() - start) / ROUNDS;
+
+            GameState* state = game_state_initialize(level);
+            start = now_us();
+            int played = 0;
+            while (solution[played] != '\0' && game_state_apply_lurd_move(state, solution[played]))
+                played += 1;
+            playTime += now_us() - start;
+
+            failures += check.illegalMove >= 0 || !check.isCompleted || check.pushesCount != worldBest ||
+                        played != check.movesCount || !state->isCompleted;
+            solutionsCount += 1;
+            rotatedCount += level->is_rotated;
+            movesCount += check.movesCount;
+            game_state_free(state);
+            level_free(level);
+        }
+        solutions_reader_free(reader);
+
+        printf("%-12s %9d %8d %8d %8ld %10.3f %12.0f %10.3f %12.0f\n", collection->name, solutionsCount, failures, rotatedCount, movesCount, checkTime / 1000, movesCount / checkTime * 1e6, playTime / 1000, movesCount / playTime * 1e6);
+    }
+    furi_record_close(RECORD_STORAGE);
+    printf("\n");
+}
+
+// Boxes hash of a state computed from scratch, to check the one the state keeps as it moves.
+static uint64_t hash_boxes(GameState* state)
+{
+    uint64_t hash = 0;
+    for (int y = 0; y < state->levelHeight; y++)
+        for (int x = 0; x < state->levelWidth; x++)
+            if (game_state_get_cell(state, x, y) & CellHasBox)
+                hash ^= game_state_box_key(y * state->levelWidth + x);
+    return hash;
+}
+
+// Cost of compact positions. Random walks over every shipped level encode each position they go through, and check the
+// boxes hash the state keeps against one computed from scratch. Then a million keys go through stores of several sizes,
+// to measure lookups and what the replacement keeps once a store is full.
+static void bench_store(LevelsDatabase* database)
+{
+    const int OPERATIONS = 20000, KEYS_COUNT = 1000000;
+    const size_t STORE_SIZES[] = {16 * 1024, 64 * 1024, 1024 * 1024, 16 * 1024 * 1024};
+    const int DIRECTIONS[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+
+    int levelsCount = 0, hashMismatches = 0, maxKeySize = 0;
+    long keyBytes = 0, stateBytes = 0, encodes = 0;
+    double encodeTime = 0;
+    const char* longestCollection = NULL;
+    int longestLevel = 0;
+    for (int collectionIndex = 0; collectionIndex < database->collectionsCount; collectionIndex++)
+    {
+        LevelsCollection* collection = &database->collections[collectionIndex];
+        for (int levelIndex = 0; levelIndex < collection->levelsCount; levelIndex++)
+        {
+            Level* level = level_load(collection->name, levelIndex);
+            GameState* state = game_state_initialize(level);
+            StateEncoder* encoder = state_encoder_alloc(level);
+            int keySize = state_encoder_key_size(encoder);
+            uint8_t* key = malloc(keySize);
+            if (keySize > maxKeySize)
+            {
+                maxKeySize = keySize;
+                longestCollection = collection->name;
+                longestLevel = levelIndex;
+            }
+
+            random_state = 1;
+            for (int i = 0; i < OPERATIONS; i++)
+            {
+                uint32_t random = next_random();
+                if (random % 5 == 0)
+                    game_state_undo_move(state);
+                else
+                    game_state_apply_move(state, DIRECTIONS[random % 4][0], DIRECTIONS[random % 4][1]);
+
+                double start = now_us();
+                state_encoder_encode(encoder, state, key);
+                encodeTime += now_us() - start;
+                encodes += 1;
+                hashMismatches += state->boxesHash != hash_boxes(state);
+            }
+            // Seeking restores keyframes, which rebuild the hash.
+            game_state_seek(state, game_state_first_position(state));
+            hashMismatches += state->boxesHash != hash_boxes(state);
+
+            levelsCount += 1;
+            keyBytes += keySize;
+            stateBytes += game_state_memory_size(state);
+            free(key);
+            state_encoder_free(encoder);
+            game_state_free(state);
+            level_free(level);
+        }
+    }
+
+    printf("== store ==\n");
+    printf("%d levels, %ld positions encoded\n", levelsCount, encodes);
+    printf("%-26s %10.1f\n", "key bytes avg", (double)keyBytes / levelsCount);
+    printf("%-26s %10d\n", "key bytes max", maxKeySize);
+    printf("%-26s %10.1f\n", "GameState bytes avg", (double)stateBytes / levelsCount);
+    printf("%-26s %10.1f\n", "encode ns", encodeTime * 1000 / encodes);
+    printf("%-26s %10d\n", "boxes hash mismatches", hashMismatches);
+
+    // Random walks come back to the same few positions, too few to fill a store, so the stores are filled with keys
+    // drawn at random, of the length of the longest keys, and hashed from the same Zobrist keys. Keys and hashes are drawn
+    // beforehand, so the stores are measured apart from the encoding.
+    int keySize = maxKeySize;
+    uint8_t* keys = malloc((size_t)KEYS_COUNT * keySize);
+    uint64_t* hashes = malloc(KEYS_COUNT * sizeof(uint64_t));
+    random_state = 1;
+    for (int i = 0; i < KEYS_COUNT; i++)
+    {
+        hashes[i] = 0;
+        for (int byte = 0; byte < keySize; byte++)
+        {
+            keys[(size_t)i * keySize + byte] = next_random() & 0xFF;
+            hashes[i] ^= game_state_box_key(byte << 8 | keys[(size_t)i * keySize + byte]);
+        }
+    }
+
+    printf("\n%d keys of %d bytes (%s level %d), found %% of all and of the last quarter added\n", KEYS_COUNT, keySize, longestCollection, longestLevel + 1);
+    printf("%-10s %10s %10s %10s %10s %12s %12s %10s %10s\n", "store", "capacity", "stored", "replaced", "B/state", "inserts/s", "lookups/s", "found %", "recent %");
+    for (size_t size = 0; size < sizeof(STORE_SIZES) / sizeof(STORE_SIZES[0]); size++)
+    {
+        StateStore* store = state_store_alloc(keySize, STORE_SIZES[size]);
+        double start = now_us();
+        for (int i = 0; i < KEYS_COUNT; i++)
+            state_store_insert(store, hashes[i], keys + (size_t)i * keySize);
+        double insertTime = now_us() - start;
+
+        int found = 0, recentFound = 0;
+        start = now_us();
+        for (int i = 0; i < KEYS_COUNT; i++)
+        {
+            bool isFound = state_store_contains(store, hashes[i], keys + (size_t)i * keySize);
+            found += isFound;
+            recentFound += isFound && i >= KEYS_COUNT * 3 / 4;
+        }
+        double lookupTime = now_us() - start;
+
+        char sizeName[24];
+        snprintf(sizeName, sizeof(sizeName), "%zu KB", STORE_SIZES[size] / 1024);
+        printf("%-10s %10d %10d %10d %10.1f %12.0f %12.0f %10.1f %10.1f\n", sizeName, state_store_capacity(store), state_store_count(store), state_store_replaced_count(store),
+               (double)state_store_memory_size(store) / state_store_count(store), KEYS_COUNT / insertTime * 1e6, KEYS_COUNT / lookupTime * 1e6, found * 100.0 / KEYS_COUNT, recentFound * 100.0 / (KEYS_COUNT / 4));
+        state_store_free(store);
+    }
+    printf("\n");
+
+    free(keys);
+    free(hashes);
+}
+
+// The icon lookup before the table: a switch on the cell flags, and then on the cell size.
+static const Icon* find_icon_switch(CellType cellType, int size)
+{
+    switch (cellType)
+    {
+    case CellHasWall:
+        return size == 5 ? &I_cell_wall_5 : size == 7 ? &I_cell_wall_7 : size == 9 ? &I_cell_wall_9 : NULL;
+    case CellHasBox:
+        return size == 5 ? &I_cell_box_5 : size == 7 ? &I_cell_box_7 : size == 9 ? &I_cell_box_9 : NULL;
+    case CellHasTarget:
+        return size == 5 ? &I_cell_target_5 : size == 7 ? &I_cell_target_7 : size == 9 ? &I_cell_target_9 : NULL;
+    case CellHasPlayer:
+        return size == 5 ? &I_cell_player_5 : size == 7 ? &I_cell_player_7 : size == 9 ? &I_cell_player_9 : NULL;
+    case CellHasBox | CellHasTarget:
+        return size == 5 ? &I_cell_box_target_5 : size == 7 ? &I_cell_box_target_7 : size == 9 ? &I_cell_box_target_9 : NULL;
+    case CellHasPlayer | CellHasTarget:
+        return size == 5 ? &I_cell_player_target_5 : size == 7 ? &I_cell_player_target_7 : size == 9 ? &I_cell_player_target_9 : NULL;
+    default:
+        return NULL;
+    }
+}
+
+// Cost of finding the icon of a cell, with the switch and with the table, over the starting position of every level, and
+// the throughput of drawing every cell with each. Also the flag combinations that only the table has an icon for.
+static void bench_icons(LevelsDatabase* database)
+{
+    const int REPETITIONS = 50;
+    const struct
+    {
+        const char* name;
+        const Icon* (*find)(CellType, int);
+    } LOOKUPS[] = {{"switch", find_icon_switch}, {"table", findIcon}};
+
+    printf("== icons ==\n");
+    printf("%-8s %10s %14s\n", "lookup", "ns/cell", "cells/ms drawn");
+
+    Canvas* canvas = host_canvas_alloc();
+    for (size_t lookup = 0; lookup < sizeof(LOOKUPS) / sizeof(LOOKUPS[0]); lookup++)
+    {
+        double lookupTime = 0, drawTime = 0;
+        long cellsCount = 0;
+        uintptr_t sink = 0;
+        for (int collectionIndex = 0; collectionIndex < database->collectionsCount; collectionIndex++)
+        {
+            LevelsCollection* collection = &database->collections[collectionIndex];
+            for (int levelIndex = 0; levelIndex < collection->levelsCount; levelIndex++)
+            {
+                Level* level = level_load(collection->name, levelIndex);
+                GameState* state = game_state_initialize(level);
+                int width = level->level_width, height = level->level_height, cellSize = level->cell_size;
+                CellType* cells = malloc(width * height);
+                for (int y = 0; y < height; y++)
+                    for (int x = 0; x < width; x++)
+                        cells[y * width + x] = game_state_get_cell(state, x, y);
+
+                double start = now_us();
+                for (int repetition = 0; repetition < REPETITIONS; repetition++)
+                    for (int cell = 0; cell < width * height; cell++)
+                        sink += (uintptr_t)LOOKUPS[lookup].find(cells[cell], cellSize);
+                lookupTime += now_us() - start;
+
+                start = now_us();
+                for (int y = 0; y < height; y++)
+                {
+                    for (int x = 0; x < width; x++)
+                    {
+                        const Icon* icon = LOOKUPS[lookup].find(cells[y * width + x], cellSize);
+                        if (icon)
+                            canvas_draw_icon(canvas, (x * cellSize) % HOST_CANVAS_WIDTH, (y * cellSize) % HOST_CANVAS_HEIGHT, icon);
+                    }
+                }
+                drawTime += now_us() - start;
+
+                cellsCount += width * height;
+                free(cells);
+                game_state_free(state);
+                level_free(level);
+            }
+        }
+        printf("%-8s %10.2f %14.0f%s\n", LOOKUPS[lookup].name, lookupTime * 1000 / (cellsCount * REPETITIONS), cellsCount / (drawTime / 1000),
+               sink == 0 ? " (no cells)" : "");
+    }
+    host_canvas_free(canvas);
+
+    printf("with an icon only in the table:");
+    for (int flags = 0; flags < 16; flags++)
+        if (findIcon(flags, 7) != NULL && find_icon_switch(flags, 7) == NULL)
+            printf(" %s%s%s%s", flags & CellHasWall ? "W" : "", flags & CellHasBox ? "B" : "", flags & CellHasTarget ? "T" : "", flags & CellHasPlayer ? "P" : "");
+    printf("\n\n");
+}
+
+static const struct
+{
+    const char* name;
+    void (*run)(LevelsDatabase*);
+} BENCHMARKS[] = {
+    {"load", bench_level_load},
+    {"moves", bench_moves},
+    {"memory", bench_memory},
+    {"deadlocks", bench_deadlocks},
+    {"hint", bench_hint},
+    {"journal", bench_journal},
+    {"seek", bench_seek},
+    {"session", bench_session},
+    {"save", bench_save},
+    {"crash", bench_crash},
+    {"startup", bench_startup},
+    {"import", bench_import},
+    {"render", bench_render},
+    {"icons", bench_icons},
+    {"walk", bench_walk},
+    {"push", bench_push},
+    {"lurd", bench_lurd},
+    {"store", bench_store},
+};
+static const int BENCHMARKS_COUNT = sizeof(BENCHMARKS) / sizeof(BENCHMARKS[0]);
+
+int main(int argc, char** argv)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        bool known = false;
+        for (int benchmark = 0; benchmark < BENCHMARKS_COUNT; benchmark++)
+            known |= strcmp(argv[i], BENCHMARKS[benchmark].name) == 0;
+        if (!known)
+        {
+            fprintf(stderr, "Unknown benchmark: %s\nAvailable:", argv[i]);
+            for (int benchmark = 0; benchmark < BENCHMARKS_COUNT; benchmark++)
+                fprintf(stderr, " %s", BENCHMARKS[benchmark].name);
+            fprintf(stderr, "\n");
+            return 1;
+        }
+    }
+
+#ifdef SOKOBAN_BOARD_GRID
+    printf("Board backend: char grid\n\n");
+#else
+    printf("Board backend: bit planes\n\n");
+#endif
+
+    remember_shipped_database();
+    LevelsDatabase* database = levels_database_load();
+    for (int benchmark = 0; benchmark < BENCHMARKS_COUNT; benchmark++)
+    {
+        bool selected = argc == 1;
+        for (int i = 1; i < argc; i++)
+            selected |= strcmp(argv[i], BENCHMARKS[benchmark].name) == 0;
+        if (selected)
+            BENCHMARKS[benchmark].run(database);
+    }
+    levels_database_free(database);
+    return 0;
+}
@@ -0,0 +1,400 @@
+#include "collection_import.h"
+
+#include "board.h"
+#include "level.h"
+#include "level_pack.h"
+#include "wave/files/buffered_reader.h"
+#include <furi.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define READ_BUFFER_SIZE 256
+#define WRITE_BUFFER_SIZE 64
+#define DIRECTORY_BUFFER_ENTRIES 16
+#define MAX_REPEAT MAX_BOARD_SIZE
+
+typedef struct Importer
+{
+    File* pack;
+    File* directory;
+    bool writeFailed;
+    CollectionImportStats stats;
+    CollectionImportCallback callback;
+    void* context;
+
+    uint8_t writeBuffer[WRITE_BUFFER_SIZE];
+    int writeLength;
+    uint8_t bitsByte;
+    int bitsCount;
+
+    LevelPackEntry entries[DIRECTORY_BUFFER_ENTRIES];
+    int entriesCount;
+
+    // The level being read, as written, row by row. Cells past the end of a row are empty. The buffer grows to fit the
+    // largest level read so far.
+    CellType* cells;
+    int stride, rowsCapacity;
+    int rowsCount, columnsCount;
+    bool tooLarge;
+
+    // The line being read. It is taken as board rows until one of its characters shows otherwise, and then its rows are
+    // dropped again.
+    int lineFirstRow, lineColumnsCount;
+    int column;
+    int repeat;
+    bool lineIsRow, lineHasWall, lineTooLarge;
+} Importer;
+
+static void write_checked(Importer* importer, File* file, const void* data, size_t size)
+{
+    if (!importer->writeFailed && storage_file_write(file, data, size) != size)
+        importer->writeFailed = true;
+}
+
+static void flush_pack(Importer* importer)
+{
+    write_checked(importer, importer->pack, importer->writeBuffer, importer->writeLength);
+    importer->writeLength = 0;
+}
+
+static void write_pack_byte(Importer* importer, uint8_t byte)
+{
+    importer->writeBuffer[importer->writeLength++] = byte;
+    importer->stats.packSize += 1;
+    if (importer->writeLength == WRITE_BUFFER_SIZE)
+        flush_pack(importer);
+}
+
+static void end_plane(Importer* importer)
+{
+    if (importer->bitsCount == 0)
+        return;
+    write_pack_byte(importer, importer->bitsByte);
+    importer->bitsByte = 0;
+    importer->bitsCount = 0;
+}
+
+static void write_bit(Importer* importer, bool bit)
+{
+    if (bit)
+        importer->bitsByte |= 1 << importer->bitsCount;
+    if (++importer->bitsCount == 8)
+        end_plane(importer);
+}
+
+static void flush_directory(Importer* importer)
+{
+    write_checked(importer, importer->directory, importer->entries, importer->entriesCount * sizeof(LevelPackEntry));
+    importer->entriesCount = 0;
+}
+
+// Writes the level being read to the pack. Returns a reason to leave it out instead, or NULL.
+static const char* write_level(Importer* importer)
+{
+    if (importer->tooLarge)
+        return "too large";
+    if (importer->stats.levelsCount >= LEVEL_PACK_MAX_LEVELS)
+        return "too many levels";
+
+    int playersCount = 0, boxesCount = 0, targetsCount = 0;
+    LevelPackEntry entry = {0};
+    for (int row = 0; row < importer->rowsCount; row++)
+    {
+        for (int column = 0; column < importer->columnsCount; column++)
+        {
+            CellType cell = importer->cells[row * importer->stride + column];
+            if (cell & CellHasPlayer)
+            {
+                playersCount += 1;
+                entry.playerX = column;
+                entry.playerY = row;
+            }
+            boxesCount += (cell & CellHasBox) != 0;
+            targetsCount += (cell & CellHasTarget) != 0;
+        }
+    }
+    if (playersCount != 1)
+        return "not one player";
+    if (boxesCount == 0 || boxesCount != targetsCount)
+        return "boxes and targets do not match";
+
+    int cellSize;
+    bool rotated;
+    level_choose_layout(importer->columnsCount, importer->rowsCount, &cellSize, &rotated);
+    entry.offset = importer->stats.packSize;
+    entry.width = importer->columnsCount;
+    entry.height = importer->rowsCount;
+    entry.boxesCount = boxesCount;
+    entry.cellSize = cellSize;
+    entry.flags = rotated ? LEVEL_PACK_ROTATED : 0;
+
+    const CellType planeFlags[LEVEL_PACK_PLANES_COUNT] = {CellHasWall, CellHasTarget, CellHasBox};
+    for (int plane = 0; plane < LEVEL_PACK_PLANES_COUNT; plane++)
+    {
+        for (int row = 0; row < importer->rowsCount; row++)
+            for (int column = 0; column < importer->columnsCount; column++)
+                write_bit(importer, importer->cells[row * importer->stride + column] & planeFlags[plane]);
+        end_plane(importer);
+    }
+
+    importer->entries[importer->entriesCount++] = entry;
+    if (importer->entriesCount == DIRECTORY_BUFFER_ENTRIES)
+        flush_directory(importer);
+    return NULL;
+}
+
+static void end_level(Importer* importer)
+{
+    if (importer->rowsCount == 0 && !importer->tooLarge)
+        return;
+
+    const char* skipReason = write_level(importer);
+    if (skipReason == NULL)
+        importer->stats.levelsCount += 1;
+    else
+    {
+        importer->stats.skippedCount += 1;
+        FURI_LOG_W("GAME", "Level %d left out: %s", importer->stats.levelsCount + importer->stats.skippedCount, skipReason);
+    }
+
+    importer->rowsCount = importer->columnsCount = 0;
+    importer->tooLarge = false;
+    if (importer->callback != NULL)
+        importer->callback(importer->context, &importer->stats);
+}
+
+static void start_line(Importer* importer)
+{
+    importer->lineFirstRow = importer->rowsCount;
+    importer->lineColumnsCount = importer->columnsCount;
+    importer->column = 0;
+    importer->repeat = 0;
+    importer->lineIsRow = true;
+    importer->lineHasWall = importer->lineTooLarge = false;
+}
+
+static int grown_size(int size, int needed)
+{
+    while (size < needed)
+        size = size == 0 ? 16 : size * 2;
+    return MIN(size, MAX_BOARD_SIZE);
+}
+
+// Makes room for a level of the given size. Returns false if the level is too large.
+static bool reserve_cells(Importer* importer, int rowsCount, int columnsCount)
+{
+    if (rowsCount > MAX_BOARD_SIZE || columnsCount > MAX_BOARD_SIZE)
+        return false;
+    if (rowsCount <= importer->rowsCapacity && columnsCount <= importer->stride)
+        return true;
+
+    int stride = grown_size(importer->stride, columnsCount);
+    int rowsCapacity = grown_size(importer->rowsCapacity, rowsCount);
+    CellType* cells = calloc(stride * rowsCapacity, sizeof(CellType));
+    for (int row = 0; row < importer->rowsCapacity; row++)
+        memcpy(cells + row * stride, importer->cells + row * importer->stride, importer->stride);
+    free(importer->cells);
+    importer->cells = cells;
+    importer->stride = stride;
+    importer->rowsCapacity = rowsCapacity;
+    return true;
+}
+
+static void end_row(Importer* importer)
+{
+    if (!reserve_cells(importer, importer->rowsCount + 1, importer->column))
+    {
+        importer->lineTooLarge = true;
+        return;
+    }
+
+    CellType* row = importer->cells + importer->rowsCount * importer->stride;
+    memset(row + importer->column, 0, importer->stride - importer->column);
+    importer->columnsCount = MAX(importer->columnsCount, importer->column);
+    importer->rowsCount += 1;
+    importer->column = 0;
+}
+
+static void end_line(Importer* importer)
+{
+    if (importer->lineIsRow && importer->lineHasWall)
+    {
+        if (importer->column > 0)
+            end_row(importer);
+        importer->tooLarge |= importer->lineTooLarge;
+    }
+    else
+    {
+        importer->rowsCount = importer->lineFirstRow;
+        importer->columnsCount = importer->lineColumnsCount;
+        end_level(importer);
+    }
+    start_line(importer);
+}
+
+static void put_cells(Importer* importer, CellType cell)
+{
+    int count = importer->repeat > 0 ? importer->repeat : 1;
+    importer->repeat = 0;
+    for (int i = 0; i < count; i++)
+    {
+        if (!reserve_cells(importer, importer->rowsCount + 1, importer->column + 1))
+        {
+            importer->lineTooLarge = true;
+            return;
+        }
+        importer->cells[importer->rowsCount * importer->stride + importer->column++] = cell;
+    }
+}
+
+static void read_char(Importer* importer, char ch)
+{
+    if (ch == '\r')
+        return;
+    if (ch == '\n')
+    {
+        end_line(importer);
+        return;
+    }
+    if (!importer->lineIsRow)
+        return;
+
+    switch (ch)
+    {
+    case '#':
+        importer->lineHasWall = true;
+        put_cells(importer, CellHasWall);
+        break;
+    case '*':
+        put_cells(importer, CellHasBox | CellHasTarget);
+        break;
+    case '.':
+        put_cells(importer, CellHasTarget);
+        break;
+    case '@':
+        put_cells(importer, CellHasPlayer);
+        break;
+    case '+':
+        put_cells(importer, CellHasPlayer | CellHasTarget);
+        break;
+    case '$':
+        put_cells(importer, CellHasBox);
+        break;
+    case ' ':
+    case '-':
+    case '_':
+        put_cells(importer, 0);
+        break;
+    case '|':
+        end_row(importer);
+        break;
+    default:
+        if (ch >= '0' && ch <= '9')
+            importer->repeat = MIN(importer->repeat * 10 + ch - '0', MAX_REPEAT);
+        else
+            importer->lineIsRow = false;
+        break;
+    }
+}
+
+// Appends the directory to the pack, and fills in the header.
+static void finish_pack(Importer* importer, const char* directoryPath)
+{
+    flush_pack(importer);
+    flush_directory(importer);
+    storage_file_close(importer->directory);
+
+    LevelPackHeader header = {
+        .magic = LEVEL_PACK_MAGIC,
+        .version = LEVEL_PACK_VERSION,
+        .levelsCount = importer->stats.levelsCount,
+        .sourceSize = importer->stats.sourceSize,
+        .directoryOffset = importer->stats.packSize,
+    };
+
+    if (!storage_file_open(importer->directory, directoryPath, FSAM_READ, FSOM_OPEN_EXISTING))
+        importer->writeFailed = true;
+    size_t read;
+    while (!importer->writeFailed && (read = storage_file_read(importer->directory, importer->writeBuffer, WRITE_BUFFER_SIZE)) > 0)
+    {
+        write_checked(importer, importer->pack, importer->writeBuffer, read);
+        importer->stats.packSize += read;
+    }
+    storage_file_close(importer->directory);
+
+    storage_file_seek(importer->pack, 0, true);
+    write_checked(importer, importer->pack, &header, sizeof(header));
+    if (!storage_file_sync(importer->pack))
+        importer->writeFailed = true;
+    storage_file_close(importer->pack);
+}
+
+bool collection_import(Storage* storage, const char* sourcePath, const char* packPath, CollectionImportCallback callback,
+                       void* context, CollectionImportStats* ret_stats)
+{
+    char temporaryPath[256], directoryPath[256];
+    snprintf(temporaryPath, sizeof(temporaryPath), "%s.tmp", packPath);
+    snprintf(directoryPath, sizeof(directoryPath), "%s.dir", packPath);
+
+    FileInfo sourceInfo;
+    if (storage_common_stat(storage, sourcePath, &sourceInfo) != FSE_OK)
+    {
+        FURI_LOG_E("GAME", "Collection not found: %s", sourcePath);
+        return false;
+    }
+
+    File* source = storage_file_alloc(storage);
+    Importer* importer = malloc(sizeof(Importer));
+    memset(importer, 0, sizeof(Importer));
+    importer->pack = storage_file_alloc(storage);
+    importer->directory = storage_file_alloc(storage);
+    importer->callback = callback;
+    importer->context = context;
+    importer->stats.sourceSize = sourceInfo.size;
+
+    bool opened = storage_file_open(source, sourcePath, FSAM_READ, FSOM_OPEN_EXISTING)
+        && storage_file_open(importer->pack, temporaryPath, FSAM_WRITE, FSOM_CREATE_ALWAYS)
+        && storage_file_open(importer->directory, directoryPath, FSAM_WRITE, FSOM_CREATE_ALWAYS);
+
+    bool success = false;
+    if (opened)
+    {
+        // The header is written once the directory offset is known.
+        LevelPackHeader header = {0};
+        write_checked(importer, importer->pack, &header, sizeof(header));
+        importer->stats.packSize = sizeof(header);
+
+        BufferedReader* reader = bufferedReader_alloc(source, READ_BUFFER_SIZE);
+        start_line(importer);
+        while (!buffered_reader_is_eof(reader) && !importer->writeFailed)
+            read_char(importer, buffered_reader_read_char(reader));
+        end_line(importer);
+        buffered_reader_free(reader);
+
+        finish_pack(importer, directoryPath);
+        success = !importer->writeFailed;
+    }
+    else
+        FURI_LOG_E("GAME", "Failed to open files to import: %s", sourcePath);
+
+    storage_file_free(source);
+    storage_file_free(importer->pack);
+    storage_file_free(importer->directory);
+    storage_common_remove(storage, directoryPath);
+
+    if (success)
+        success = storage_common_rename(storage, temporaryPath, packPath) == FSE_OK;
+    if (success)
+        FURI_LOG_I("GAME", "Imported %d levels into %s, %d left out", importer->stats.levelsCount, packPath, importer->stats.skippedCount);
+    else
+    {
+        FURI_LOG_E("GAME", "Failed to write level pack: %s", packPath);
+        storage_common_remove(storage, temporaryPath);
+    }
+
+    if (ret_stats != NULL)
+        *ret_stats = importer->stats;
+    free(importer->cells);
+    free(importer);
+    return success;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <storage/storage.h>
+
+// Imports a level collection in the common Sokoban text formats (.xsb, .sok, .txt) into a level pack (see level_pack.h).
+// The source is read one character at a time and only the level being read is held in memory, so collections of any size
+// can be imported with the memory of their largest level. Importing is host only: tools/level_compiler writes the packs
+// that the app ships in its assets.
+//
+// Board rows may be run-length encoded ("3#" for "###", with "|" between rows), and "-" or "_" may stand for floor.
+// Any other line ends the level before it and is skipped: titles, authors, comments, level numbers and blank lines.
+// Levels that are larger than MAX_BOARD_SIZE, or that are not playable (not exactly one player, or not as many boxes as
+// targets), are left out.
+
+typedef struct CollectionImportStats
+{
+    int levelsCount;  // Levels written to the pack.
+    int skippedCount; // Levels left out.
+    uint32_t sourceSize;
+    uint32_t packSize;
+} CollectionImportStats;
+
+// Called after each level of the source, written or left out.
+typedef void (*CollectionImportCallback)(void* context, const CollectionImportStats* stats);
+
+// Imports the levels of a source file into a pack. The pack is written to a temporary file, and only replaces packPath
+// once it is complete. Returns false if the source can not be read, or if the pack can not be written.
+bool collection_import(Storage* storage, const char* sourcePath, const char* packPath, CollectionImportCallback callback,
+                       void* context, CollectionImportStats* ret_stats);
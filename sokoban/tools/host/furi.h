@@ -0,0 +1,38 @@
+// Minimal stand-in for the Flipper Zero furi API, so the game engine sources can be built and measured on a Linux host.
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define RECORD_STORAGE "storage"
+
+#define UNUSED(x) (void)(x)
+
+#ifndef MAX
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+#endif
+#ifndef MIN
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#endif
+
+void host_log(char level, const char* tag, const char* format, ...);
+void host_crash(const char* message) __attribute__((noreturn));
+
+#define FURI_LOG_E(tag, ...) host_log('E', tag, __VA_ARGS__)
+#define FURI_LOG_W(tag, ...) host_log('W', tag, __VA_ARGS__)
+#define FURI_LOG_I(tag, ...) host_log('I', tag, __VA_ARGS__)
+#define FURI_LOG_D(tag, ...) host_log('D', tag, __VA_ARGS__)
+#define FURI_LOG_T(tag, ...) host_log('T', tag, __VA_ARGS__)
+
+#define furi_crash(message) host_crash(message)
+#define furi_check(condition, ...) ((condition) ? (void)0 : host_crash(#condition))
+#define furi_assert(condition) furi_check(condition)
+
+void* furi_record_open(const char* name);
+void furi_record_close(const char* name);
+
+uint32_t furi_get_tick(void);
+size_t memmgr_get_free_heap(void);
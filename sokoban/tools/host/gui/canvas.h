@@ -0,0 +1,27 @@
+// Minimal stand-in for the Flipper Zero canvas API, drawing into an in-memory 128x64 frame. See host_canvas.h.
+#pragma once
+
+#include <gui/icon.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct Canvas Canvas;
+
+typedef enum
+{
+    ColorWhite,
+    ColorBlack,
+    ColorXOR,
+} Color;
+
+void canvas_clear(Canvas* canvas);
+void canvas_set_color(Canvas* canvas, Color color);
+size_t canvas_width(const Canvas* canvas);
+size_t canvas_height(const Canvas* canvas);
+
+void canvas_draw_dot(Canvas* canvas, int32_t x, int32_t y);
+void canvas_draw_box(Canvas* canvas, int32_t x, int32_t y, size_t width, size_t height);
+void canvas_draw_frame(Canvas* canvas, int32_t x, int32_t y, size_t width, size_t height);
+void canvas_draw_line(Canvas* canvas, int32_t x1, int32_t y1, int32_t x2, int32_t y2);
+void canvas_draw_xbm(Canvas* canvas, int32_t x, int32_t y, size_t width, size_t height, const uint8_t* bitmap);
+void canvas_draw_icon(Canvas* canvas, int32_t x, int32_t y, const Icon* icon);
@@ -0,0 +1,4 @@
+// Minimal stand-in for the Flipper Zero GUI API: only the canvas and icons, which the game renderer draws with.
+#pragma once
+
+#include <gui/canvas.h>
@@ -0,0 +1,17 @@
+// Minimal stand-in for the Flipper Zero icon API. Frames start with a compression header byte, as on the device.
+#pragma once
+
+#include <stdint.h>
+
+typedef struct Icon
+{
+    uint16_t width;
+    uint16_t height;
+    uint8_t frame_count;
+    uint8_t frame_rate;
+    const uint8_t* const* frames;
+} Icon;
+
+uint16_t icon_get_width(const Icon* icon);
+uint16_t icon_get_height(const Icon* icon);
+const uint8_t* icon_get_data(const Icon* icon);
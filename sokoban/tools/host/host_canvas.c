@@ -0,0 +1,171 @@
+#include "host_canvas.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+struct Canvas
+{
+    uint8_t frame[HOST_CANVAS_HEIGHT][HOST_CANVAS_WIDTH];
+    Color color;
+    HostCanvasStats stats;
+};
+
+Canvas* host_canvas_alloc(void)
+{
+    Canvas* canvas = calloc(1, sizeof(Canvas));
+    canvas->color = ColorBlack;
+    return canvas;
+}
+
+void host_canvas_free(Canvas* canvas)
+{
+    free(canvas);
+}
+
+void host_canvas_reset_stats(Canvas* canvas)
+{
+    memset(&canvas->stats, 0, sizeof(canvas->stats));
+}
+
+HostCanvasStats host_canvas_stats(const Canvas* canvas)
+{
+    return canvas->stats;
+}
+
+const uint8_t* host_canvas_frame(const Canvas* canvas)
+{
+    return &canvas->frame[0][0];
+}
+
+static void set_pixel(Canvas* canvas, int32_t x, int32_t y)
+{
+    canvas->stats.pixelsVisited += 1;
+    if (x < 0 || x >= HOST_CANVAS_WIDTH || y < 0 || y >= HOST_CANVAS_HEIGHT)
+        return;
+    uint8_t* pixel = &canvas->frame[y][x];
+    *pixel = canvas->color == ColorXOR ? !*pixel : canvas->color == ColorBlack;
+}
+
+void canvas_clear(Canvas* canvas)
+{
+    canvas->stats.drawCalls += 1;
+    memset(canvas->frame, 0, sizeof(canvas->frame));
+}
+
+void canvas_set_color(Canvas* canvas, Color color)
+{
+    canvas->color = color;
+}
+
+size_t canvas_width(const Canvas* canvas)
+{
+    (void)canvas;
+    return HOST_CANVAS_WIDTH;
+}
+
+size_t canvas_height(const Canvas* canvas)
+{
+    (void)canvas;
+    return HOST_CANVAS_HEIGHT;
+}
+
+void canvas_draw_dot(Canvas* canvas, int32_t x, int32_t y)
+{
+    canvas->stats.drawCalls += 1;
+    set_pixel(canvas, x, y);
+}
+
+void canvas_draw_box(Canvas* canvas, int32_t x, int32_t y, size_t width, size_t height)
+{
+    canvas->stats.drawCalls += 1;
+    for (int32_t row = 0; row < (int32_t)height; row++)
+        for (int32_t column = 0; column < (int32_t)width; column++)
+            set_pixel(canvas, x + column, y + row);
+}
+
+void canvas_draw_frame(Canvas* canvas, int32_t x, int32_t y, size_t width, size_t height)
+{
+    canvas->stats.drawCalls += 1;
+    for (int32_t column = 0; column < (int32_t)width; column++)
+    {
+        set_pixel(canvas, x + column, y);
+        set_pixel(canvas, x + column, y + height - 1);
+    }
+    for (int32_t row = 1; row < (int32_t)height - 1; row++)
+    {
+        set_pixel(canvas, x, y + row);
+        set_pixel(canvas, x + width - 1, y + row);
+    }
+}
+
+void canvas_draw_line(Canvas* canvas, int32_t x1, int32_t y1, int32_t x2, int32_t y2)
+{
+    canvas->stats.drawCalls += 1;
+    int32_t dx = abs(x2 - x1), dy = -abs(y2 - y1);
+    int32_t stepX = x1 < x2 ? 1 : -1, stepY = y1 < y2 ? 1 : -1;
+    int32_t error = dx + dy;
+    while (true)
+    {
+        set_pixel(canvas, x1, y1);
+        if (x1 == x2 && y1 == y2)
+            break;
+        int32_t doubled = 2 * error;
+        if (doubled >= dy)
+        {
+            error += dy;
+            x1 += stepX;
+        }
+        if (doubled <= dx)
+        {
+            error += dx;
+            y1 += stepY;
+        }
+    }
+}
+
+// Like u8g2, rows that miss the frame are skipped whole, and the pixels of the other rows are clipped one by one. Only set
+// bits are drawn.
+static void draw_xbm(Canvas* canvas, int32_t x, int32_t y, size_t width, size_t height, const uint8_t* bitmap)
+{
+    size_t rowBytes = (width + 7) / 8;
+    for (size_t row = 0; row < height; row++)
+    {
+        if (y + (int32_t)row < 0 || y + (int32_t)row >= HOST_CANVAS_HEIGHT || x >= HOST_CANVAS_WIDTH || x + (int32_t)width <= 0)
+            continue;
+        for (size_t column = 0; column < width; column++)
+        {
+            if ((bitmap[row * rowBytes + column / 8] >> (column % 8)) & 1)
+                set_pixel(canvas, x + column, y + row);
+            else
+                canvas->stats.pixelsVisited += 1;
+        }
+    }
+}
+
+void canvas_draw_xbm(Canvas* canvas, int32_t x, int32_t y, size_t width, size_t height, const uint8_t* bitmap)
+{
+    canvas->stats.drawCalls += 1;
+    draw_xbm(canvas, x, y, width, height, bitmap);
+}
+
+void canvas_draw_icon(Canvas* canvas, int32_t x, int32_t y, const Icon* icon)
+{
+    canvas->stats.drawCalls += 1;
+    // The host icons are never compressed.
+    draw_xbm(canvas, x, y, icon->width, icon->height, icon->frames[0] + 1);
+}
+
+uint16_t icon_get_width(const Icon* icon)
+{
+    return icon->width;
+}
+
+uint16_t icon_get_height(const Icon* icon)
+{
+    return icon->height;
+}
+
+const uint8_t* icon_get_data(const Icon* icon)
+{
+    return icon->frames[0];
+}
@@ -0,0 +1,27 @@
+// Host-only controls for the canvas stand-in.
+//
+// The canvas is a 128x64 frame of one byte per pixel. Drawing visits every pixel of what is drawn, clipping each one,
+// much like the device's u8g2 does, so the time spent drawing is comparable between renderers.
+#pragma once
+
+#include <gui/canvas.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#define HOST_CANVAS_WIDTH 128
+#define HOST_CANVAS_HEIGHT 64
+
+typedef struct HostCanvasStats
+{
+    uint32_t drawCalls;
+    uint64_t pixelsVisited;
+} HostCanvasStats;
+
+Canvas* host_canvas_alloc(void);
+void host_canvas_free(Canvas* canvas);
+
+void host_canvas_reset_stats(Canvas* canvas);
+HostCanvasStats host_canvas_stats(const Canvas* canvas);
+
+// Returns the frame, row by row, one byte per pixel: 1 for black.
+const uint8_t* host_canvas_frame(const Canvas* canvas);
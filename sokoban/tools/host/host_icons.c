@@ -0,0 +1,75 @@
+// The cell icons of ../../images, converted for the host canvas: dark opaque pixels are set. Frames are stored
+// uncompressed, behind the header byte the device build puts in front of them.
+#include "racso_sokoban_icons.h"
+
+static const uint8_t _I_cell_box_5_0[] = {0x00, 0x00, 0x0e, 0x0a, 0x0e, 0x00};
+static const uint8_t* const _I_cell_box_5[] = {_I_cell_box_5_0};
+const Icon I_cell_box_5 = {.width = 5, .height = 5, .frame_count = 1, .frame_rate = 0, .frames = _I_cell_box_5};
+
+static const uint8_t _I_cell_box_7_0[] = {0x00, 0x00, 0x3e, 0x22, 0x22, 0x22, 0x3e, 0x00};
+static const uint8_t* const _I_cell_box_7[] = {_I_cell_box_7_0};
+const Icon I_cell_box_7 = {.width = 7, .height = 7, .frame_count = 1, .frame_rate = 0, .frames = _I_cell_box_7};
+
+static const uint8_t _I_cell_box_9_0[] = {0x00, 0xfe, 0x00, 0x83, 0x01, 0x45, 0x01, 0x29, 0x01, 0x11, 0x01, 0x29, 0x01, 0x45, 0x01, 0x83, 0x01, 0xfe, 0x00};
+static const uint8_t* const _I_cell_box_9[] = {_I_cell_box_9_0};
+const Icon I_cell_box_9 = {.width = 9, .height = 9, .frame_count = 1, .frame_rate = 0, .frames = _I_cell_box_9};
+
+static const uint8_t _I_cell_box_target_5_0[] = {0x00, 0x00, 0x0e, 0x0e, 0x0e, 0x00};
+static const uint8_t* const _I_cell_box_target_5[] = {_I_cell_box_target_5_0};
+const Icon I_cell_box_target_5 = {.width = 5, .height = 5, .frame_count = 1, .frame_rate = 0, .frames = _I_cell_box_target_5};
+
+static const uint8_t _I_cell_box_target_7_0[] = {0x00, 0x00, 0x3e, 0x36, 0x2a, 0x36, 0x3e, 0x00};
+static const uint8_t* const _I_cell_box_target_7[] = {_I_cell_box_target_7_0};
+const Icon I_cell_box_target_7 = {.width = 7, .height = 7, .frame_count = 1, .frame_rate = 0, .frames = _I_cell_box_target_7};
+
+static const uint8_t _I_cell_box_target_9_0[] = {0x00, 0xfe, 0x00, 0xff, 0x01, 0xc7, 0x01, 0xab, 0x01, 0x93, 0x01, 0xab, 0x01, 0xc7, 0x01, 0xff, 0x01, 0xfe, 0x00};
+static const uint8_t* const _I_cell_box_target_9[] = {_I_cell_box_target_9_0};
+const Icon I_cell_box_target_9 = {.width = 9, .height = 9, .frame_count = 1, .frame_rate = 0, .frames = _I_cell_box_target_9};
+
+static const uint8_t _I_cell_player_5_0[] = {0x00, 0x00, 0x04, 0x0e, 0x04, 0x00};
+static const uint8_t* const _I_cell_player_5[] = {_I_cell_player_5_0};
+const Icon I_cell_player_5 = {.width = 5, .height = 5, .frame_count = 1, .frame_rate = 0, .frames = _I_cell_player_5};
+
+static const uint8_t _I_cell_player_7_0[] = {0x00, 0x00, 0x1c, 0x3e, 0x3e, 0x3e, 0x1c, 0x00};
+static const uint8_t* const _I_cell_player_7[] = {_I_cell_player_7_0};
+const Icon I_cell_player_7 = {.width = 7, .height = 7, .frame_count = 1, .frame_rate = 0, .frames = _I_cell_player_7};
+
+static const uint8_t _I_cell_player_9_0[] = {0x00, 0x00, 0x00, 0x38, 0x00, 0x7c, 0x00, 0xfe, 0x00, 0xfe, 0x00, 0xfe, 0x00, 0x7c, 0x00, 0x38, 0x00, 0x00, 0x00};
+static const uint8_t* const _I_cell_player_9[] = {_I_cell_player_9_0};
+const Icon I_cell_player_9 = {.width = 9, .height = 9, .frame_count = 1, .frame_rate = 0, .frames = _I_cell_player_9};
+
+static const uint8_t _I_cell_player_target_5_0[] = {0x00, 0x00, 0x04, 0x0a, 0x04, 0x00};
+static const uint8_t* const _I_cell_player_target_5[] = {_I_cell_player_target_5_0};
+const Icon I_cell_player_target_5 = {.width = 5, .height = 5, .frame_count = 1, .frame_rate = 0, .frames = _I_cell_player_target_5};
+
+static const uint8_t _I_cell_player_target_7_0[] = {0x00, 0x00, 0x1c, 0x2a, 0x36, 0x2a, 0x1c, 0x00};
+static const uint8_t* const _I_cell_player_target_7[] = {_I_cell_player_target_7_0};
+const Icon I_cell_player_target_7 = {.width = 7, .height = 7, .frame_count = 1, .frame_rate = 0, .frames = _I_cell_player_target_7};
+
+static const uint8_t _I_cell_player_target_9_0[] = {0x00, 0x00, 0x00, 0xba, 0x00, 0x7c, 0x00, 0xfe, 0x00, 0xee, 0x00, 0xfe, 0x00, 0x7c, 0x00, 0xba, 0x00, 0x00, 0x00};
+static const uint8_t* const _I_cell_player_target_9[] = {_I_cell_player_target_9_0};
+const Icon I_cell_player_target_9 = {.width = 9, .height = 9, .frame_count = 1, .frame_rate = 0, .frames = _I_cell_player_target_9};
+
+static const uint8_t _I_cell_target_5_0[] = {0x00, 0x00, 0x0a, 0x04, 0x0a, 0x00};
+static const uint8_t* const _I_cell_target_5[] = {_I_cell_target_5_0};
+const Icon I_cell_target_5 = {.width = 5, .height = 5, .frame_count = 1, .frame_rate = 0, .frames = _I_cell_target_5};
+
+static const uint8_t _I_cell_target_7_0[] = {0x00, 0x00, 0x2a, 0x14, 0x2a, 0x14, 0x2a, 0x00};
+static const uint8_t* const _I_cell_target_7[] = {_I_cell_target_7_0};
+const Icon I_cell_target_7 = {.width = 7, .height = 7, .frame_count = 1, .frame_rate = 0, .frames = _I_cell_target_7};
+
+static const uint8_t _I_cell_target_9_0[] = {0x00, 0x00, 0x00, 0xaa, 0x00, 0x00, 0x00, 0x82, 0x00, 0x10, 0x00, 0x82, 0x00, 0x00, 0x00, 0xaa, 0x00, 0x00, 0x00};
+static const uint8_t* const _I_cell_target_9[] = {_I_cell_target_9_0};
+const Icon I_cell_target_9 = {.width = 9, .height = 9, .frame_count = 1, .frame_rate = 0, .frames = _I_cell_target_9};
+
+static const uint8_t _I_cell_wall_5_0[] = {0x00, 0x1f, 0x1f, 0x1f, 0x1f, 0x1f};
+static const uint8_t* const _I_cell_wall_5[] = {_I_cell_wall_5_0};
+const Icon I_cell_wall_5 = {.width = 5, .height = 5, .frame_count = 1, .frame_rate = 0, .frames = _I_cell_wall_5};
+
+static const uint8_t _I_cell_wall_7_0[] = {0x00, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f, 0x7f};
+static const uint8_t* const _I_cell_wall_7[] = {_I_cell_wall_7_0};
+const Icon I_cell_wall_7 = {.width = 7, .height = 7, .frame_count = 1, .frame_rate = 0, .frames = _I_cell_wall_7};
+
+static const uint8_t _I_cell_wall_9_0[] = {0x00, 0xff, 0x01, 0xff, 0x01, 0xff, 0x01, 0xff, 0x01, 0xff, 0x01, 0xff, 0x01, 0xff, 0x01, 0xff, 0x01, 0xff, 0x01};
+static const uint8_t* const _I_cell_wall_9[] = {_I_cell_wall_9_0};
+const Icon I_cell_wall_9 = {.width = 9, .height = 9, .frame_count = 1, .frame_rate = 0, .frames = _I_cell_wall_9};
@@ -0,0 +1,315 @@
+#include "host_storage.h"
+
+#include <furi.h>
+#include <storage/storage.h>
+#include <stdarg.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+struct File
+{
+    FILE* handle;
+};
+
+static HostStorageStats stats;
+
+// Mutations left before the simulated power loss, or -1 when no fault is armed.
+static int64_t faultBudget = -1;
+static bool faulted = false;
+
+void host_log(char level, const char* tag, const char* format, ...)
+{
+    const char* verbose = getenv("SOKOBAN_LOG");
+    if (verbose == NULL)
+        return;
+    if (level == 'D' && strcmp(verbose, "debug") != 0 && strcmp(verbose, "trace") != 0)
+        return;
+    if (level == 'T' && strcmp(verbose, "trace") != 0)
+        return;
+
+    va_list args;
+    va_start(args, format);
+    fprintf(stderr, "[%c][%s] ", level, tag);
+    vfprintf(stderr, format, args);
+    fprintf(stderr, "\n");
+    va_end(args);
+}
+
+void host_crash(const char* message)
+{
+    fprintf(stderr, "furi_crash: %s\n", message);
+    abort();
+}
+
+void* furi_record_open(const char* name)
+{
+    UNUSED(name);
+    return NULL;
+}
+
+void furi_record_close(const char* name)
+{
+    UNUSED(name);
+}
+
+uint32_t furi_get_tick(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint32_t)(now.tv_sec * 1000 + now.tv_nsec / 1000000);
+}
+
+static size_t freeHeapOverride = 0;
+
+void host_set_free_heap(size_t bytes)
+{
+    freeHeapOverride = bytes;
+}
+
+size_t memmgr_get_free_heap(void)
+{
+    if (freeHeapOverride != 0)
+        return freeHeapOverride;
+    return 64 * 1024 * 1024;
+}
+
+void host_storage_reset_stats(void)
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
+HostStorageStats host_storage_stats(void)
+{
+    return stats;
+}
+
+void host_storage_set_fault_budget(int64_t mutations)
+{
+    faultBudget = mutations;
+    faulted = false;
+}
+
+bool host_storage_faulted(void)
+{
+    return faulted;
+}
+
+// Takes up to `count` mutations from the fault budget, and returns how many may go through.
+static size_t fault_consume(size_t count)
+{
+    if (faulted)
+        return 0;
+    if (faultBudget < 0)
+        return count;
+    if ((int64_t)count > faultBudget)
+    {
+        count = faultBudget;
+        faulted = true;
+    }
+    faultBudget -= count;
+    return count;
+}
+
+static void resolve_prefix(char* output, int size, const char* path, const char* prefix, const char* variable, const char* fallback)
+{
+    const char* root = getenv(variable);
+    if (root == NULL)
+        root = fallback;
+    snprintf(output, size, "%s%s", root, path + strlen(prefix));
+}
+
+void host_storage_resolve_path(char* output, int size, const char* path)
+{
+    if (strncmp(path, STORAGE_APP_ASSETS_PATH_PREFIX "/", strlen(STORAGE_APP_ASSETS_PATH_PREFIX "/")) == 0)
+        resolve_prefix(output, size, path, STORAGE_APP_ASSETS_PATH_PREFIX, "SOKOBAN_ASSETS", "../levels");
+    else if (strncmp(path, STORAGE_APP_DATA_PATH_PREFIX "/", strlen(STORAGE_APP_DATA_PATH_PREFIX "/")) == 0)
+    {
+        resolve_prefix(output, size, path, STORAGE_APP_DATA_PATH_PREFIX, "SOKOBAN_DATA", "/tmp/sokoban_data");
+        char folder[512];
+        resolve_prefix(folder, sizeof(folder), STORAGE_APP_DATA_PATH_PREFIX "/", STORAGE_APP_DATA_PATH_PREFIX, "SOKOBAN_DATA", "/tmp/sokoban_data");
+        mkdir(folder, 0755);
+    }
+    else
+        snprintf(output, size, "%s", path);
+}
+
+File* storage_file_alloc(Storage* storage)
+{
+    UNUSED(storage);
+    File* file = malloc(sizeof(File));
+    file->handle = NULL;
+    return file;
+}
+
+void storage_file_free(File* file)
+{
+    storage_file_close(file);
+    free(file);
+}
+
+bool storage_file_open(File* file, const char* path, FS_AccessMode access_mode, FS_OpenMode open_mode)
+{
+    char hostPath[512];
+    host_storage_resolve_path(hostPath, sizeof(hostPath), path);
+
+    bool exists = access(hostPath, F_OK) == 0;
+    if (open_mode == FSOM_OPEN_EXISTING && !exists)
+        return false;
+    if (open_mode == FSOM_CREATE_NEW && exists)
+        return false;
+
+    // Creating or emptying a file is a mutation.
+    bool mutates = open_mode == FSOM_CREATE_ALWAYS || open_mode == FSOM_CREATE_NEW || ((access_mode & FSAM_WRITE) && !exists);
+    if (mutates && fault_consume(1) == 0)
+        return false;
+
+    const char* mode;
+    if (open_mode == FSOM_CREATE_ALWAYS || open_mode == FSOM_CREATE_NEW)
+        mode = (access_mode & FSAM_READ) ? "w+b" : "wb";
+    else if (open_mode == FSOM_OPEN_APPEND)
+        mode = (access_mode & FSAM_READ) ? "a+b" : "ab";
+    else if (!exists)
+        mode = "w+b";
+    else
+        mode = (access_mode & FSAM_WRITE) ? "r+b" : "rb";
+
+    file->handle = fopen(hostPath, mode);
+    stats.opens += 1;
+    return file->handle != NULL;
+}
+
+bool storage_file_close(File* file)
+{
+    if (file->handle == NULL)
+        return false;
+    fclose(file->handle);
+    file->handle = NULL;
+    return true;
+}
+
+bool storage_file_is_open(File* file)
+{
+    return file->handle != NULL;
+}
+
+size_t storage_file_read(File* file, void* buff, size_t bytes_to_read)
+{
+    size_t count = fread(buff, 1, bytes_to_read, file->handle);
+    stats.bytesRead += count;
+    return count;
+}
+
+size_t storage_file_write(File* file, const void* buff, size_t bytes_to_write)
+{
+    size_t count = fwrite(buff, 1, fault_consume(bytes_to_write), file->handle);
+    stats.bytesWritten += count;
+    stats.writes += 1;
+    return count;
+}
+
+bool storage_file_seek(File* file, uint32_t offset, bool from_start)
+{
+    stats.seeks += 1;
+    return fseek(file->handle, offset, from_start ? SEEK_SET : SEEK_CUR) == 0;
+}
+
+uint64_t storage_file_tell(File* file)
+{
+    return ftell(file->handle);
+}
+
+uint64_t storage_file_size(File* file)
+{
+    long position = ftell(file->handle);
+    fseek(file->handle, 0, SEEK_END);
+    long size = ftell(file->handle);
+    fseek(file->handle, position, SEEK_SET);
+    return size;
+}
+
+bool storage_file_truncate(File* file)
+{
+    fflush(file->handle);
+    if (fault_consume(1) == 0)
+        return false;
+    return ftruncate(fileno(file->handle), ftell(file->handle)) == 0;
+}
+
+bool storage_file_sync(File* file)
+{
+    stats.syncs += 1;
+    return fflush(file->handle) == 0 && !faulted;
+}
+
+bool storage_file_eof(File* file)
+{
+    return storage_file_tell(file) >= storage_file_size(file);
+}
+
+FS_Error storage_common_stat(Storage* storage, const char* path, FileInfo* fileinfo)
+{
+    UNUSED(storage);
+    char hostPath[512];
+    host_storage_resolve_path(hostPath, sizeof(hostPath), path);
+
+    struct stat info;
+    if (stat(hostPath, &info) != 0)
+        return FSE_NOT_EXIST;
+    if (fileinfo != NULL)
+    {
+        fileinfo->flags = 0;
+        fileinfo->size = info.st_size;
+    }
+    return FSE_OK;
+}
+
+FS_Error storage_common_timestamp(Storage* storage, const char* path, uint32_t* timestamp)
+{
+    UNUSED(storage);
+    char hostPath[512];
+    host_storage_resolve_path(hostPath, sizeof(hostPath), path);
+
+    struct stat info;
+    if (stat(hostPath, &info) != 0)
+        return FSE_NOT_EXIST;
+    *timestamp = (uint32_t)info.st_mtime;
+    return FSE_OK;
+}
+
+FS_Error storage_common_remove(Storage* storage, const char* path)
+{
+    UNUSED(storage);
+    char hostPath[512];
+    host_storage_resolve_path(hostPath, sizeof(hostPath), path);
+    if (access(hostPath, F_OK) != 0)
+        return FSE_NOT_EXIST;
+    if (fault_consume(1) == 0)
+        return FSE_INTERNAL;
+    return remove(hostPath) == 0 ? FSE_OK : FSE_INTERNAL;
+}
+
+FS_Error storage_common_rename(Storage* storage, const char* old_path, const char* new_path)
+{
+    UNUSED(storage);
+    char oldHostPath[512], newHostPath[512];
+    host_storage_resolve_path(oldHostPath, sizeof(oldHostPath), old_path);
+    host_storage_resolve_path(newHostPath, sizeof(newHostPath), new_path);
+
+    // Like the device, an existing destination is removed first: a power loss in between leaves neither file there.
+    if (access(newHostPath, F_OK) == 0)
+    {
+        if (fault_consume(1) == 0)
+            return FSE_INTERNAL;
+        remove(newHostPath);
+    }
+    if (fault_consume(1) == 0)
+        return FSE_INTERNAL;
+    return rename(oldHostPath, newHostPath) == 0 ? FSE_OK : FSE_INTERNAL;
+}
+
+bool storage_file_exists(Storage* storage, const char* path)
+{
+    return storage_common_stat(storage, path, NULL) == FSE_OK;
+}
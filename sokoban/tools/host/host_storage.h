@@ -0,0 +1,29 @@
+// Host-only controls for the storage stand-in.
+//
+// Paths under "/assets" are mapped to $SOKOBAN_ASSETS (default: ../levels), and paths under "/data" to
+// $SOKOBAN_DATA (default: /tmp/sokoban_data). Any other path is used as is.
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct HostStorageStats
+{
+    uint64_t bytesRead, bytesWritten;
+    uint32_t opens, seeks, syncs, writes;
+} HostStorageStats;
+
+void host_storage_reset_stats(void);
+HostStorageStats host_storage_stats(void);
+
+void host_storage_resolve_path(char* output, int size, const char* path);
+
+// Simulates a power loss after this many storage mutations: bytes written, plus one for each file created, truncated,
+// removed or renamed. The mutation that runs out of budget is cut short, and every later one fails, until the budget is
+// set again. A negative budget disarms the fault.
+void host_storage_set_fault_budget(int64_t mutations);
+bool host_storage_faulted(void);
+
+// Overrides what memmgr_get_free_heap() reports, to simulate memory pressure. 0 restores the default (64 MB).
+void host_set_free_heap(size_t bytes);
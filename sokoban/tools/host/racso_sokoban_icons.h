@@ -0,0 +1,23 @@
+// Stand-in for the icon header generated by the Flipper Zero build. Only the cell icons are available on the host.
+#pragma once
+
+#include <gui/icon.h>
+
+extern const Icon I_cell_box_5;
+extern const Icon I_cell_box_7;
+extern const Icon I_cell_box_9;
+extern const Icon I_cell_box_target_5;
+extern const Icon I_cell_box_target_7;
+extern const Icon I_cell_box_target_9;
+extern const Icon I_cell_player_5;
+extern const Icon I_cell_player_7;
+extern const Icon I_cell_player_9;
+extern const Icon I_cell_player_target_5;
+extern const Icon I_cell_player_target_7;
+extern const Icon I_cell_player_target_9;
+extern const Icon I_cell_target_5;
+extern const Icon I_cell_target_7;
+extern const Icon I_cell_target_9;
+extern const Icon I_cell_wall_5;
+extern const Icon I_cell_wall_7;
+extern const Icon I_cell_wall_9;
@@ -0,0 +1,103 @@
+// Compiles collection texts into binary level packs, and the levels database into database.bin. See scripts/level_pack.h
+// and scripts/levels_database.h for the formats.
+//
+//   level_compiler [-o <output folder>] [-d] [-i <source file>] <collection name>...
+//
+// Collections are read from $SOKOBAN_ASSETS (default: ../levels), and packs are written next to them unless -o is given.
+// With -i, the next collection is imported from any .xsb or .sok file instead. With -d, database.txt is compiled too.
+#include "collection_import.h"
+#include "collection_index.h"
+#include "host/host_storage.h"
+#include "level_pack.h"
+#include "levels_database.h"
+
+#include <furi.h>
+#include <storage/storage.h>
+#include <string.h>
+
+static bool compile_collection(const char* collectionName, const char* sourceFile, const char* outputFolder)
+{
+    char sourcePath[256], hostSourcePath[512], packPath[256], hostPackPath[512];
+    collection_source_path(sourcePath, sizeof(sourcePath), collectionName, "txt");
+    if (sourceFile != NULL)
+        snprintf(sourcePath, sizeof(sourcePath), "%s", sourceFile);
+    host_storage_resolve_path(hostSourcePath, sizeof(hostSourcePath), sourcePath);
+    collection_source_path(packPath, sizeof(packPath), collectionName, "pack");
+    host_storage_resolve_path(hostPackPath, sizeof(hostPackPath), packPath);
+    if (outputFolder != NULL)
+        snprintf(hostPackPath, sizeof(hostPackPath), "%s%s", outputFolder, strrchr(packPath, '/'));
+
+    CollectionImportStats stats;
+    if (!collection_import(NULL, sourcePath, hostPackPath, NULL, NULL, &stats))
+    {
+        fprintf(stderr, "%s: cannot compile into %s\n", hostSourcePath, hostPackPath);
+        return false;
+    }
+
+    printf("%s: %d levels, %lu bytes of text -> %lu bytes packed\n", hostPackPath, stats.levelsCount, (unsigned long)stats.sourceSize,
+           (unsigned long)stats.packSize);
+
+    // The shipped collections are also read from their text, by level number, so every level must make it into the pack.
+    if (stats.skippedCount > 0)
+    {
+        fprintf(stderr, "%s: %d levels left out\n", hostSourcePath, stats.skippedCount);
+        return false;
+    }
+    return true;
+}
+
+static bool compile_database(const char* outputFolder)
+{
+    char hostSourcePath[512], hostOutputPath[512];
+    host_storage_resolve_path(hostSourcePath, sizeof(hostSourcePath), APP_ASSETS_PATH("database.txt"));
+    host_storage_resolve_path(hostOutputPath, sizeof(hostOutputPath), APP_ASSETS_PATH("database.bin"));
+    if (outputFolder != NULL)
+        snprintf(hostOutputPath, sizeof(hostOutputPath), "%s/database.bin", outputFolder);
+
+    if (!levels_database_compile(NULL, APP_ASSETS_PATH("database.txt"), hostOutputPath))
+    {
+        fprintf(stderr, "%s: cannot compile\n", hostSourcePath);
+        return false;
+    }
+
+    FileInfo sourceInfo, outputInfo;
+    storage_common_stat(NULL, APP_ASSETS_PATH("database.txt"), &sourceInfo);
+    storage_common_stat(NULL, hostOutputPath, &outputInfo);
+    printf("%s: %lu bytes of text -> %lu bytes compiled\n", hostOutputPath, (unsigned long)sourceInfo.size, (unsigned long)outputInfo.size);
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    const char* outputFolder = NULL;
+    const char* sourceFile = NULL;
+    bool success = true;
+    int collectionsCount = 0;
+    bool compileDatabase = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+            outputFolder = argv[++i];
+        else if (strcmp(argv[i], "-i") == 0 && i + 1 < argc)
+            sourceFile = argv[++i];
+        else if (strcmp(argv[i], "-d") == 0)
+            compileDatabase = true;
+        else
+        {
+            success &= compile_collection(argv[i], sourceFile, outputFolder);
+            sourceFile = NULL;
+            collectionsCount += 1;
+        }
+    }
+
+    if (compileDatabase)
+        success &= compile_database(outputFolder);
+
+    if (collectionsCount == 0 && !compileDatabase)
+    {
+        fprintf(stderr, "Usage: %s [-o <output folder>] [-d] [-i <source file>] <collection name>...\n", argv[0]);
+        return 1;
+    }
+    return success ? 0 : 1;
+}
@@ -0,0 +1,249 @@
+// Replays the known solutions of the shipped collections through the game rules, and prints per level figures as JSON,
+// as a baseline to judge engine changes against.
+//
+//   sokoban_replay [<collection name>...]
+//
+// Every level is loaded with level_load, as the game does, and its solution from the .lurd file next to the collection
+// (see solutions.h) is played with game_state_apply_move and taken back with game_state_undo_move. For each level:
+//
+//   parse_us            Time of level_load.
+//   moves_per_s         Rate of game_state_apply_move, from the start to the solved position.
+//   undos_per_s         Rate of game_state_undo_move, from the solved position back to the start.
+//   peak_memory_bytes   Level and GameState memory, as the engine counts it, once the whole solution is played: the
+//                       journal and keyframes only grow while moves are applied, so that is when it peaks.
+//
+// Runs are meant to be compared with each other: the work is fixed (every batch replays a solution for at least
+// MIN_BATCH_MOVES moves, whatever the machine), times are of the CPU used by the process, and every figure is the best of
+// several rounds over all the levels (see main). Levels without a solution are listed with their parse time only.
+#include "game_state.h"
+#include "level.h"
+#include "levels_database.h"
+#include "solutions.h"
+
+#include <furi.h>
+#include <math.h>
+#include <strings.h>
+#include <time.h>
+
+#define MAX_SOLUTION_LENGTH 65536
+#define PARSE_RUNS 25
+#define BATCHES 9
+#define MIN_BATCH_MOVES 50000
+
+static double now_seconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+// The moves of a solution, as steps for game_state_apply_move.
+typedef struct Replay
+{
+    int8_t* dx;
+    int8_t* dy;
+    int movesCount;
+} Replay;
+
+// Turns a LURD solution into steps on a level, as the game loaded it. Returns false if a letter is not a move.
+static bool replay_parse(const Level* level, const char* solution, Replay* ret_replay)
+{
+    static const int8_t DIRECTION_DX[] = {-1, 1, 0, 0};
+    static const int8_t DIRECTION_DY[] = {0, 0, -1, 1};
+
+    int length = strlen(solution);
+    ret_replay->dx = malloc(length);
+    ret_replay->dy = malloc(length);
+    ret_replay->movesCount = length;
+    for (int i = 0; i < length; i++)
+    {
+        JournalMove move = game_state_lurd_move(level, solution[i]);
+        if (move == MoveInvalid)
+            return false;
+        ret_replay->dx[i] = DIRECTION_DX[move & MoveDirectionMask];
+        ret_replay->dy[i] = DIRECTION_DY[move & MoveDirectionMask];
+    }
+    return true;
+}
+
+static void replay_free(Replay* replay)
+{
+    free(replay->dx);
+    free(replay->dy);
+}
+
+// A level being measured, and its figures so far.
+typedef struct LevelRun
+{
+    const char* collectionName;
+    int levelIndex;
+    Level* level;
+    Replay replay;
+    bool hasSolution, isSolved;
+    int pushesCount, peakMemory;
+    double parseTime, moveTime, undoTime; // Fastest so far, in seconds, per load or per batch.
+} LevelRun;
+
+static void measure_parse(LevelRun* run)
+{
+    double start = now_seconds();
+    Level* level = level_load(run->collectionName, run->levelIndex);
+    run->parseTime = MIN(run->parseTime, now_seconds() - start);
+    level_free(level);
+}
+
+// Plays the solution once, to check that it solves the level, and to count the memory once it is played. A replay that
+// ends short of the solution, or does not solve the level, is not timed.
+static void check_replay(LevelRun* run)
+{
+    GameState* state = game_state_initialize(run->level);
+    for (int move = 0; move < run->replay.movesCount; move++)
+        game_state_apply_move(state, run->replay.dx[move], run->replay.dy[move]);
+    run->isSolved = state->isCompleted && game_state_position(state) == run->replay.movesCount;
+    run->pushesCount = state->pushesCount;
+    run->peakMemory = sizeof(Level) + board_heap_size(&run->level->board) + game_state_memory_size(state);
+    game_state_free(state);
+}
+
+static int replays_per_batch(const LevelRun* run)
+{
+    return (MIN_BATCH_MOVES + run->replay.movesCount - 1) / run->replay.movesCount;
+}
+
+// Plays the solution from the start, and takes it back, in as many states as a batch needs. The states are set up
+// beforehand, so the clock is only read around the moves and the undos.
+static void measure_batch(LevelRun* run, GameState** states, bool isCounted)
+{
+    const Replay* replay = &run->replay;
+    int replaysCount = replays_per_batch(run);
+    for (int i = 0; i < replaysCount; i++)
+        states[i] = game_state_initialize(run->level);
+
+    double start = now_seconds();
+    for (int i = 0; i < replaysCount; i++)
+        for (int move = 0; move < replay->movesCount; move++)
+            game_state_apply_move(states[i], replay->dx[move], replay->dy[move]);
+    double middle = now_seconds();
+    for (int i = 0; i < replaysCount; i++)
+        for (int move = 0; move < replay->movesCount; move++)
+            game_state_undo_move(states[i]);
+    double end = now_seconds();
+
+    for (int i = 0; i < replaysCount; i++)
+    {
+        furi_check(game_state_position(states[i]) == 0 && states[i]->pushesCount == 0, "undo did not go back to the start");
+        game_state_free(states[i]);
+    }
+    if (isCounted)
+    {
+        run->moveTime = MIN(run->moveTime, middle - start);
+        run->undoTime = MIN(run->undoTime, end - middle);
+    }
+}
+
+static void print_json_string(const char* text)
+{
+    putchar('"');
+    for (const char* ch = text; *ch != '\0'; ch++)
+    {
+        if (*ch == '"' || *ch == '\\')
+            putchar('\\');
+        putchar(*ch);
+    }
+    putchar('"');
+}
+
+int main(int argc, char** argv)
+{
+    LevelsDatabase* database = levels_database_load();
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+
+    int runsCount = 0;
+    for (int collectionIndex = 0; collectionIndex < database->collectionsCount; collectionIndex++)
+        runsCount += database->collections[collectionIndex].levelsCount;
+    LevelRun* runs = calloc(runsCount, sizeof(LevelRun));
+    runsCount = 0;
+
+    int maxReplaysPerBatch = 1;
+    for (int collectionIndex = 0; collectionIndex < database->collectionsCount; collectionIndex++)
+    {
+        const char* collectionName = database->collections[collectionIndex].name;
+        bool isSelected = argc == 1;
+        for (int i = 1; i < argc; i++)
+            isSelected |= strcasecmp(argv[i], collectionName) == 0;
+        if (!isSelected)
+            continue;
+
+        SolutionsReader* reader = solutions_reader_open(storage, collectionName, MAX_SOLUTION_LENGTH);
+        for (int levelIndex = 0; levelIndex < database->collections[collectionIndex].levelsCount; levelIndex++)
+        {
+            const char* solution = NULL;
+            if (reader != NULL && !solutions_reader_next(reader, &solution))
+                solution = NULL;
+
+            LevelRun* run = &runs[runsCount++];
+            run->collectionName = collectionName;
+            run->levelIndex = levelIndex;
+            run->level = level_load(collectionName, levelIndex);
+            run->parseTime = run->moveTime = run->undoTime = INFINITY;
+            run->hasSolution = solution != NULL && solution[0] != '\0';
+            if (run->hasSolution && replay_parse(run->level, solution, &run->replay))
+                check_replay(run);
+            if (run->isSolved)
+                maxReplaysPerBatch = MAX(maxReplaysPerBatch, replays_per_batch(run));
+        }
+        if (reader != NULL)
+            solutions_reader_free(reader);
+    }
+
+    // Each round measures every level once, so a slow spell of the machine slows down a round rather than some of the
+    // levels, and the fastest round of each level is kept. The first round of replays only warms up.
+    for (int round = 0; round < PARSE_RUNS; round++)
+        for (int i = 0; i < runsCount; i++)
+            measure_parse(&runs[i]);
+    GameState** states = malloc(maxReplaysPerBatch * sizeof(GameState*));
+    for (int round = -1; round < BATCHES; round++)
+        for (int i = 0; i < runsCount; i++)
+            if (runs[i].isSolved)
+                measure_batch(&runs[i], states, round >= 0);
+    free(states);
+
+    printf("{\n");
+#ifdef SOKOBAN_BOARD_GRID
+    printf("  \"backend\": \"char grid\",\n");
+#else
+    printf("  \"backend\": \"bit planes\",\n");
+#endif
+    printf("  \"batches\": %d,\n  \"min_batch_moves\": %d,\n  \"parse_runs\": %d,\n", BATCHES, MIN_BATCH_MOVES, PARSE_RUNS);
+    printf("  \"levels\": [");
+
+    int failures = 0;
+    for (int i = 0; i < runsCount; i++)
+    {
+        LevelRun* run = &runs[i];
+        printf("%s\n    {\"collection\": ", i == 0 ? "" : ",");
+        print_json_string(run->collectionName);
+        printf(", \"level\": %d, \"width\": %d, \"height\": %d, \"parse_us\": %.2f", run->levelIndex + 1, run->level->level_width, run->level->level_height, run->parseTime * 1e6);
+        if (run->isSolved)
+        {
+            double batchMoves = (double)replays_per_batch(run) * run->replay.movesCount;
+            printf(", \"moves\": %d, \"pushes\": %d, \"solved\": true, \"moves_per_s\": %.0f, \"undos_per_s\": %.0f, \"peak_memory_bytes\": %d",
+                   run->replay.movesCount, run->pushesCount, batchMoves / run->moveTime, batchMoves / run->undoTime, run->peakMemory);
+        }
+        else if (run->hasSolution)
+            printf(", \"moves\": %d, \"solved\": false", run->replay.movesCount);
+        else
+            printf(", \"moves\": null");
+        printf("}");
+        failures += run->hasSolution && !run->isSolved;
+
+        replay_free(&run->replay);
+        level_free(run->level);
+    }
+    printf("\n  ],\n  \"failures\": %d\n}\n", failures);
+
+    free(runs);
+    furi_record_close(RECORD_STORAGE);
+    levels_database_free(database);
+    return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,271 @@
+// Solves levels of a collection with the push-optimal solver, and checks the results against the world bests of database.txt.
+//
+//   sokoban_solver [options] <collection name> [<first level>[-<last level>]]
+//
+//   --max-nodes <n>        Node limit per level (default: 2000000). Memory use is about 50 bytes per node. Levels are tried
+//                          with the default first, and solved again with the whole limit only if they need more.
+//   --heuristic <name>     Lower bound to use: "matching" (default), "distance" or "none".
+//   --check                Compares every push count with the world best in database.txt, and exits with an error on mismatches
+//                          or if any level is left unsolved, and so unchecked.
+//   --database             Prints the results as database.txt lines (one push count per level) instead of a report.
+//   --solutions            Prints the solutions as lines of a .lurd solutions file (see solutions.h) instead of a report.
+//   --verify               Checks the solutions of the .lurd file of the collection instead of solving, and compares their
+//                          push counts with the world bests of database.txt. Exits with an error on any failure.
+//
+// Levels are numbered from 1, as in the collection files. Without a range, every level of the collection is solved.
+#include "game_state.h"
+#include "level.h"
+#include "levels_database.h"
+#include "solutions.h"
+#include "solver.h"
+
+#include <furi.h>
+#include <strings.h>
+#include <time.h>
+
+#define MAX_SOLUTION_LENGTH 65536
+#define FIRST_TRY_MAX_NODES 2000000
+
+static double now_seconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+// Replays a LURD solution with the game rules. Returns the pushes, or -1 if the solution is illegal or does not solve the level.
+static int replay_solution(const Level* level, const char* solution)
+{
+    LurdCheck check;
+    game_state_check_lurd(level, solution, &check);
+    return check.illegalMove < 0 && check.isCompleted ? check.pushesCount : -1;
+}
+
+// Checks the known solutions of a range of levels, and compares their push counts with the world bests. Returns the count
+// of solutions that are illegal, do not solve their level, or do not match the world best. Missing ones are only reported.
+static int verify_solutions(LevelsDatabase* database, int collectionIndex, int first, int last)
+{
+    const char* collectionName = database->collections[collectionIndex].name;
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    SolutionsReader* reader = solutions_reader_open(storage, collectionName, MAX_SOLUTION_LENGTH);
+    if (reader == NULL)
+    {
+        fprintf(stderr, "No solutions for %s\n", collectionName);
+        furi_record_close(RECORD_STORAGE);
+        return 1;
+    }
+
+    printf("%-6s %-12s %7s %7s %7s\n", "level", "status", "moves", "pushes", "world");
+    int failures = 0, missing = 0;
+    long movesCount = 0;
+    double seconds = 0;
+    for (int levelNumber = 1; levelNumber <= last; levelNumber++)
+    {
+        const char* solution;
+        if (!solutions_reader_next(reader, &solution))
+            solution = NULL;
+        if (levelNumber < first)
+            continue;
+
+        const char* status = "missing";
+        LurdCheck check = {.illegalMove = -1};
+        int worldBest = levels_database_get_level(database, collectionIndex, levelNumber - 1).worldBest;
+        if (solution != NULL && solution[0] != '\0')
+        {
+            Level* level = level_load_text(collectionName, levelNumber - 1);
+            double start = now_seconds();
+            game_state_check_lurd(level, solution, &check);
+            seconds += now_seconds() - start;
+            level_free(level);
+
+            movesCount += check.movesCount;
+            if (check.illegalMove >= 0)
+                status = "illegal";
+            else if (!check.isCompleted)
+                status = "unsolved";
+            else if (check.pushesCount != worldBest)
+                status = "mismatch";
+            else
+                status = "ok";
+        }
+        missing += strcmp(status, "missing") == 0;
+        failures += strcmp(status, "ok") != 0 && strcmp(status, "missing") != 0;
+
+        printf("%-6d %-12s %7d %7d %7d", levelNumber, status, check.movesCount, check.pushesCount, worldBest);
+        if (check.illegalMove >= 0)
+            printf("  illegal move %d: '%c'", check.illegalMove + 1, solution[check.illegalMove]);
+        printf("\n");
+    }
+
+    fprintf(stderr, "%d levels, %d without solution, %d failures, %ld moves checked in %.3f ms (%.0f moves/s)\n", last - first + 1, missing, failures, movesCount, seconds * 1000, seconds > 0 ? movesCount / seconds : 0);
+    solutions_reader_free(reader);
+    furi_record_close(RECORD_STORAGE);
+    return failures;
+}
+
+static const char* status_name(SolverStatus status)
+{
+    switch (status)
+    {
+    case SolverStatus_Solved:
+        return "solved";
+    case SolverStatus_Unsolvable:
+        return "unsolvable";
+    case SolverStatus_OutOfMemory:
+        return "node limit";
+    default:
+        return "running";
+    }
+}
+
+static int usage(const char* program)
+{
+    fprintf(stderr, "Usage: %s [--max-nodes <n>] [--heuristic matching|distance|none] [--check] [--database|--solutions|--verify] <collection name> [<first>[-<last>]]\n", program);
+    return 2;
+}
+
+int main(int argc, char** argv)
+{
+    int maxNodes = FIRST_TRY_MAX_NODES;
+    SolverHeuristic heuristic = solver_heuristic_matching;
+    bool check = false, databaseOutput = false, solutionsOutput = false, verify = false;
+    const char* collectionName = NULL;
+    const char* range = NULL;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--max-nodes") == 0 && i + 1 < argc)
+            maxNodes = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--heuristic") == 0 && i + 1 < argc)
+        {
+            const char* name = argv[++i];
+            if (strcmp(name, "none") == 0)
+                heuristic = solver_heuristic_none;
+            else if (strcmp(name, "distance") == 0)
+                heuristic = solver_heuristic_push_distance;
+            else if (strcmp(name, "matching") == 0)
+                heuristic = solver_heuristic_matching;
+            else
+                return usage(argv[0]);
+        }
+        else if (strcmp(argv[i], "--check") == 0)
+            check = true;
+        else if (strcmp(argv[i], "--database") == 0)
+            databaseOutput = true;
+        else if (strcmp(argv[i], "--solutions") == 0)
+            solutionsOutput = true;
+        else if (strcmp(argv[i], "--verify") == 0)
+            verify = true;
+        else if (collectionName == NULL)
+            collectionName = argv[i];
+        else if (range == NULL)
+            range = argv[i];
+        else
+            return usage(argv[0]);
+    }
+    if (collectionName == NULL || maxNodes <= 0)
+        return usage(argv[0]);
+
+    LevelsDatabase* database = levels_database_load();
+    LevelsCollection* collection = NULL;
+    int collectionIndex = -1;
+    for (int i = 0; i < database->collectionsCount; i++)
+        if (strcasecmp(database->collections[i].name, collectionName) == 0)
+        {
+            collection = &database->collections[i];
+            collectionIndex = i;
+        }
+    if (collection == NULL)
+    {
+        fprintf(stderr, "Unknown collection: %s\n", collectionName);
+        levels_database_free(database);
+        return 2;
+    }
+
+    int first = 1, last = collection->levelsCount;
+    if (range != NULL)
+    {
+        const char* dash = strchr(range, '-');
+        first = atoi(range);
+        last = dash != NULL ? atoi(dash + 1) : first;
+    }
+    if (first < 1 || last > collection->levelsCount || first > last)
+    {
+        fprintf(stderr, "Invalid range: %d-%d (the collection has %d levels)\n", first, last, collection->levelsCount);
+        levels_database_free(database);
+        return 2;
+    }
+
+    if (verify)
+    {
+        int failures = verify_solutions(database, collectionIndex, first, last);
+        levels_database_free(database);
+        return failures > 0 ? 1 : 0;
+    }
+
+    if (!databaseOutput && !solutionsOutput)
+        printf("%-6s %-10s %7s %7s %10s %11s %10s %8s  %s\n", "level", "status", "pushes", "world", "nodes", "nodes/s", "memory KB", "seconds", "solution");
+
+    char* solution = malloc(MAX_SOLUTION_LENGTH);
+    int mismatches = 0, unsolved = 0;
+    double totalSeconds = 0;
+    long totalExpansions = 0;
+
+    for (int levelNumber = first; levelNumber <= last; levelNumber++)
+    {
+        Level* level = level_load_text(collection->name, levelNumber - 1);
+        GameState* state = game_state_initialize(level);
+
+        // Allocating for a high node limit takes time of its own, so levels are tried with a lower one first.
+        double start = now_seconds();
+        Solver* solver = solver_alloc(state, MIN(maxNodes, FIRST_TRY_MAX_NODES), heuristic);
+        SolverStatus status = solver_run(solver, 0);
+        if (status == SolverStatus_OutOfMemory && maxNodes > FIRST_TRY_MAX_NODES)
+        {
+            solver_free(solver);
+            solver = solver_alloc(state, maxNodes, heuristic);
+            status = solver_run(solver, 0);
+        }
+        double seconds = now_seconds() - start;
+
+        int pushes = solver_solution_pushes(solver);
+        int worldBest = levels_database_get_level(database, collectionIndex, levelNumber - 1).worldBest;
+        solution[0] = '\0';
+        if (status == SolverStatus_Solved && solver_solution_lurd(solver, solution, MAX_SOLUTION_LENGTH) >= 0)
+        {
+            if (replay_solution(level, solution) != pushes)
+            {
+                fprintf(stderr, "Level %d: the solution does not replay to %d pushes\n", levelNumber, pushes);
+                mismatches += 1;
+            }
+        }
+        if (status != SolverStatus_Solved)
+            unsolved += 1;
+        else if (check && pushes != worldBest)
+            mismatches += 1;
+
+        int expansions = solver_expansions_count(solver);
+        totalExpansions += expansions;
+        totalSeconds += seconds;
+
+        if (databaseOutput)
+            printf("%d\n", status == SolverStatus_Solved ? pushes : worldBest);
+        else if (solutionsOutput)
+            printf("%s\n", solution);
+        else
+            printf("%-6d %-10s %7d %7d %10d %11.0f %10zu %8.3f  %s%s\n", levelNumber, status_name(status), pushes, worldBest, expansions, seconds > 0 ? expansions / seconds : 0, solver_memory_size(solver) / 1024, seconds, solution, !check ? "" : status != SolverStatus_Solved ? "  UNCHECKED" : pushes != worldBest ? "  MISMATCH" : "");
+        fflush(stdout);
+
+        solver_free(solver);
+        game_state_free(state);
+        level_free(level);
+    }
+
+    fprintf(stderr, "%d levels, %d unsolved, %d mismatches, %ld nodes expanded in %.2f s (%.0f nodes/s)\n", last - first + 1, unsolved, mismatches, totalExpansions, totalSeconds, totalSeconds > 0 ? totalExpansions / totalSeconds : 0);
+
+    free(solution);
+    levels_database_free(database);
+    if (check && unsolved > 0)
+        fprintf(stderr, "%d levels left unchecked: raise --max-nodes to check them\n", unsolved);
+    return mismatches > 0 || (check && unsolved > 0) ? 1 : 0;
+}
@@ -0,0 +1,257 @@
+#include "state_store.h"
+
+#include <furi.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DIRECTIONS_COUNT 4
+#define NO_FLOOR LEVEL_NO_FLOOR
+
+// Each slot holds the tag of its key, the clock of its last use, and the key itself. Tags are the high half of the hash,
+// with the lowest bit set so that an empty slot, tagged 0, never matches.
+#define SLOT_HEADER_SIZE (sizeof(uint32_t) + sizeof(uint16_t))
+
+struct StateEncoder
+{
+    const Level* level;
+    LevelFloor floor;
+    int boxesCount, cellBytes;
+    uint16_t* queue;
+    uint16_t* reachStamps;
+    uint16_t stamp;
+};
+
+struct StateStore
+{
+    int keySize, slotSize;
+    uint32_t slotsMask;
+    uint8_t* slots;
+    uint16_t clock;
+    int count, replacedCount;
+};
+
+StateEncoder* state_encoder_alloc(const Level* level)
+{
+    StateEncoder* encoder = malloc(sizeof(StateEncoder));
+    encoder->level = level;
+    level_floor_init(&encoder->floor, level);
+
+    // Boxes off the floor can never be moved, so they are left out of the keys.
+    int width = level->level_width;
+    encoder->boxesCount = 0;
+    for (int floor = 0; floor < encoder->floor.count; floor++)
+    {
+        int cell = encoder->floor.floorToCell[floor];
+        if (board_get_cell(&level->board, cell % width, cell / width) & CellHasBox)
+            encoder->boxesCount += 1;
+    }
+
+    encoder->cellBytes = encoder->floor.count <= 256 ? 1 : 2;
+    encoder->queue = malloc(encoder->floor.count * sizeof(uint16_t));
+    encoder->reachStamps = calloc(encoder->floor.count, sizeof(uint16_t));
+    encoder->stamp = 0;
+    return encoder;
+}
+
+void state_encoder_free(StateEncoder* encoder)
+{
+    level_floor_free(&encoder->floor);
+    free(encoder->queue);
+    free(encoder->reachStamps);
+    free(encoder);
+}
+
+int state_encoder_key_size(const StateEncoder* encoder)
+{
+    return (encoder->boxesCount + 1) * encoder->cellBytes;
+}
+
+static uint8_t* write_floor(const StateEncoder* encoder, uint8_t* key, int floor)
+{
+    *key++ = floor & 0xFF;
+    if (encoder->cellBytes == 2)
+        *key++ = floor >> 8;
+    return key;
+}
+
+// Returns the top-left floor cell the player can reach, which is the lowest numbered one.
+static int find_player_area(StateEncoder* encoder, const GameState* state)
+{
+    encoder->stamp += 1;
+    if (encoder->stamp == 0)
+    {
+        memset(encoder->reachStamps, 0, encoder->floor.count * sizeof(uint16_t));
+        encoder->stamp = 1;
+    }
+
+    const Board* board = &state->level->board;
+    int width = state->levelWidth;
+    int start = encoder->floor.cellToFloor[state->playerY * width + state->playerX];
+    int head = 0, tail = 0, topLeft = start;
+    encoder->queue[tail++] = start;
+    encoder->reachStamps[start] = encoder->stamp;
+    while (head < tail)
+    {
+        int floor = encoder->queue[head++];
+        topLeft = MIN(topLeft, floor);
+        for (int direction = 0; direction < DIRECTIONS_COUNT; direction++)
+        {
+            int next = encoder->floor.neighbors[floor][direction];
+            if (next == NO_FLOOR || encoder->reachStamps[next] == encoder->stamp)
+                continue;
+            int cell = encoder->floor.floorToCell[next];
+            if (box_layer_has_box(board, &state->boxes, cell % width, cell / width))
+                continue;
+            encoder->reachStamps[next] = encoder->stamp;
+            encoder->queue[tail++] = next;
+        }
+    }
+    return topLeft;
+}
+
+uint64_t state_encoder_encode(StateEncoder* encoder, const GameState* state, uint8_t* ret_key)
+{
+    // Floor cells are numbered in the order of the cells, so going through them in order lists the boxes sorted.
+    const Board* board = &state->level->board;
+    int width = state->levelWidth;
+    uint8_t* key = ret_key;
+    for (int floor = 0; floor < encoder->floor.count; floor++)
+    {
+        int cell = encoder->floor.floorToCell[floor];
+        if (box_layer_has_box(board, &state->boxes, cell % width, cell / width))
+            key = write_floor(encoder, key, floor);
+    }
+
+    int player = find_player_area(encoder, state);
+    write_floor(encoder, key, player);
+    return state->boxesHash ^ game_state_player_key(encoder->floor.floorToCell[player]);
+}
+
+StateStore* state_store_alloc(int keySize, size_t maxBytes)
+{
+    size_t slotSize = SLOT_HEADER_SIZE + keySize;
+    if (maxBytes < sizeof(StateStore) + STATE_STORE_PROBE_LIMIT * slotSize)
+        return NULL;
+
+    // The count of slots is a power of two, so the hash maps to a slot with a mask.
+    uint32_t slotsCount = STATE_STORE_PROBE_LIMIT;
+    while (sizeof(StateStore) + (size_t)slotsCount * 2 * slotSize <= maxBytes)
+        slotsCount *= 2;
+
+    StateStore* store = malloc(sizeof(StateStore));
+    store->keySize = keySize;
+    store->slotSize = slotSize;
+    store->slotsMask = slotsCount - 1;
+    store->slots = calloc(slotsCount, slotSize);
+    store->clock = 0;
+    store->count = 0;
+    store->replacedCount = 0;
+    return store;
+}
+
+void state_store_free(StateStore* store)
+{
+    free(store->slots);
+    free(store);
+}
+
+static uint8_t* slot_at(const StateStore* store, uint32_t index)
+{
+    return store->slots + (size_t)(index & store->slotsMask) * store->slotSize;
+}
+
+static uint32_t slot_tag(const uint8_t* slot)
+{
+    uint32_t tag;
+    memcpy(&tag, slot, sizeof(tag));
+    return tag;
+}
+
+static uint16_t slot_age(const StateStore* store, const uint8_t* slot)
+{
+    uint16_t used;
+    memcpy(&used, slot + sizeof(uint32_t), sizeof(used));
+    return store->clock - used;
+}
+
+static void slot_use(StateStore* store, uint8_t* slot)
+{
+    memcpy(slot + sizeof(uint32_t), &store->clock, sizeof(store->clock));
+}
+
+// Returns the slot holding a key, or NULL. If it is not found, ret_vacant gets the slot to add it in: the first empty slot of
+// its window, or else the one used the longest ago. Ages are kept in 16 bits, so they are only compared approximately
+// once the clock wraps around.
+static uint8_t* find_slot(StateStore* store, uint64_t hash, const uint8_t* key, uint8_t** ret_vacant)
+{
+    uint32_t tag = (uint32_t)(hash >> 32) | 1;
+    uint8_t* oldest = NULL;
+    for (int probe = 0; probe < STATE_STORE_PROBE_LIMIT; probe++)
+    {
+        uint8_t* slot = slot_at(store, (uint32_t)hash + probe);
+        uint32_t slotTag = slot_tag(slot);
+        if (slotTag == 0)
+        {
+            *ret_vacant = slot;
+            return NULL;
+        }
+        if (slotTag == tag && memcmp(slot + SLOT_HEADER_SIZE, key, store->keySize) == 0)
+            return slot;
+        if (oldest == NULL || slot_age(store, slot) > slot_age(store, oldest))
+            oldest = slot;
+    }
+    *ret_vacant = oldest;
+    return NULL;
+}
+
+bool state_store_insert(StateStore* store, uint64_t hash, const uint8_t* key)
+{
+    store->clock += 1;
+    uint8_t* vacant;
+    uint8_t* slot = find_slot(store, hash, key, &vacant);
+    if (slot != NULL)
+    {
+        slot_use(store, slot);
+        return true;
+    }
+
+    if (slot_tag(vacant) == 0)
+        store->count += 1;
+    else
+        store->replacedCount += 1;
+    uint32_t tag = (uint32_t)(hash >> 32) | 1;
+    memcpy(vacant, &tag, sizeof(tag));
+    slot_use(store, vacant);
+    memcpy(vacant + SLOT_HEADER_SIZE, key, store->keySize);
+    return false;
+}
+
+bool state_store_contains(StateStore* store, uint64_t hash, const uint8_t* key)
+{
+    store->clock += 1;
+    uint8_t* vacant;
+    uint8_t* slot = find_slot(store, hash, key, &vacant);
+    if (slot != NULL)
+        slot_use(store, slot);
+    return slot != NULL;
+}
+
+int state_store_count(const StateStore* store)
+{
+    return store->count;
+}
+
+int state_store_capacity(const StateStore* store)
+{
+    return store->slotsMask + 1;
+}
+
+int state_store_replaced_count(const StateStore* store)
+{
+    return store->replacedCount;
+}
+
+size_t state_store_memory_size(const StateStore* store)
+{
+    return sizeof(StateStore) + (size_t)(store->slotsMask + 1) * store->slotSize;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "game_state.h"
+#include "level.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Compact positions, for caches that must hold many more positions than GameStates would fit in memory.
+//
+// StateEncoder turns the position of a game into a canonical key: the floor cells of its boxes, in ascending order, then
+// the top-left floor cell of the area the player can reach. Floor cells are the cells the player can reach in the level
+// without its boxes, numbered row by row. A key takes a byte per box plus one for the player on levels of up to 256 floor
+// cells, and two bytes each on bigger ones. Positions where the player stands in different cells of the same area get
+// the same key, as they are the same position to any search over pushes.
+//
+// StateStore is a set of keys, with open addressing within a fixed memory size. A key is only looked for in the
+// STATE_STORE_PROBE_LIMIT slots from its hash. When those are full, adding a key replaces the one among them that was
+// used the longest ago, so that a full store goes on working as a cache instead of refusing keys.
+//
+// Nothing on the device uses them yet: the solver indexes its nodes by their place in its own table, which a lossy store
+// can not give. They are built with the host tools, to measure how many positions a given memory size holds.
+
+#define STATE_STORE_PROBE_LIMIT 8
+
+typedef struct StateEncoder StateEncoder;
+typedef struct StateStore StateStore;
+
+StateEncoder* state_encoder_alloc(const Level* level);
+void state_encoder_free(StateEncoder* encoder);
+
+// Returns the size of the keys of the level, in bytes.
+int state_encoder_key_size(const StateEncoder* encoder);
+
+// Writes the key of the position of a game, and returns its hash: the boxes hash the state keeps as it moves, with the
+// player key of the top-left cell the player can reach. Only the area of the player is searched.
+uint64_t state_encoder_encode(StateEncoder* encoder, const GameState* state, uint8_t* ret_key);
+
+// Allocates a store of keys of a size, taking at most maxBytes. Returns NULL if that is not enough for a single window
+// of slots.
+StateStore* state_store_alloc(int keySize, size_t maxBytes);
+void state_store_free(StateStore* store);
+
+// Adds a key, and returns whether it was already stored.
+bool state_store_insert(StateStore* store, uint64_t hash, const uint8_t* key);
+// Returns whether a key is stored. Finding it counts as a use, for the replacement.
+bool state_store_contains(StateStore* store, uint64_t hash, const uint8_t* key);
+
+int state_store_count(const StateStore* store);
+int state_store_capacity(const StateStore* store);
+// Returns the count of keys replaced by others since the store was allocated.
+int state_store_replaced_count(const StateStore* store);
+size_t state_store_memory_size(const StateStore* store);